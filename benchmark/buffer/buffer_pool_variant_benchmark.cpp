@@ -0,0 +1,73 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "disk/disk_manager.hpp"
+#include "buffer/buffer_pool_manager.hpp"
+#include "buffer/buffer_pool_variant.hpp"
+
+namespace dsbus {
+
+static constexpr size_t page_size = 8192;
+
+/**
+ *  Read the first byte of each page, all resident.
+ *  @return the sum, kept so the reads are not optimized away
+ */
+template<typename BufferPool>
+size_t ReadPages(BufferPool &bpm, const std::vector<page_id_t> &page_ids) {
+    size_t sum = 0;
+    for (auto page_id : page_ids) sum += bpm.FetchPageRead(page_id).GetContent()[0];
+    return sum;
+}
+
+template<typename Run>
+void Report(const char *name, const size_t fetch_num, Run run) {
+    auto start = std::chrono::steady_clock::now();
+    size_t sum = run();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    printf("%-22s %10.1f %12zu\n", name, ns / fetch_num, sum);
+}
+
+} // dsbus
+
+int main(int argc, char *argv[]) {
+    using namespace dsbus;
+    size_t page_num = argc > 1 ? std::stoul(argv[1]) : 1024;
+    size_t fetch_num = argc > 2 ? std::stoul(argv[2]) : 10000000;
+    remove("benchmark.db");
+    DiskManager disk_manager(Slice("benchmark.db"), page_size);
+    std::mt19937 rng(42);
+    std::vector<page_id_t> page_ids(fetch_num);
+    for (auto &page_id : page_ids) page_id = rng() % page_num;
+    printf("page_num %zu, page_size %zu, fetch_num %zu\n", page_num, page_size, fetch_num);
+    printf("%-22s %10s %12s\n", "pool", "ns/fetch", "sum");
+    std::vector<page_id_t> all_page_ids;
+    {
+        BufferPoolManager<page_size> bpm(page_num, &disk_manager);
+        for (size_t i = 0; i < page_num; ++i) all_page_ids.push_back(bpm.NewPageGuarded().GetPageId());
+    }
+    {
+        BufferPoolManager<page_size> bpm(page_num, &disk_manager);
+        ReadPages(bpm, all_page_ids);
+        Report("template", fetch_num, [&]() { return ReadPages(bpm, page_ids); });
+    }
+    {
+        BufferPoolVariant<> pool(page_num, &disk_manager);
+        pool.Visit([&](auto &bpm) { return ReadPages(bpm, all_page_ids); });
+        Report("variant, visit once", fetch_num, [&]() {
+            return pool.Visit([&](auto &bpm) { return ReadPages(bpm, page_ids); });
+        });
+        Report("variant, visit each", fetch_num, [&]() {
+            size_t sum = 0;
+            for (auto page_id : page_ids) {
+                sum += pool.Visit([page_id](auto &bpm) { return bpm.FetchPageRead(page_id).GetContent()[0]; });
+            }
+            return sum;
+        });
+    }
+    remove("benchmark.db");
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <list>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/lru_replacer.hpp"
+
+namespace dsbus {
+
+/**
+ *  The previous LRUReplacer, std::list + std::unordered_map based, kept as baseline.
+ */
+class ListLRUReplacer {
+public:
+    explicit ListLRUReplacer(const size_t num_pages) {
+        for (size_t i = 0; i < num_pages; ++i) {
+            free_list_.push_back((frame_id_t)i);
+            free_map_[(frame_id_t)i] = std::prev(free_list_.end());
+        }
+    }
+
+    bool Victim(frame_id_t *frame_id) {
+        if (!free_list_.empty()) {
+            *frame_id = free_list_.front();
+            free_list_.pop_front();
+            free_map_.erase(free_map_.find(*frame_id));
+        } else if (!lru_list_.empty()) {
+            *frame_id = lru_list_.front();
+            lru_list_.pop_front();
+            lru_map_.erase(*frame_id);
+        } else {
+            return false;
+        }
+        pin_map_[*frame_id] = 1;
+        return true;
+    }
+
+    void Pin(frame_id_t frame_id) {
+        auto it1 = lru_map_.find(frame_id);
+        auto it2 = pin_map_.find(frame_id);
+        if (it1 == lru_map_.end() && it2 == pin_map_.end()) {
+            auto it3 = free_map_.find(frame_id);
+            if (it3 != free_map_.end()) {
+                free_list_.erase(it3->second);
+                free_map_.erase(it3);
+                pin_map_[frame_id] = 1;
+            }
+            return;
+        }
+        if (it1 != lru_map_.end()) {
+            lru_list_.erase(it1->second);
+            lru_map_.erase(it1);
+        }
+        if (it2 != pin_map_.end()) {
+            ++it2->second;
+        } else {
+            pin_map_[frame_id] = 1;
+        }
+    }
+
+    void Unpin(frame_id_t frame_id) {
+        auto it1 = pin_map_.find(frame_id);
+        if (it1 == pin_map_.end()) return;
+        --it1->second;
+        if (it1->second != 0) return;
+        pin_map_.erase(it1);
+        lru_list_.push_back(frame_id);
+        lru_map_[frame_id] = std::prev(lru_list_.end());
+    }
+
+    size_t Size() { return free_list_.size() + lru_list_.size(); }
+
+private:
+    std::list<frame_id_t> free_list_;
+    std::list<frame_id_t> lru_list_;
+    std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> free_map_;
+    std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> lru_map_;
+    std::unordered_map<frame_id_t, size_t> pin_map_;
+};
+
+/**
+ *  Drive a replacer the way BufferPoolManager does: a hit pins and unpins a resident frame,
+ *  a miss evicts a victim and unpins it once loaded.
+ *
+ *  @param hit_ratio share of operations that are hits
+ *  @return nanoseconds per operation
+ */
+template<typename Replacer>
+double RunWorkload(const size_t num_pages, const size_t op_num, const double hit_ratio, uint64_t *checksum) {
+    Replacer replacer(num_pages);
+    // warm up: every frame resident and unpinned
+    frame_id_t frame_id = 0;
+    for (size_t i = 0; i < num_pages; ++i) {
+        replacer.Victim(&frame_id);
+        replacer.Unpin(frame_id);
+    }
+    std::mt19937 rng(42);
+    std::vector<frame_id_t> frames(op_num);
+    std::vector<bool> hits(op_num);
+    std::bernoulli_distribution hit_dist(hit_ratio);
+    for (size_t i = 0; i < op_num; ++i) {
+        frames[i] = rng() % num_pages;
+        hits[i] = hit_dist(rng);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < op_num; ++i) {
+        if (hits[i]) {
+            replacer.Pin(frames[i]);
+            replacer.Unpin(frames[i]);
+        } else {
+            replacer.Victim(&frame_id);
+            replacer.Unpin(frame_id);
+            *checksum += frame_id;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    *checksum += replacer.Size();
+    return std::chrono::duration<double, std::nano>(end - start).count() / op_num;
+}
+
+} // dsbus
+
+int main() {
+    using namespace dsbus;
+    const size_t op_num = 5000000;
+    uint64_t checksum = 0;
+    printf("%-10s %-10s %16s %16s %8s\n", "frames", "hit_ratio", "list (ns/op)", "array (ns/op)", "speedup");
+    for (size_t num_pages : {1024, 65536, 1048576}) {
+        for (double hit_ratio : {1.0, 0.9, 0.0}) {
+            double list_ns = RunWorkload<ListLRUReplacer>(num_pages, op_num, hit_ratio, &checksum);
+            double array_ns = RunWorkload<LRUReplacer>(num_pages, op_num, hit_ratio, &checksum);
+            printf("%-10zu %-10.2f %16.2f %16.2f %7.2fx\n", num_pages, hit_ratio, list_ns, array_ns, list_ns / array_ns);
+        }
+    }
+    // keep the work observable
+    std::cerr << "checksum " << checksum << std::endl;
+    return 0;
+}
@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "disk/disk_manager.hpp"
+#include "buffer/buffer_pool_manager.hpp"
+
+namespace dsbus {
+
+static constexpr size_t page_size = 4096;
+
+/**
+ *  Each thread reads an int from random pages of a small hot set, as the upper levels of an
+ *  index are read by every lookup.
+ *  @return reads per second over all threads
+ */
+template<typename ReadPage>
+double Run(const size_t thread_num, const size_t read_num, const size_t page_num, ReadPage read_page) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < thread_num; ++t) {
+        threads.emplace_back([=]() {
+            std::mt19937 rng(t);
+            size_t sum = 0;
+            for (size_t i = 0; i < read_num; ++i) sum += read_page(t, rng() % page_num);
+            if (sum == (size_t)-1) printf("unreachable\n");
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return thread_num * read_num / seconds;
+}
+
+} // dsbus
+
+int main(int argc, char *argv[]) {
+    using namespace dsbus;
+    size_t page_num = argc > 1 ? std::stoul(argv[1]) : 16;
+    size_t thread_num = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    size_t read_num = argc > 3 ? std::stoul(argv[3]) : 2000000;
+    remove("benchmark.db");
+    DiskManager disk_manager(Slice("benchmark.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(page_num * 2, &disk_manager);
+        for (size_t i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            if (!guard.IsValid()) break;
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        printf("page_num %zu, threads %zu, read_num %zu\n", page_num, thread_num, read_num);
+        printf("%-22s %14s\n", "read", "reads/s");
+        printf("%-22s %14.0f\n", "FetchPageRead", Run(thread_num, read_num, page_num, [&bpm](size_t, size_t page_id) {
+            int value;
+            memcpy(&value, bpm.FetchPageRead(page_id).GetContent(), sizeof(value));
+            return (size_t)value;
+        }));
+        // a guard per thread and page, kept across reads
+        std::vector<std::vector<OptimisticReadGuard<BufferPoolManager<page_size>>>> guards(thread_num);
+        for (auto &thread_guards : guards) {
+            for (size_t i = 0; i < page_num; ++i) thread_guards.push_back(bpm.FetchPageOptimistic(i));
+        }
+        printf("%-22s %14.0f\n", "optimistic guard", Run(thread_num, read_num, page_num,
+                                                         [&guards](size_t t, size_t page_id) {
+            int value = 0;
+            guards[t][page_id].Read([&value](const char *content) { memcpy(&value, content, sizeof(value)); });
+            return (size_t)value;
+        }));
+    }
+    remove("benchmark.db");
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "disk/disk_manager.hpp"
+#include "buffer/partitioned_buffer_pool.hpp"
+
+namespace dsbus {
+
+static constexpr size_t page_size = 4096;
+
+/**
+ *  Each thread reads random pages, a pool smaller than the pages mixes hits and misses.
+ *  @return fetches per second over all threads
+ */
+template<typename Pool>
+double Run(Pool &pool, const size_t page_num, const size_t thread_num, const size_t fetch_num) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < thread_num; ++t) {
+        threads.emplace_back([&pool, page_num, fetch_num, t]() {
+            std::mt19937 rng(t);
+            size_t sum = 0;
+            for (size_t i = 0; i < fetch_num; ++i) sum += pool.FetchPageRead(rng() % page_num).GetContent()[0];
+            if (sum == (size_t)-1) printf("unreachable\n");
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return thread_num * fetch_num / seconds;
+}
+
+} // dsbus
+
+int main(int argc, char *argv[]) {
+    using namespace dsbus;
+    size_t page_num = argc > 1 ? std::stoul(argv[1]) : 16384;
+    size_t pool_size = argc > 2 ? std::stoul(argv[2]) : 8192;
+    size_t thread_num = argc > 3 ? std::stoul(argv[3]) : std::max(1u, std::thread::hardware_concurrency());
+    size_t fetch_num = argc > 4 ? std::stoul(argv[4]) : 200000;
+    remove("benchmark.db");
+    DiskManager disk_manager(Slice("benchmark.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(64, &disk_manager);
+        for (size_t i = 0; i < page_num; ++i) bpm.NewPageGuarded();
+    }
+    printf("page_num %zu, pool_size %zu, threads %zu, numa nodes %zu\n", page_num, pool_size, thread_num,
+           numa::GetNodeNum());
+    printf("%-12s %14s\n", "partitions", "fetches/s");
+    for (size_t partition_num : {(size_t)1, (size_t)2, (size_t)4, (size_t)8}) {
+        PartitionedBufferPool<page_size> pool(pool_size, &disk_manager, partition_num);
+        Run(pool, page_num, thread_num, fetch_num / 4);
+        printf("%-12zu %14.0f\n", partition_num, Run(pool, page_num, thread_num, fetch_num));
+    }
+    remove("benchmark.db");
+    return 0;
+}
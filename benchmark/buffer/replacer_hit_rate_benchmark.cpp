@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/arc_replacer.hpp"
+#include "buffer/clock_replacer.hpp"
+#include "buffer/lru_k_replacer.hpp"
+#include "buffer/lru_replacer.hpp"
+#include "buffer/two_queue_replacer.hpp"
+
+namespace dsbus {
+
+/**
+ *  Replay a trace of page ids through a replacer the way BufferPoolManager drives it.
+ *  @return hit rate
+ */
+template<typename Replacer>
+double Simulate(const std::vector<page_id_t> &trace, const size_t pool_size) {
+    Replacer replacer(pool_size);
+    page_id_t max_page_id = *std::max_element(trace.begin(), trace.end());
+    std::vector<frame_id_t> page_to_frame(max_page_id + 1, -1);
+    std::vector<page_id_t> frame_to_page(pool_size, INVALID_PAGE_ID);
+    size_t hit = 0;
+    for (auto page_id : trace) {
+        frame_id_t frame_id = page_to_frame[page_id];
+        if (frame_id != -1) {
+            ++hit;
+            replacer.Pin(frame_id);
+        } else {
+            // every frame is unpinned between accesses, there always is a victim
+            if (!replacer.Victim(&frame_id)) return 0;
+            if (frame_to_page[frame_id] != INVALID_PAGE_ID) page_to_frame[frame_to_page[frame_id]] = -1;
+            frame_to_page[frame_id] = page_id;
+            page_to_frame[page_id] = frame_id;
+            replacer.Admit(frame_id, page_id);
+        }
+        replacer.Unpin(frame_id);
+    }
+    return (double)hit / trace.size();
+}
+
+/**
+ *  Zipfian page ids in [0, page_num), skew theta.
+ */
+class ZipfGenerator {
+public:
+    ZipfGenerator(const size_t page_num, const double theta) : cdf_(page_num) {
+        double sum = 0;
+        for (size_t i = 0; i < page_num; ++i) {
+            sum += 1.0 / std::pow((double)(i + 1), theta);
+            cdf_[i] = sum;
+        }
+        for (auto &c : cdf_) c /= sum;
+    }
+
+    page_id_t Next(std::mt19937 &rng) {
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        return (page_id_t)(std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin());
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+/**
+ *  Point lookups on a zipfian hot set, every scan_interval lookups a sequential scan of
+ *  scan_len pages over a separate range of the file.
+ */
+std::vector<page_id_t> MakeTrace(const size_t op_num, const size_t hot_num, const double theta,
+                                 const size_t scan_interval, const size_t scan_len) {
+    std::mt19937 rng(42);
+    ZipfGenerator zipf(hot_num, theta);
+    std::vector<page_id_t> trace;
+    page_id_t scan_start = hot_num;
+    for (size_t i = 0; i < op_num; ++i) {
+        trace.push_back(zipf.Next(rng));
+        if (scan_interval != 0 && i % scan_interval == scan_interval - 1) {
+            for (size_t j = 0; j < scan_len; ++j) trace.push_back(scan_start + j);
+        }
+    }
+    return trace;
+}
+
+/**
+ *  Repeated sequential passes over loop_len pages, the LRU worst case once loop_len > pool.
+ */
+std::vector<page_id_t> MakeLoopTrace(const size_t op_num, const size_t loop_len) {
+    std::vector<page_id_t> trace;
+    for (size_t i = 0; i < op_num; ++i) trace.push_back(i % loop_len);
+    return trace;
+}
+
+void Report(const std::string &name, const std::vector<page_id_t> &trace, const size_t pool_size) {
+    printf("%-22s %8.4f %8.4f %8.4f %8.4f %8.4f\n", name.c_str(),
+           Simulate<LRUReplacer>(trace, pool_size),
+           Simulate<LRUKReplacer>(trace, pool_size),
+           Simulate<ClockReplacer>(trace, pool_size),
+           Simulate<TwoQueueReplacer>(trace, pool_size),
+           Simulate<ARCReplacer>(trace, pool_size));
+}
+
+} // dsbus
+
+/**
+ *  Usage: replacer_hit_rate_benchmark [pool_size] [trace_file]
+ *  trace_file holds whitespace separated page ids, one access each.
+ */
+int main(int argc, char *argv[]) {
+    using namespace dsbus;
+    size_t pool_size = argc > 1 ? std::stoul(argv[1]) : 1024;
+    printf("pool_size %zu\n", pool_size);
+    printf("%-22s %8s %8s %8s %8s %8s\n", "trace", "LRU", "LRU-K", "CLOCK", "2Q", "ARC");
+    if (argc > 2) {
+        std::ifstream in(argv[2]);
+        std::vector<page_id_t> trace;
+        page_id_t page_id;
+        while (in >> page_id) trace.push_back(page_id);
+        if (trace.empty()) {
+            fprintf(stderr, "empty trace %s\n", argv[2]);
+            return 1;
+        }
+        Report(argv[2], trace, pool_size);
+        return 0;
+    }
+    const size_t op_num = 1000000;
+    Report("zipf", MakeTrace(op_num, pool_size * 4, 0.9, 0, 0), pool_size);
+    Report("zipf+scan", MakeTrace(op_num, pool_size * 4, 0.9, 20000, pool_size * 2), pool_size);
+    Report("uniform", MakeTrace(op_num, pool_size * 2, 0.0, 0, 0), pool_size);
+    Report("loop", MakeLoopTrace(op_num, pool_size + pool_size / 4), pool_size);
+    return 0;
+}
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "disk/disk_manager.hpp"
+#include "buffer/buffer_pool_manager.hpp"
+
+namespace dsbus {
+
+static constexpr size_t page_size = 4096;
+
+/**
+ *  Each thread reads an int from random pages of a hot set held in memory, fetched by page id
+ *  or through swips.
+ *  @return fetches per second over all threads
+ */
+template<typename ReadPage>
+double Run(const size_t thread_num, const size_t read_num, const size_t page_num, ReadPage read_page) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t t = 0; t < thread_num; ++t) {
+        threads.emplace_back([=]() {
+            std::mt19937 rng(t);
+            size_t sum = 0;
+            for (size_t i = 0; i < read_num; ++i) sum += read_page(rng() % page_num);
+            if (sum == (size_t)-1) printf("unreachable\n");
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return thread_num * read_num / seconds;
+}
+
+} // dsbus
+
+int main(int argc, char *argv[]) {
+    using namespace dsbus;
+    size_t page_num = argc > 1 ? std::stoul(argv[1]) : 1024;
+    size_t thread_num = argc > 2 ? std::stoul(argv[2]) : std::max(1u, std::thread::hardware_concurrency());
+    size_t read_num = argc > 3 ? std::stoul(argv[3]) : 2000000;
+    remove("benchmark.db");
+    DiskManager disk_manager(Slice("benchmark.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(page_num * 2, &disk_manager);
+        for (size_t i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            if (!guard.IsValid()) break;
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        std::vector<std::unique_ptr<Swip>> swips;
+        for (size_t i = 0; i < page_num; ++i) swips.emplace_back(new Swip(i));
+        printf("page_num %zu, threads %zu, read_num %zu\n", page_num, thread_num, read_num);
+        printf("%-22s %14s\n", "fetch", "fetches/s");
+        printf("%-22s %14.0f\n", "page id", Run(thread_num, read_num, page_num, [&bpm](size_t page_id) {
+            int value;
+            memcpy(&value, bpm.FetchPageRead(page_id).GetContent(), sizeof(value));
+            return (size_t)value;
+        }));
+        printf("%-22s %14.0f\n", "swip", Run(thread_num, read_num, page_num, [&bpm, &swips](size_t page_id) {
+            int value;
+            memcpy(&value, bpm.FetchPageRead(*swips[page_id]).GetContent(), sizeof(value));
+            return (size_t)value;
+        }));
+        for (auto &swip : swips) bpm.Unswizzle(*swip);
+    }
+    remove("benchmark.db");
+    return 0;
+}
@@ -0,0 +1,143 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "common/crc32c.h"
+#include "disk/disk_manager.hpp"
+#include "disk/mmap_disk_manager.hpp"
+
+namespace dsbus {
+
+static constexpr size_t page_size = 4096;
+
+/**
+ *  The previous DiskManager, one std::fstream seeked under a mutex, kept as baseline.
+ */
+class FStreamDiskManager {
+public:
+    FStreamDiskManager(const Slice &db_file_name, const size_t page_size) : page_size_(page_size) {
+        db_io_.open(db_file_name.Data(), std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
+    }
+
+    void ReadPage(page_id_t page_id, char *page_data) {
+        std::lock_guard<std::mutex> guard(io_latch_);
+        db_io_.seekp(disk::DISK_HEADER_PAGE_SIZE + (size_t)page_id * page_size_);
+        db_io_.read(page_data, page_size_);
+    }
+
+    void WritePage(page_id_t page_id, const char *page_data) {
+        std::lock_guard<std::mutex> guard(io_latch_);
+        db_io_.seekp(disk::DISK_HEADER_PAGE_SIZE + (size_t)page_id * page_size_);
+        db_io_.write(page_data, page_size_);
+        db_io_.flush();
+    }
+
+    void ShutDown() { db_io_.close(); }
+
+private:
+    size_t page_size_;
+    std::fstream db_io_;
+    std::mutex io_latch_;
+};
+
+/**
+ *  DiskManager keeping page checksums.
+ */
+class ChecksumDiskManager : public DiskManager {
+public:
+    ChecksumDiskManager(const Slice &db_file_name, const size_t page_size)
+                      : DiskManager(db_file_name, page_size, DiskManagerOptions{false, true}) {}
+};
+
+/**
+ *  CRC32C of a page, repeated.
+ *  @return GB per second
+ */
+template<typename Extend>
+double RunChecksum(Extend extend) {
+    const size_t round_num = 1 << 18;
+    std::vector<unsigned char> data(page_size, 'a');
+    uint32_t crc = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < round_num; ++i) crc = extend(crc, data.data(), page_size);
+    auto end = std::chrono::steady_clock::now();
+    // keep the loop
+    if (crc == 42) printf("\n");
+    return (double)round_num * page_size / std::chrono::duration<double, std::nano>(end - start).count();
+}
+
+/**
+ *  Split op_num page accesses over thread_num threads.
+ *  @return microseconds per page
+ */
+template<typename Disk, typename Op>
+double RunThreads(Disk &disk_manager, const size_t op_num, const size_t thread_num, Op op) {
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_num; ++t) {
+        threads.emplace_back([&disk_manager, &op, op_num, thread_num, t]() {
+            std::vector<char> data(page_size);
+            for (size_t i = t; i < op_num; i += thread_num) op(disk_manager, i, data.data());
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / op_num;
+}
+
+/**
+ *  Write page_num pages, then read them all in order and op_num of them at random.
+ */
+template<typename Disk>
+void RunWorkload(const std::string &name, const size_t page_num, const size_t thread_num) {
+    remove("benchmark.db");
+    const size_t op_num = page_num * 4;
+    std::vector<page_id_t> random_ids(op_num);
+    std::mt19937 rng(42);
+    for (auto &page_id : random_ids) page_id = rng() % page_num;
+    double write_us, seq_us, rand_us;
+    {
+        Disk disk_manager(Slice("benchmark.db"), page_size);
+        write_us = RunThreads(disk_manager, page_num, thread_num, [](Disk &dm, size_t i, char *data) {
+            memset(data, (int)i, page_size);
+            dm.WritePage((page_id_t)i, data);
+        });
+        seq_us = RunThreads(disk_manager, page_num, thread_num, [](Disk &dm, size_t i, char *data) {
+            dm.ReadPage((page_id_t)i, data);
+        });
+        rand_us = RunThreads(disk_manager, op_num, thread_num, [&random_ids](Disk &dm, size_t i, char *data) {
+            dm.ReadPage(random_ids[i], data);
+        });
+        disk_manager.ShutDown();
+    }
+    printf("%-10s %8zu %12.3f %12.3f %12.3f\n", name.c_str(), thread_num, write_us, seq_us, rand_us);
+    remove("benchmark.db");
+}
+
+} // dsbus
+
+/**
+ *  Usage: disk_manager_benchmark [page_num]
+ *  The file is page_num pages of 4KB, mostly served from the page cache after it is written.
+ */
+int main(int argc, char *argv[]) {
+    using namespace dsbus;
+    size_t page_num = argc > 1 ? std::stoul(argv[1]) : 16384;
+    printf("page_num %zu, page_size %zu\n", page_num, page_size);
+    printf("%-10s %8s %12s %12s %12s\n", "backend", "threads", "write us/pg", "seq us/pg", "rand us/pg");
+    for (size_t thread_num : {1, 4}) {
+        RunWorkload<FStreamDiskManager>("fstream", page_num, thread_num);
+        RunWorkload<DiskManager>("pread", page_num, thread_num);
+        RunWorkload<ChecksumDiskManager>("pread+crc", page_num, thread_num);
+        RunWorkload<MMapDiskManager>("mmap", page_num, thread_num);
+    }
+    printf("crc32c of a page: hardware %.2f GB/s, software %.2f GB/s\n",
+           crc32c::HasHardware() ? RunChecksum(crc32c::ExtendHardware) : 0.0, RunChecksum(crc32c::ExtendSoftware));
+    return 0;
+}
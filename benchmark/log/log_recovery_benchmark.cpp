@@ -0,0 +1,80 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+
+#include "disk/disk_manager.hpp"
+#include "buffer/buffer_pool_manager.hpp"
+#include "log/log_manager.hpp"
+#include "log/log_recovery.hpp"
+
+namespace dsbus {
+
+static constexpr size_t page_size = 4096;
+
+/**
+ *  Write page_num empty pages, then a log of one committed transaction updating random pages,
+ *  as left by a crash before any page was written back.
+ */
+void CreateCrashedDB(const size_t page_num, const size_t update_num) {
+    remove("benchmark.db");
+    remove("benchmark.log");
+    {
+        DiskManager disk_manager(Slice("benchmark.db"), page_size);
+        std::string page(page_size, 0);
+        for (size_t i = 0; i < page_num; ++i) {
+            page_id_t page_id = disk_manager.AllocatePage();
+            memcpy(&page[disk::OFFSET_PAGE_ID], &page_id, sizeof(page_id));
+            disk_manager.WritePage(page_id, page.data());
+        }
+    }
+    LogManager log_manager(Slice("benchmark.log"));
+    std::mt19937_64 rng(42);
+    std::string before(64, 'a');
+    std::string after(64, 'b');
+    LogRecord begin(LogRecordType::BEGIN, 1, INVALID_LSN);
+    lsn_t lsn = log_manager.AppendLogRecord(&begin);
+    for (size_t i = 0; i < update_num; ++i) {
+        page_id_t page_id = rng() % page_num;
+        uint32_t offset = rng() % (page_size - disk::PAGE_HEADER_SIZE - before.size());
+        LogRecord record(1, lsn, page_id, offset, before.data(), after.data(), (uint32_t)before.size());
+        lsn = log_manager.AppendLogRecord(&record);
+    }
+    LogRecord commit(LogRecordType::COMMIT, 1, lsn);
+    log_manager.AppendLogRecord(&commit);
+}
+
+/**
+ *  Recover the crashed db with thread_num redo threads, the pool holds every page.
+ */
+void RunRecovery(const size_t page_num, const size_t update_num, const size_t thread_num) {
+    // each run starts from the same crash
+    CreateCrashedDB(page_num, update_num);
+    LogManager log_manager(Slice("benchmark.log"));
+    DiskManager disk_manager(Slice("benchmark.db"), page_size);
+    BufferPoolOptions options;
+    options.log_manager_ = &log_manager;
+    BufferPoolManager<page_size> bpm(page_num, &disk_manager, options);
+    LogRecoveryOptions recovery_options;
+    recovery_options.redo_thread_num_ = thread_num;
+    LogRecovery<BufferPoolManager<page_size>, DiskManager> recovery(&log_manager, &bpm, &disk_manager,
+                                                                    recovery_options);
+    auto start = std::chrono::steady_clock::now();
+    recovery.Recover();
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%8zu %12zu %12.1f\n", thread_num, recovery.GetRedoNum(), ms);
+}
+
+} // dsbus
+
+int main(int argc, char *argv[]) {
+    using namespace dsbus;
+    size_t page_num = argc > 1 ? std::stoul(argv[1]) : 16384;
+    size_t update_num = argc > 2 ? std::stoul(argv[2]) : 1000000;
+    printf("page_num %zu, page_size %zu, update_num %zu\n", page_num, page_size, update_num);
+    printf("%8s %12s %12s\n", "threads", "redone", "recover ms");
+    for (size_t thread_num : {1, 2, 4, 8}) RunRecovery(page_num, update_num, thread_num);
+    remove("benchmark.db");
+    remove("benchmark.log");
+    return 0;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "disk/disk_config.h"
+
+namespace dsbus {
+
+enum class AccessType {
+    // pages compete for the whole pool through the replacer
+    NORMAL,
+    // a large read-only pass, each page is used once
+    SEQUENTIAL_SCAN,
+    // a large pass creating or rewriting pages
+    BULK_WRITE
+};
+
+/**
+ *  BufferAccessStrategy confines the pages loaded by one scan to a small ring of frames.
+ *
+ *  A page missing from the pool is loaded into the next frame of the ring, evicting the page
+ *  the scan put there a lap before, instead of into a victim of the replacer. Pages already
+ *  resident are used in place without being moved in the replacer order. A scan over any
+ *  number of pages thus evicts at most ring size pages of the rest of the pool.
+ *
+ *  The strategy holds a pin on every frame of its ring, so they are never victims of the
+ *  replacer, and gives them back when destroyed or released. A ring frame that another
+ *  thread has pinned when its turn comes is left to the pool and replaced in the ring.
+ *
+ *  A strategy belongs to a single scan, it is not thread safe, and must be released before
+ *  its buffer pool is destroyed. Strategies are move only, a default constructed one is NORMAL.
+ */
+template<typename BufferPool>
+class BufferAccessStrategy {
+    friend BufferPool;
+public:
+    BufferAccessStrategy() = default;
+
+    BufferAccessStrategy(BufferPool *bpm, const AccessType type, const size_t ring_size)
+                       : bpm_(bpm), type_(type), ring_(type == AccessType::NORMAL ? 0 : ring_size, -1) {}
+
+    BufferAccessStrategy(const BufferAccessStrategy &) = delete;
+    BufferAccessStrategy &operator=(const BufferAccessStrategy &) = delete;
+
+    BufferAccessStrategy(BufferAccessStrategy &&other) noexcept { Take(other); }
+
+    BufferAccessStrategy &operator=(BufferAccessStrategy &&other) noexcept {
+        if (this != &other) {
+            Release();
+            Take(other);
+        }
+        return *this;
+    }
+
+    ~BufferAccessStrategy() { Release(); }
+
+    /**
+     *  @brief Unpin the frames of the ring, the pages stay in the pool as evictable.
+     */
+    void Release() {
+        for (auto &frame_id : ring_) {
+            if (frame_id != -1) bpm_->UnpinFrame(frame_id);
+            frame_id = -1;
+        }
+    }
+
+    AccessType GetType() const { return type_; }
+
+    size_t GetRingSize() const { return ring_.size(); }
+
+private:
+    BufferPool *bpm_ = nullptr;
+    AccessType type_ = AccessType::NORMAL;
+    // frames owned by the strategy, -1 for a slot not used yet
+    std::vector<frame_id_t> ring_;
+    // slot the next page is loaded into
+    size_t current_ = 0;
+    // last page the scan missed, for the read-ahead of the buffer pool
+    page_id_t last_miss_page_id_ = INVALID_PAGE_ID;
+
+    bool UseRing() const { return !ring_.empty(); }
+
+    /**
+     *  @brief Returns the slot the next missing page is loaded into, and advances.
+     */
+    frame_id_t &NextSlot() {
+        auto &slot = ring_[current_];
+        current_ = (current_ + 1) % ring_.size();
+        return slot;
+    }
+
+    void Take(BufferAccessStrategy &other) {
+        bpm_ = other.bpm_;
+        type_ = other.type_;
+        ring_ = std::move(other.ring_);
+        current_ = other.current_;
+        last_miss_page_id_ = other.last_miss_page_id_;
+        other.ring_.clear();
+    }
+};
+
+} // dsbus
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "buffer/frame_list.hpp"
+#include "buffer/ghost_list.hpp"
+#include "disk/disk_config.h"
+
+namespace dsbus {
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy (Megiddo & Modha).
+ *
+ * T1 holds pages seen once recently, T2 pages seen at least twice. Evicted pages are remembered
+ * in the ghost lists B1 and B2. A page loaded while remembered in B1 grows the target size p of
+ * T1, one remembered in B2 shrinks it, and eviction takes from T1 while it is larger than p.
+ * The split between recency and frequency thus follows the workload.
+ *
+ * Lists link unpinned frames only, a frame keeps its list while pinned and rejoins its MRU end
+ * when unpinned.
+ */
+class ARCReplacer {
+public:
+    /**
+     *  @brief Create a new ARCReplacer.
+     *  @param num_pages the maximum number of pages the ARCReplacer will be required to store
+     */
+    explicit ARCReplacer(const size_t num_pages)
+                        : num_pages_(num_pages), capacity_(num_pages), nodes_(num_pages), lists_(num_pages, 3),
+                          b1_(std::max<size_t>(1, num_pages)), b2_(std::max<size_t>(1, num_pages)) {
+        for (size_t i = 0; i < num_pages; ++i) lists_.PushBack(FREE_LIST, (frame_id_t)i);
+    }
+
+    ~ARCReplacer() {}
+
+    /**
+     *  @brief Remove the victim frame as defined by the replacement policy.
+     *         Pin the evicted frame.
+     *  @param[out] frame_id id of frame that was removed
+     *  @return true if a victim frame was found, false otherwise
+     */
+    bool Victim(frame_id_t *frame_id) {
+        if (!lists_.Empty(FREE_LIST)) {
+            *frame_id = lists_.Front(FREE_LIST);
+        } else if (!lists_.Empty(T1_LIST) && (t1_size_ > p_ || lists_.Empty(T2_LIST))) {
+            *frame_id = lists_.Front(T1_LIST);
+            b1_.PushBack(nodes_[*frame_id].page_id_);
+        } else if (!lists_.Empty(T2_LIST)) {
+            *frame_id = lists_.Front(T2_LIST);
+            b2_.PushBack(nodes_[*frame_id].page_id_);
+        } else {
+            return false;
+        }
+        Take(*frame_id);
+        TrimGhosts();
+        return true;
+    }
+
+    /**
+     *  @brief Pins a frame, a page accessed again while in T1 moves to T2.
+     *  @param frame_id the id of the frame to pin
+     */
+    void Pin(frame_id_t frame_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        if (node.pin_count_ != 0) {
+            ++node.pin_count_;
+        } else if (node.list_ == FREE_LIST) {
+            Take(frame_id);
+            return;
+        } else {
+            lists_.Remove(frame_id);
+            node.pin_count_ = 1;
+        }
+        MoveTo(frame_id, T2_LIST);
+    }
+
+    /**
+     *  @brief Unpins a frame, indicating that it can now be victimized.
+     *  @param frame_id the id of the frame to unpin
+     */
+    void Unpin(frame_id_t frame_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        if (node.pin_count_ == 0) return;
+        if (--node.pin_count_ != 0) return;
+        lists_.PushBack(node.list_, frame_id);
+    }
+
+    /**
+     *  @brief A pinned frame accessed again moves to T2, as for Pin.
+     */
+    void RecordAccess(frame_id_t frame_id, size_t access_num) {
+        if (!IsValid(frame_id) || nodes_[frame_id].pin_count_ == 0 || access_num == 0) return;
+        MoveTo(frame_id, T2_LIST);
+    }
+
+    /**
+     *  @brief A page remembered by a ghost list adapts p and enters T2.
+     */
+    void Admit(frame_id_t frame_id, page_id_t page_id) {
+        if (!IsValid(frame_id)) return;
+        nodes_[frame_id].page_id_ = page_id;
+        if (b1_.Contains(page_id)) {
+            size_t delta = std::max<size_t>(1, b2_.Size() / b1_.Size());
+            p_ = std::min(capacity_, p_ + delta);
+            b1_.Erase(page_id);
+            MoveTo(frame_id, T2_LIST);
+        } else if (b2_.Contains(page_id)) {
+            size_t delta = std::max<size_t>(1, b1_.Size() / b2_.Size());
+            p_ = p_ > delta ? p_ - delta : 0;
+            b2_.Erase(page_id);
+            MoveTo(frame_id, T2_LIST);
+        }
+    }
+
+    /**
+     *  @brief The number of elements in the replacer that can be victimized.
+     */
+    size_t Size() { return lists_.Size(FREE_LIST) + lists_.Size(T1_LIST) + lists_.Size(T2_LIST); }
+
+    /**
+     *  @brief Copy the at most n next victims, taken from T1 and T2 as Victim would.
+     *
+     *  A frame victimized from T1 starts over in T1, one from T2 moves there, so T1 grows
+     *  by one per T2 victim. The target p only changes in Admit.
+     */
+    size_t NextVictims(frame_id_t *frame_ids, const size_t n) const {
+        std::vector<frame_id_t> t1(n), t2(n);
+        size_t t1_num = lists_.CopyFront(T1_LIST, t1.data(), n);
+        size_t t2_num = lists_.CopyFront(T2_LIST, t2.data(), n);
+        size_t t1_size = t1_size_;
+        size_t i = 0, j = 0, count = 0;
+        while (count < n && (i < t1_num || j < t2_num)) {
+            if (i < t1_num && (t1_size > p_ || j == t2_num)) {
+                frame_ids[count++] = t1[i++];
+            } else {
+                frame_ids[count++] = t2[j++];
+                ++t1_size;
+            }
+        }
+        return count;
+    }
+
+    /**
+     *  @brief Move a pinned frame that holds no page out of T1 or T2 to the free list.
+     */
+    void Free(frame_id_t frame_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        if (node.pin_count_ == 0) return;
+        MoveTo(frame_id, FREE_LIST);
+        node.page_id_ = INVALID_PAGE_ID;
+        node.pin_count_ = 0;
+        lists_.PushBack(FREE_LIST, frame_id);
+    }
+
+    /**
+     *  @brief Frames past frame_num leave T1 and T2, frames used again join the free list. The
+     *         cache size c of the policy is the number of frames used.
+     */
+    void SetCapacity(const size_t frame_num) {
+        auto capacity = std::min(frame_num, num_pages_);
+        for (size_t i = capacity; i < capacity_; ++i) {
+            MoveTo((frame_id_t)i, FREE_LIST);
+            nodes_[i].page_id_ = INVALID_PAGE_ID;
+        }
+        for (size_t i = capacity_; i < capacity; ++i) Free((frame_id_t)i);
+        capacity_ = capacity;
+        p_ = std::min(p_, capacity_);
+        TrimGhosts();
+    }
+
+    /**
+     *  @brief Returns the current target size of T1.
+     */
+    size_t GetTarget() const { return p_; }
+
+private:
+    static constexpr size_t FREE_LIST = 0;
+    static constexpr size_t T1_LIST = 1;
+    static constexpr size_t T2_LIST = 2;
+
+    struct Node {
+        uint32_t pin_count_ = 0;
+        // list the frame belongs to, FREE_LIST until it is first used
+        uint32_t list_ = FREE_LIST;
+        page_id_t page_id_ = INVALID_PAGE_ID;
+    };
+
+    size_t num_pages_;
+    // frames the pool uses, c of the policy, see SetCapacity
+    size_t capacity_;
+    std::vector<Node> nodes_;
+    FrameLists lists_;
+    // number of frames in T1 and T2, pinned ones included
+    size_t t1_size_ = 0;
+    size_t t2_size_ = 0;
+    // target size of T1
+    size_t p_ = 0;
+    GhostList b1_;
+    GhostList b2_;
+
+    bool IsValid(frame_id_t frame_id) const { return frame_id >= 0 && (size_t)frame_id < num_pages_; }
+
+    /**
+     *  @brief Move a pinned frame to list.
+     */
+    void MoveTo(frame_id_t frame_id, uint32_t list) {
+        auto &node = nodes_[frame_id];
+        if (node.list_ == list) return;
+        if (node.list_ == T1_LIST) --t1_size_;
+        if (node.list_ == T2_LIST) --t2_size_;
+        node.list_ = list;
+        if (list == T1_LIST) ++t1_size_;
+        if (list == T2_LIST) ++t2_size_;
+    }
+
+    /**
+     *  @brief Pin an unpinned frame for a new page, which starts in T1.
+     */
+    void Take(frame_id_t frame_id) {
+        auto &node = nodes_[frame_id];
+        lists_.Remove(frame_id);
+        node.pin_count_ = 1;
+        node.page_id_ = INVALID_PAGE_ID;
+        MoveTo(frame_id, T1_LIST);
+    }
+
+    /**
+     *  @brief Keep |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c.
+     */
+    void TrimGhosts() {
+        while (b1_.Size() != 0 && t1_size_ + b1_.Size() > capacity_) b1_.PopFront();
+        while (b2_.Size() != 0 && t1_size_ + t2_size_ + b1_.Size() + b2_.Size() > 2 * capacity_) b2_.PopFront();
+    }
+};
+
+} // dsbus
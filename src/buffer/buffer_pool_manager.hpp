@@ -1,167 +1,1371 @@
 #pragma once
 
-#include <unordered_map>
-#include <list>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "common/stats.h"
+#include "buffer/access_strategy.hpp"
+#include "buffer/frame_arena.hpp"
+#include "buffer/frame_header.hpp"
 #include "buffer/lru_replacer.hpp"
+#include "buffer/page_guard.hpp"
+#include "buffer/page_table.hpp"
+#include "buffer/replacer.hpp"
+#include "buffer/swip.hpp"
 #include "disk/disk_page.hpp"
 #include "disk/disk_manager.hpp"
+#include "disk/mmap_disk_manager.hpp"
+#include "log/log_manager.hpp"
 
 namespace dsbus {
 
-template<size_t page_size>
+struct BufferPoolOptions {
+    // run a background writer, which writes dirty pages of the frames next in the victim
+    // order of the replacer, so that evictions mostly find clean frames
+    bool background_writer_ = false;
+    // the writer runs a round every interval, and as soon as an eviction had to write a page
+    size_t writer_interval_ms_ = BG_WRITER_INTERVAL_MS;
+    // pages written per round at most, which bounds the rate of the writer
+    size_t writer_max_pages_ = BG_WRITER_MAX_PAGES;
+    // a round looks at the next high watermark victims, and writes those that are dirty
+    // when fewer than low watermark of them are clean
+    size_t writer_low_watermark_ = BG_WRITER_LOW_WATERMARK;
+    size_t writer_high_watermark_ = BG_WRITER_HIGH_WATERMARK;
+    // pages FetchPage loads ahead once it misses two consecutive pages, 0 disables read-ahead
+    size_t read_ahead_page_num_ = READ_AHEAD_PAGE_NUM;
+    // if not 0, read-ahead stops at the end of the extent of this many pages it started in
+    size_t read_ahead_extent_page_num_ = 0;
+    // if not nullptr, the log is flushed up to the LSN of a dirty page before the page is written
+    LogManager *log_manager_ = nullptr;
+    // back the frames with huge pages, see FrameArena for the fallbacks
+    HugePageMode huge_pages_ = HugePageMode::NONE;
+    // NUMA node the frames are placed on, -1 to leave them to the memory policy of the process
+    int numa_node_ = -1;
+    // frames Resize may grow the pool to, address space is reserved for them up front and memory
+    // taken as frames are used; 0 for the initial pool size, whose memory a shrink then keeps
+    size_t max_pool_size_ = 0;
+};
+
+/**
+ *  Memory held by a BufferPoolManager, see GetMemoryStats.
+ */
+struct BufferPoolMemoryStats {
+    size_t frame_num_ = 0;
+    // frames the pool may grow to, see BufferPoolManager::Resize
+    size_t max_frame_num_ = 0;
+    // memory reserved for the frames, rounded up to whole huge pages when backed by them
+    size_t frame_bytes_ = 0;
+    // bookkeeping of the frames, allocated for the max frame num
+    size_t frame_header_bytes_ = 0;
+    // the backing the frames got, which may be a fallback from the one asked for
+    HugePageMode huge_page_mode_ = HugePageMode::NONE;
+    // frame memory backed by huge pages, transparent ones only once frames are touched
+    size_t huge_page_bytes_ = 0;
+    // NUMA node the frames are bound to, -1 if none
+    int numa_node_ = -1;
+};
+
+/**
+ *  Activity of a BufferPoolManager since it was created, see GetStats.
+ */
+struct BufferPoolStats {
+    // fetches that found the page resident, or being read by a prefetch
+    uint64_t hit_num_ = 0;
+    // fetches that read the page from disk
+    uint64_t miss_num_ = 0;
+    uint64_t new_page_num_ = 0;
+    // pages read in the background by Prefetch and read-ahead
+    uint64_t prefetch_num_ = 0;
+    // pages unmapped to free their frame
+    uint64_t eviction_num_ = 0;
+    // dirty pages written back by evictions, by the background writer, and by FlushAllData
+    uint64_t eviction_write_num_ = 0;
+    uint64_t writer_write_num_ = 0;
+    uint64_t flush_write_num_ = 0;
+    // times a thread waited for a frame, every frame being pinned by prefetches, for the read
+    // of a prefetched page, or for the latch of a page taken by a page guard or of a page table
+    // shard, and the time spent waiting
+    uint64_t frame_wait_num_ = 0;
+    uint64_t frame_wait_nanos_ = 0;
+    // frames as they are when the stats are taken
+    size_t frame_num_ = 0;
+    size_t resident_frame_num_ = 0;
+    size_t pinned_frame_num_ = 0;
+    // sum of the pin counts
+    size_t pin_num_ = 0;
+    size_t dirty_frame_num_ = 0;
+    // latency of the reads of the Disk, synchronous ones and those of prefetches, until read
+    LatencySnapshot read_latency_;
+    // latency of the writes of the Disk, a batch of pages written at once counts once
+    LatencySnapshot write_latency_;
+
+    double GetHitRatio() const {
+        return hit_num_ + miss_num_ == 0 ? 0 : (double)hit_num_ / (hit_num_ + miss_num_);
+    }
+
+    void Merge(const BufferPoolStats &other) {
+        hit_num_ += other.hit_num_;
+        miss_num_ += other.miss_num_;
+        new_page_num_ += other.new_page_num_;
+        prefetch_num_ += other.prefetch_num_;
+        eviction_num_ += other.eviction_num_;
+        eviction_write_num_ += other.eviction_write_num_;
+        writer_write_num_ += other.writer_write_num_;
+        flush_write_num_ += other.flush_write_num_;
+        frame_wait_num_ += other.frame_wait_num_;
+        frame_wait_nanos_ += other.frame_wait_nanos_;
+        frame_num_ += other.frame_num_;
+        resident_frame_num_ += other.resident_frame_num_;
+        pinned_frame_num_ += other.pinned_frame_num_;
+        pin_num_ += other.pin_num_;
+        dirty_frame_num_ += other.dirty_frame_num_;
+        read_latency_.Merge(other.read_latency_);
+        write_latency_.Merge(other.write_latency_);
+    }
+};
+
+template<size_t page_size, typename Replacer, typename Disk>
+class PartitionedBufferPool;
+
+/**
+ *  BufferPoolManager caches pages of a DiskManager in a fixed number of frames.
+ *
+ *  The replacement policy is the Replacer template parameter, any type modelling the
+ *  concept in buffer/replacer.hpp: LRUReplacer, LRUKReplacer, ClockReplacer,
+ *  TwoQueueReplacer or ARCReplacer.
+ *
+ *  The storage backend is the Disk template parameter, DiskManager or MMapDiskManager.
+ *
+ *  All methods are thread safe. Resident pages are found through a sharded PageTable,
+ *  so lookups only latch the shard of the page. Shards are never latched across disk I/O: a
+ *  miss maps its frame before reading, and users of the page wait for the read on the frame,
+ *  an eviction writes the page back before it unmaps it. The replacer is protected by its own latch,
+ *  which is taken only when a pin count changes to or from zero, pages pinned by several
+ *  threads at once never touch it.
+ *
+ *  FetchPageRead / FetchPageWrite / NewPageGuarded return guards that latch the page
+ *  and unpin it when they go out of scope. The raw FetchPage / NewPage do not latch page
+ *  content, callers that share such pages across threads take GetPageLatch() themselves.
+ *  FetchPageOptimistic returns a guard reading a page without pinning or latching it, which
+ *  retries reads a writer raced with, through the version of the frame latch.
+ *
+ *  Pages can also be fetched through a Swip, which the fetch swizzles into a pointer to the
+ *  frame, so that the next fetches skip the page table.
+ *
+ *  Fetching methods take an optional BufferAccessStrategy from GetAccessStrategy(), with which
+ *  a sequential scan or a bulk write recycles a small ring of frames instead of evicting the
+ *  hot pages of the pool.
+ *
+ *  Prefetch loads pages in the background, through the asynchronous reads of the Disk. FetchPage
+ *  uses it to read ahead of sequential access: two misses on consecutive pages load a window of
+ *  the following pages, and fetching a page in the middle of a window loads the next one.
+ *
+ *  Page ids come from the Disk, DeletePage gives a page back for NewPage to reuse.
+ *
+ *  With a LogManager in BufferPoolOptions, pages follow write-ahead logging: a dirty page is
+ *  written only once the log is durable up to its LSN, see WritePageGuard::SetLSN. Each frame
+ *  keeps the recLSN of its page, the first LSN since the page was written, GetDirtyPageTable
+ *  returns them for fuzzy checkpoints, and DrainDirtyPages has the background writer write
+ *  the pages of a checkpoint a few at a time, so that the redo point moves forward.
+ *
+ *  Dirty pages are written back when evicted, by the thread looking for a frame, unless the
+ *  background writer of BufferPoolOptions has cleaned them beforehand.
+ *
+ *  GetStats returns hits, misses, evictions, writes, frame waits and the latency of the I/O of
+ *  the Disk, counted per thread and summed on demand, to size the pool and pick its Replacer.
+ *
+ *  Resize grows or shrinks the pool while it is in use, up to the max_pool_size_ of
+ *  BufferPoolOptions, so that memory moves between the pools of a process as their load shifts.
+ */
+template<size_t page_size, typename Replacer = LRUReplacer, typename Disk = DiskManager>
 class BufferPoolManager {
+    static_assert(IsReplacer<Replacer>::value, "Replacer does not model the replacer concept");
+    friend class ReadPageGuard<BufferPoolManager>;
+    friend class WritePageGuard<BufferPoolManager>;
+    friend class BufferAccessStrategy<BufferPoolManager>;
+    friend class PartitionedBufferPool<page_size, Replacer, Disk>;
 public:
+    using PageType = disk::Page<page_size>;
+    using AccessStrategy = BufferAccessStrategy<BufferPoolManager>;
+
     /**
      *  @brief Init a buffer pool manager instance.
-     *  
+     *
      *  @param pool_size buffer pool size
      *  @param disk_manager for read write db file
+     *  @param options see BufferPoolOptions
      */
-    BufferPoolManager(const size_t pool_size, DiskManager *disk_manager)
-                    : pool_size_(pool_size), disk_manager_(disk_manager) {
-        next_page_id_ = disk_manager_->GetPageNum();
-        pages_ = (disk::Page<page_size>*)malloc(page_size * pool_size_);
-        replacer_ = new LRUReplacer(pool_size);
+    BufferPoolManager(const size_t pool_size, Disk *disk_manager,
+                      const BufferPoolOptions &options = BufferPoolOptions())
+                    : pool_size_(pool_size), max_pool_size_(std::max(pool_size, options.max_pool_size_)),
+                      arena_(pool_size, page_size, options.huge_pages_, options.numa_node_, max_pool_size_),
+                      disk_manager_(disk_manager), options_(options) {
+        pages_ = (disk::Page<page_size>*)arena_.GetData();
+        frames_ = new FrameHeader[max_pool_size_];
+        for (size_t i = 0; i < pool_size; ++i) {
+            pages_[i].ResetMemory();
+            pages_[i].SetPageId(INVALID_PAGE_ID);
+        }
+        replacer_ = new Replacer(max_pool_size_);
+        // frames past the pool size stay pinned until Resize uses them
+        for (size_t i = pool_size; i < max_pool_size_; ++i) {
+            replacer_->Pin((frame_id_t)i);
+            frames_[i].pin_count_.store(1);
+        }
+        replacer_->SetCapacity(pool_size);
+        if (options_.background_writer_) writer_ = std::thread(&BufferPoolManager::RunWriter, this);
     }
 
     ~BufferPoolManager() {
+        while (prefetch_num_.load() != 0) std::this_thread::yield();
+        if (writer_.joinable()) {
+            {
+                std::lock_guard<std::mutex> guard(writer_latch_);
+                writer_stop_ = true;
+            }
+            writer_cv_.notify_one();
+            writer_.join();
+        }
+        for (size_t i = 0; i < pool_size_.load(); ++i) UnswizzleFrame(i, pages_[i].GetPageId());
         FlushAllData();
-        free(pages_);
+        delete[] frames_;
         delete replacer_;
     }
 
-    size_t GetPoolSize() const { return pool_size_; }
+    size_t GetPoolSize() const { return pool_size_.load(); }
+
+    size_t GetMaxPoolSize() const { return max_pool_size_; }
+
+    /**
+     *  @brief Grow or shrink the pool to pool_size frames, at least 1 and at most GetMaxPoolSize().
+     *
+     *  Growing adds free frames. Shrinking releases frames from the last one down, in chunks of
+     *  RESIZE_CHUNK_FRAME_NUM: the page of each frame is evicted, written back if dirty, and the
+     *  memory of the frames is given back after each chunk. The pool stays usable meanwhile, a
+     *  frame that is pinned stops the shrink there. Resizes run one at a time.
+     *
+     *  @return the pool size reached, larger than pool_size if a shrink met a pinned frame
+     */
+    size_t Resize(size_t pool_size) {
+        std::lock_guard<std::mutex> resize_guard(resize_latch_);
+        pool_size = std::min(std::max<size_t>(1, pool_size), max_pool_size_);
+        size_t size = pool_size_.load();
+        if (pool_size > size) {
+            arena_.Resize(pool_size);
+            for (size_t i = size; i < pool_size; ++i) {
+                // memory given back by a shrink reads as zeroes, which is not an invalid page id,
+                // optimistic readers tell the frame lost its page by its epoch meanwhile
+                frames_[i].latch_.BeginChange();
+                pages_[i].ResetMemory();
+                pages_[i].SetPageId(INVALID_PAGE_ID);
+                frames_[i].latch_.EndChange();
+            }
+            {
+                std::lock_guard<std::mutex> guard(replacer_latch_);
+                for (size_t i = size; i < pool_size; ++i) frames_[i].pin_count_.store(0);
+                replacer_->SetCapacity(pool_size);
+            }
+            pool_size_.store(pool_size);
+            return pool_size;
+        }
+        while (size > pool_size) {
+            size_t chunk_end = size;
+            size_t chunk_start = std::max(pool_size, size - std::min(size, RESIZE_CHUNK_FRAME_NUM));
+            while (size > chunk_start && RetireFrame(size - 1)) --size;
+            if (size == chunk_end) break;
+            {
+                std::lock_guard<std::mutex> guard(replacer_latch_);
+                replacer_->SetCapacity(size);
+            }
+            pool_size_.store(size);
+            arena_.Resize(size);
+            if (size != chunk_start) break;
+        }
+        return size;
+    }
+
+    /**
+     *  @brief Create an access strategy for one scan of type.
+     *  @param ring_size number of frames the scan may use, a default for type if 0,
+     *         at most 1/8 of the pool
+     */
+    AccessStrategy GetAccessStrategy(const AccessType type, size_t ring_size = 0) {
+        if (ring_size == 0) {
+            ring_size = type == AccessType::BULK_WRITE ? BULK_WRITE_RING_SIZE : SEQUENTIAL_SCAN_RING_SIZE;
+        }
+        ring_size = std::max<size_t>(1, std::min(ring_size, pool_size_.load() / 8));
+        return AccessStrategy(this, type, ring_size);
+    }
 
     /**
      *  @brief Create a new page with page_id in the buffer pool.
-     *  
-     *  Remember to "Unpin" the page by calling bpm.UnpinPage() when the page not used, 
+     *
+     *  Remember to "Unpin" the page by calling bpm.UnpinPage() when the page not used,
      *  so that lru_replacer wouldn't evict the page before the buffer pool manager "Unpin"s it.
-     * 
+     *
+     *  @param strategy if not nullptr, the page is created in a frame of its ring
      *  @return new alloc page pointer, if buffer pool is full, nullptr is returned.
      */
-    disk::Page<page_size> *NewPage() {
-        page_id_t new_page_id = AllocatePageID();
+    disk::Page<page_size> *NewPage(AccessStrategy *strategy = nullptr) {
         frame_id_t frame_id;
-        auto r = GetFreePage(&frame_id);
+        auto r = GetFreePage(&frame_id, strategy); // replacer_.Victim() has Pin this page.
         if (!r) return nullptr;
-        auto page = &pages_[frame_id];
-        page->SetPageId(new_page_id);
-        page->SetDirty(true);
-        pages_map_[new_page_id] = frame_id;
-        return page;
+        return MapNewPage(frame_id, AllocatePageID());
     }
 
     /**
-     *  @brief  Fetch the requested page from the buffer pool. 
-     *  
+     *  @brief  Fetch the requested page from the buffer pool.
+     *
      *  Return nullptr if page_id needs to be fetched from the disk
      *  but all frames are currently in use and not evictable (in another word, pinned).
-     * 
-     *  Remember to "Unpin" the page by calling bpm.UnpinPage() when the page not used, 
+     *
+     *  Remember to "Unpin" the page by calling bpm.UnpinPage() when the page not used,
      *  so that lru_replacer wouldn't evict the page before the buffer pool manager "Unpin"s it.
-     *  
+     *
      *  @param page_id id of page to be fetched
+     *  @param strategy if not nullptr, a missing page is loaded into a frame of its ring,
+     *         and a resident page keeps its place in the replacer order
      *  @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
      */
-    disk::Page<page_size> *FetchPage(const page_id_t page_id) {
+    disk::Page<page_size> *FetchPage(const page_id_t page_id, AccessStrategy *strategy = nullptr) {
         frame_id_t frame_id;
-        auto it = pages_map_.find(page_id);
-        if (it != pages_map_.end()) {
-            frame_id = it->second;
-            replacer_->Pin(frame_id);
+        bool update_replacer = strategy == nullptr || !strategy->UseRing();
+        auto &shard = page_table_.GetShard(page_id);
+        RLockTimed(shard.latch_);
+        if (shard.Find(page_id, &frame_id)) {
+            PinFrame(frame_id, update_replacer);
+            shard.latch_.RUnlock();
+            stat_counters_.Add(STAT_HIT);
+            auto &frame = frames_[frame_id];
+            WaitForLoad(frame);
+            // the page marks the middle of a read-ahead window, load the next window
+            auto &read_ahead_next = frame.read_ahead_next_;
+            if (read_ahead_next.load() != INVALID_PAGE_ID) {
+                auto next_page_id = read_ahead_next.exchange(INVALID_PAGE_ID);
+                if (next_page_id != INVALID_PAGE_ID) ReadAhead(next_page_id, strategy);
+            }
             return &pages_[frame_id];
-        } else {
-            auto r = GetFreePage(&frame_id); // replacer_.Victim() has Pin this page.
-            if (!r) return nullptr;
-            auto page = &pages_[frame_id];
-            disk_manager_->ReadPage(page_id, (char *)page);
-            page->SetDirty(false);
-            pages_map_[page_id] = frame_id;
-            return page;
         }
+        shard.latch_.RUnlock();
+
+        auto r = GetFreePage(&frame_id, strategy); // replacer_.Victim() has Pin this page.
+        if (!r) return nullptr;
+        WLockTimed(shard.latch_);
+        frame_id_t resident_frame_id;
+        if (shard.Find(page_id, &resident_frame_id)) {
+            // another thread loaded the page while we were looking for a frame
+            PinFrame(resident_frame_id, update_replacer);
+            shard.latch_.WUnlock();
+            UnpinFrame(frame_id);
+            stat_counters_.Add(STAT_HIT);
+            WaitForLoad(frames_[resident_frame_id]);
+            return &pages_[resident_frame_id];
+        }
+        // mapped before the read as LoadPages does, users of the page wait for the read while
+        // the rest of the shard stays available
+        auto page = &pages_[frame_id];
+        auto &frame = frames_[frame_id];
+        frame.is_dirty_ = false;
+        frame.is_loading_ = true;
+        shard.Insert(page_id, frame_id);
+        shard.latch_.WUnlock();
+        frame.latch_.BeginChange();
+        auto read_start = NowNanos();
+        disk_manager_->ReadPage(page_id, (char *)page);
+        read_latency_.RecordSince(read_start);
+        frame.latch_.EndChange();
+        stat_counters_.Add(STAT_MISS);
+        AdmitFrame(frame_id, page_id);
+        frame.is_loading_.store(false);
+        // a scan has its own history of misses, others share the one of the pool
+        auto last_miss_page_id = strategy != nullptr ? std::exchange(strategy->last_miss_page_id_, page_id)
+                                                     : last_miss_page_id_.exchange(page_id);
+        if (last_miss_page_id != INVALID_PAGE_ID && last_miss_page_id + 1 == page_id) ReadAhead(page_id + 1, strategy);
+        return page;
+    }
+
+    /**
+     *  @brief Fetch the page of swip, and swizzle swip to its frame, see Swip.
+     *
+     *  A swizzled swip leads to the frame without a page table lookup, the page is pinned
+     *  there unless an eviction is taking it away.
+     *
+     *  @return nullptr if the page cannot be fetched
+     */
+    disk::Page<page_size> *FetchPage(Swip &swip, AccessStrategy *strategy = nullptr) {
+        static_assert(page_size % 2 == 0, "swips tag pointers to frames with their lowest bit");
+        bool update_replacer = strategy == nullptr || !strategy->UseRing();
+        while (true) {
+            auto word = swip.word_.load();
+            if (!Swip::IsPointer(word)) {
+                auto page_id = Swip::DecodePageId(word);
+                auto page = FetchPage(page_id, strategy);
+                if (page != nullptr) Swizzle(swip, page_id, page - pages_);
+                return page;
+            }
+            frame_id_t frame_id = (disk::Page<page_size> *)Swip::DecodePointer(word) - pages_;
+            PinFrame(frame_id, update_replacer);
+            // evictions unswizzle the swip before they check the pin count, a swip unchanged
+            // once pinned means that no eviction will take the page away
+            if (swip.word_.load() == word) {
+                stat_counters_.Add(STAT_HIT);
+                return &pages_[frame_id];
+            }
+            UnpinFrame(frame_id);
+        }
+    }
+
+    /**
+     *  @brief Turn swip back into a page id if this pool swizzled it, before it is destroyed.
+     */
+    void Unswizzle(Swip &swip) {
+        if (!swip.IsSwizzled()) return;
+        auto page_id = swip.GetPageId();
+        auto &shard = page_table_.GetShard(page_id);
+        frame_id_t frame_id;
+        WLockTimed(shard.latch_);
+        if (shard.Find(page_id, &frame_id) && frames_[frame_id].swip_.load() == &swip) {
+            UnswizzleFrame(frame_id, page_id);
+        }
+        shard.latch_.WUnlock();
     }
 
     /**
-     *  @brief Unpin the target page from the buffer pool. 
-     *  
+     *  @brief Start loading pages [first_page_id, first_page_id + page_num) in the background.
+     *
+     *  Each page neither resident, deleted nor past the end of the file is read asynchronously
+     *  into a frame found as by FetchPage, and joins the pool unpinned once read. FetchPage waits
+     *  for a page still being read.
+     *
+     *  @param strategy if not nullptr, pages are loaded into frames of its ring
+     */
+    void Prefetch(const page_id_t first_page_id, const size_t page_num, AccessStrategy *strategy = nullptr) {
+        LoadPages(first_page_id, page_num, strategy, false);
+    }
+
+    /**
+     *  @brief Fetch a page latched in shared mode, it is unpinned when the guard is dropped.
+     *  @return an empty guard if page_id cannot be fetched
+     */
+    ReadPageGuard<BufferPoolManager> FetchPageRead(const page_id_t page_id, AccessStrategy *strategy = nullptr) {
+        auto page = FetchPage(page_id, strategy);
+        if (page == nullptr) return ReadPageGuard<BufferPoolManager>();
+        frame_id_t frame_id = page - pages_;
+        return ReadPageGuard<BufferPoolManager>(this, page, frame_id, &frames_[frame_id]);
+    }
+
+    /**
+     *  @brief Fetch a page latched in exclusive mode, it is unpinned when the guard is dropped.
+     *  @return an empty guard if page_id cannot be fetched
+     */
+    WritePageGuard<BufferPoolManager> FetchPageWrite(const page_id_t page_id, AccessStrategy *strategy = nullptr) {
+        auto page = FetchPage(page_id, strategy);
+        if (page == nullptr) return WritePageGuard<BufferPoolManager>();
+        frame_id_t frame_id = page - pages_;
+        return WritePageGuard<BufferPoolManager>(this, page, frame_id, &frames_[frame_id]);
+    }
+
+    /**
+     *  @brief Fetch the page of swip latched in shared mode, swizzling swip, see Swip.
+     *  @return an empty guard if the page cannot be fetched
+     */
+    ReadPageGuard<BufferPoolManager> FetchPageRead(Swip &swip, AccessStrategy *strategy = nullptr) {
+        auto page = FetchPage(swip, strategy);
+        if (page == nullptr) return ReadPageGuard<BufferPoolManager>();
+        frame_id_t frame_id = page - pages_;
+        return ReadPageGuard<BufferPoolManager>(this, page, frame_id, &frames_[frame_id]);
+    }
+
+    /**
+     *  @brief Fetch the page of swip latched in exclusive mode, swizzling swip, see Swip.
+     *  @return an empty guard if the page cannot be fetched
+     */
+    WritePageGuard<BufferPoolManager> FetchPageWrite(Swip &swip, AccessStrategy *strategy = nullptr) {
+        auto page = FetchPage(swip, strategy);
+        if (page == nullptr) return WritePageGuard<BufferPoolManager>();
+        frame_id_t frame_id = page - pages_;
+        return WritePageGuard<BufferPoolManager>(this, page, frame_id, &frames_[frame_id]);
+    }
+
+    /**
+     *  @brief Fetch a page for optimistic reads, see OptimisticReadGuard. The page is pinned
+     *         only while the guard is made, reads through the guard neither pin nor latch it.
+     *  @return an empty guard if page_id cannot be fetched
+     */
+    OptimisticReadGuard<BufferPoolManager> FetchPageOptimistic(const page_id_t page_id,
+                                                               AccessStrategy *strategy = nullptr) {
+        auto page = FetchPage(page_id, strategy);
+        if (page == nullptr) return OptimisticReadGuard<BufferPoolManager>();
+        frame_id_t frame_id = page - pages_;
+        auto &frame = frames_[frame_id];
+        // a writer holding the latch is waited for, so that the version is even
+        frame.latch_.RLock();
+        auto version = frame.latch_.GetVersion();
+        auto epoch = frame.epoch_.load();
+        frame.latch_.RUnlock();
+        UnpinFrame(frame_id);
+        return OptimisticReadGuard<BufferPoolManager>(page, &frame, page_id, version, epoch);
+    }
+
+    /**
+     *  @brief Create a new page latched in exclusive mode, it is unpinned when the guard is dropped.
+     *  @return an empty guard if buffer pool is full
+     */
+    WritePageGuard<BufferPoolManager> NewPageGuarded(AccessStrategy *strategy = nullptr) {
+        auto page = NewPage(strategy);
+        if (page == nullptr) return WritePageGuard<BufferPoolManager>();
+        frame_id_t frame_id = page - pages_;
+        return WritePageGuard<BufferPoolManager>(this, page, frame_id, &frames_[frame_id]);
+    }
+
+    /**
+     *  @brief Unpin the target page from the buffer pool.
+     *
      *  If page_id is not in the buffer pool, return false.
      *  If its pin count is already 0, nothing happen, return true.
      *  Otherwise, decrement the pin count of a page.
      */
     bool UnpinPage(page_id_t page_id, bool is_dirty) {
-        auto it = pages_map_.find(page_id);
-        if (it == pages_map_.end()) return false;
-        auto page = &pages_[it->second];
-        if (is_dirty) page->SetDirty(is_dirty);
-        replacer_->Unpin(it->second);
+        frame_id_t frame_id;
+        auto &shard = page_table_.GetShard(page_id);
+        RLockTimed(shard.latch_);
+        if (!shard.Find(page_id, &frame_id)) {
+            shard.latch_.RUnlock();
+            return false;
+        }
+        if (is_dirty) frames_[frame_id].is_dirty_ = true;
+        UnpinFrame(frame_id);
+        shard.latch_.RUnlock();
+        return true;
+    }
+
+    /**
+     *  @brief Delete a page, its id is given back to the disk manager for NewPage to reuse.
+     *
+     *  A resident page is dropped from the pool without being written, and its frame joins the
+     *  free frames of the replacer, reused before any frame holding a page. The page must not be
+     *  fetched again unless NewPage hands out its id.
+     *
+     *  @return false if the page is pinned, also when only by the ring of an access strategy,
+     *          or still being read by Prefetch
+     */
+    bool DeletePage(const page_id_t page_id) {
+        if (page_id < 0) return false;
+        frame_id_t frame_id;
+        auto &shard = page_table_.GetShard(page_id);
+        WLockTimed(shard.latch_);
+        if (shard.Find(page_id, &frame_id)) {
+            auto &frame = frames_[frame_id];
+            UnswizzleFrame(frame_id, page_id);
+            {
+                // a victim is pinned under the replacer latch, so a pin count of 0 seen here
+                // means nobody has the frame
+                std::lock_guard<std::mutex> guard(replacer_latch_);
+                if (frame.pin_count_.load() != 0) {
+                    shard.latch_.WUnlock();
+                    return false;
+                }
+                replacer_->Pin(frame_id);
+                frame.pin_count_.store(1);
+            }
+            shard.Erase(page_id);
+            frame.is_dirty_ = false;
+            frame.rec_lsn_ = INVALID_LSN;
+            frame.latch_.BeginChange();
+            frame.epoch_.fetch_add(1);
+            pages_[frame_id].ResetMemory();
+            pages_[frame_id].SetPageId(INVALID_PAGE_ID);
+            frame.latch_.EndChange();
+            frame.read_ahead_next_ = INVALID_PAGE_ID;
+            FreeFrame(frame_id);
+        }
+        shard.latch_.WUnlock();
+        disk_manager_->DeallocatePage(page_id);
         return true;
     }
 
     /**
-     *  @brief Flush all pages in buffer pool into disk. 
+     *  @brief Flush all pages in buffer pool into disk.
+     *
+     *  Pages are latched in shared mode while written, concurrent writers of a page
+     *  holding its latch are waited for.
      */
     void FlushAllData() {
-        for (auto kv : pages_map_) {
-            auto page_id = kv.first;
-            auto frame_id = kv.second;
-            auto page = &pages_[frame_id];
-            if (page->IsDirty()) {
-                disk_manager_->WritePage(page_id, page->GetData());
-                page->SetDirty(false);
+        std::vector<std::pair<page_id_t, frame_id_t>> entries;
+        for (size_t i = 0; i < page_table_.GetShardNum(); ++i) {
+            auto &shard = page_table_.GetShardAt(i);
+            RLockTimed(shard.latch_);
+            shard.Collect(&entries);
+            shard.latch_.RUnlock();
+        }
+        // in page id order, so that neighbouring pages go out in one vectored write
+        std::sort(entries.begin(), entries.end());
+        std::vector<std::pair<page_id_t, frame_id_t>> batch;
+        for (size_t start = 0; start < entries.size(); start += FLUSH_BATCH_PAGE_NUM) {
+            batch.clear();
+            for (size_t i = start; i < std::min(entries.size(), start + FLUSH_BATCH_PAGE_NUM); ++i) {
+                auto page_id = entries[i].first;
+                auto frame_id = entries[i].second;
+                // keep the frame from being evicted without moving it in the replacer order
+                auto &shard = page_table_.GetShard(page_id);
+                frame_id_t resident_frame_id;
+                RLockTimed(shard.latch_);
+                if (shard.Find(page_id, &resident_frame_id) && resident_frame_id == frame_id) {
+                    PinFrame(frame_id, false);
+                    batch.push_back(entries[i]);
+                }
+                shard.latch_.RUnlock();
             }
+            stat_counters_.Add(STAT_FLUSH_WRITE, WritePinnedFrames(batch));
+        }
+    }
+
+    /**
+     *  @brief Returns the recLSN of each resident page changed by a logged change since it was
+     *         last written, the dirty page table of a fuzzy checkpoint.
+     *
+     *  Pages are not written, only frames pinned or with a recLSN are latched in shared mode
+     *  one at a time, waiting for a writer that has logged a change but not set its LSN yet.
+     */
+    std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTable() {
+        std::vector<std::pair<page_id_t, frame_id_t>> entries;
+        for (size_t i = 0; i < page_table_.GetShardNum(); ++i) {
+            auto &shard = page_table_.GetShardAt(i);
+            RLockTimed(shard.latch_);
+            shard.Collect(&entries);
+            shard.latch_.RUnlock();
+        }
+        std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+        for (auto &entry : entries) {
+            auto page_id = entry.first;
+            auto frame_id = entry.second;
+            auto &frame = frames_[frame_id];
+            // unpinned and without recLSN, nobody is changing the page
+            if (frame.pin_count_.load() == 0 && frame.rec_lsn_.load() == INVALID_LSN) continue;
+            auto &shard = page_table_.GetShard(page_id);
+            frame_id_t resident_frame_id;
+            RLockTimed(shard.latch_);
+            bool is_resident = shard.Find(page_id, &resident_frame_id) && resident_frame_id == frame_id;
+            if (is_resident) PinFrame(frame_id, false);
+            shard.latch_.RUnlock();
+            if (!is_resident) continue;
+            frame.latch_.RLock();
+            lsn_t rec_lsn = frame.rec_lsn_.load();
+            frame.latch_.RUnlock();
+            UnpinFrame(frame_id);
+            if (rec_lsn != INVALID_LSN) dirty_pages.emplace_back(page_id, rec_lsn);
         }
+        return dirty_pages;
     }
 
+    /**
+     *  @brief Make the pages written so far durable on disk.
+     *
+     *  A page is no longer dirty once written, a checkpoint syncs before its redo point moves
+     *  past the changes of such pages.
+     */
+    void SyncData() { disk_manager_->Sync(); }
+
+    /**
+     *  @brief Have the background writer write pages, a round at a time, in the given order.
+     *
+     *  Pages no longer dirty or resident are skipped. Without background writer nothing is
+     *  written, pages are then written when evicted or flushed.
+     */
+    void DrainDirtyPages(const std::vector<page_id_t> &page_ids) {
+        if (!writer_.joinable()) return;
+        std::lock_guard<std::mutex> guard(writer_latch_);
+        drain_pages_.insert(drain_pages_.end(), page_ids.begin(), page_ids.end());
+    }
+
+    /**
+     *  @brief The number of pages DrainDirtyPages asked for that the writer has not reached.
+     */
+    size_t GetDrainPageNum() {
+        std::lock_guard<std::mutex> guard(writer_latch_);
+        return drain_pages_.size();
+    }
+
+    /**
+     *  @brief The number of dirty pages evictions had to write back themselves.
+     */
+    size_t GetEvictionWriteNum() const { return stat_counters_.Get(STAT_EVICTION_WRITE); }
+
+    /**
+     *  @brief The number of pages the background writer has written.
+     */
+    size_t GetWriterWriteNum() const { return stat_counters_.Get(STAT_WRITER_WRITE); }
+
+    /**
+     *  @brief Returns the memory held for the frames, and how much of it is on huge pages.
+     */
+    BufferPoolMemoryStats GetMemoryStats() const {
+        BufferPoolMemoryStats stats;
+        stats.frame_num_ = pool_size_.load();
+        stats.max_frame_num_ = max_pool_size_;
+        stats.frame_bytes_ = arena_.GetReservedSize();
+        stats.frame_header_bytes_ = max_pool_size_ * sizeof(FrameHeader);
+        stats.huge_page_mode_ = arena_.GetHugePageMode();
+        stats.huge_page_bytes_ = arena_.GetHugePageSize();
+        stats.numa_node_ = arena_.GetNumaNode();
+        return stats;
+    }
+
+    /**
+     *  @brief Returns the activity of the pool so far, and the state of its frames.
+     *
+     *  Counters are summed over the threads and frames are looked at one by one without
+     *  stopping the pool, under concurrent use the result is close to, not exactly, a point in
+     *  time.
+     */
+    BufferPoolStats GetStats() {
+        BufferPoolStats stats;
+        stats.hit_num_ = stat_counters_.Get(STAT_HIT);
+        stats.miss_num_ = stat_counters_.Get(STAT_MISS);
+        stats.new_page_num_ = stat_counters_.Get(STAT_NEW_PAGE);
+        stats.prefetch_num_ = stat_counters_.Get(STAT_PREFETCH);
+        stats.eviction_num_ = stat_counters_.Get(STAT_EVICTION);
+        stats.eviction_write_num_ = stat_counters_.Get(STAT_EVICTION_WRITE);
+        stats.writer_write_num_ = stat_counters_.Get(STAT_WRITER_WRITE);
+        stats.flush_write_num_ = stat_counters_.Get(STAT_FLUSH_WRITE);
+        stats.frame_wait_num_ = stat_counters_.Get(STAT_FRAME_WAIT);
+        stats.frame_wait_nanos_ = stat_counters_.Get(STAT_FRAME_WAIT_NANOS);
+        stats.frame_num_ = pool_size_.load();
+        for (size_t i = 0; i < page_table_.GetShardNum(); ++i) {
+            auto &shard = page_table_.GetShardAt(i);
+            RLockTimed(shard.latch_);
+            stats.resident_frame_num_ += shard.Size();
+            shard.latch_.RUnlock();
+        }
+        for (size_t i = 0; i < stats.frame_num_; ++i) {
+            auto pin_count = frames_[i].pin_count_.load();
+            if (pin_count > 0) ++stats.pinned_frame_num_;
+            stats.pin_num_ += std::max(pin_count, 0);
+            if (frames_[i].is_dirty_.load()) ++stats.dirty_frame_num_;
+        }
+        stats.read_latency_ = read_latency_.GetSnapshot();
+        stats.write_latency_ = write_latency_.GetSnapshot();
+        return stats;
+    }
+
+    /**
+     *  @brief Returns the latch protecting the content of page, which must be pinned.
+     */
+    OptimisticLatch &GetPageLatch(disk::Page<page_size> *page) { return frames_[page - pages_].latch_; }
+
 private:
-    // buffer pool size
-    size_t pool_size_;
+    // buffer pool size, frames 0 .. pool_size_ - 1 are in use
+    std::atomic<size_t> pool_size_;
+    // frames the pool has address space and bookkeeping for, the others are pinned
+    const size_t max_pool_size_;
+    // serializes Resize
+    std::mutex resize_latch_;
+    // memory of pages_, aligned for direct I/O
+    FrameArena arena_;
     // Array of buffer pool pages
     disk::Page<page_size>* pages_;
-    // lru_pilicy
-    LRUReplacer* replacer_;
+    // Bookkeeping of each frame in pages_
+    FrameHeader *frames_;
+    // replacement policy
+    Replacer* replacer_;
+    // protects replacer_, and pin counts changing to or from 0
+    std::mutex replacer_latch_;
     // disk manager response for read-write pages from disk
-    DiskManager *disk_manager_;
-    // next alloc page id
-    page_id_t next_page_id_;
+    Disk *disk_manager_;
     // map for page_id and frame_id
-    std::unordered_map<page_id_t, frame_id_t> pages_map_;
+    PageTable page_table_;
+    BufferPoolOptions options_;
+    // background writer, woken up through writer_cv_ to run a round early or to stop
+    std::thread writer_;
+    std::mutex writer_latch_;
+    std::condition_variable writer_cv_;
+    bool writer_wakeup_ = false;
+    bool writer_stop_ = false;
+    // pages to write for checkpoints, protected by writer_latch_
+    std::deque<page_id_t> drain_pages_;
+    // counters of GetStats, see BufferPoolStats
+    enum StatCounter : size_t {
+        STAT_HIT, STAT_MISS, STAT_NEW_PAGE, STAT_PREFETCH, STAT_EVICTION, STAT_EVICTION_WRITE, STAT_WRITER_WRITE,
+        STAT_FLUSH_WRITE, STAT_FRAME_WAIT, STAT_FRAME_WAIT_NANOS, STAT_COUNTER_NUM
+    };
+    StripedCounters<STAT_COUNTER_NUM> stat_counters_;
+    LatencyHistogram read_latency_;
+    LatencyHistogram write_latency_;
+    // last page FetchPage missed without a strategy, to detect sequential access
+    std::atomic<page_id_t> last_miss_page_id_{INVALID_PAGE_ID};
+    // pages being read by Prefetch
+    std::atomic<size_t> prefetch_num_{0};
 
     /**
-     *  @brief Allocate a page on disk.
+     *  @brief Allocate a page on disk, a deleted page is reused first.
      */
-    page_id_t AllocatePageID() { return next_page_id_++; }
+    page_id_t AllocatePageID() { return disk_manager_->AllocatePage(); }
+
+    /**
+     *  @brief Map new_page_id, just allocated, into frame_id, pinned by GetFreePage.
+     */
+    disk::Page<page_size> *MapNewPage(const frame_id_t frame_id, const page_id_t new_page_id) {
+        auto page = &pages_[frame_id];
+        frames_[frame_id].latch_.BeginChange();
+        page->SetPageId(new_page_id);
+        frames_[frame_id].latch_.EndChange();
+        frames_[frame_id].is_dirty_ = true;
+        auto &shard = page_table_.GetShard(new_page_id);
+        WLockTimed(shard.latch_);
+        shard.Insert(new_page_id, frame_id);
+        shard.latch_.WUnlock();
+        AdmitFrame(frame_id, new_page_id);
+        stat_counters_.Add(STAT_NEW_PAGE);
+        return page;
+    }
+
+    /**
+     *  @brief Swizzle swip to frame_id, pinned and holding page_id, unless the frame has a swip
+     *         already or the swip changed meanwhile.
+     */
+    void Swizzle(Swip &swip, const page_id_t page_id, const frame_id_t frame_id) {
+        auto &frame = frames_[frame_id];
+        if (frame.swip_.load() != nullptr) return;
+        auto &shard = page_table_.GetShard(page_id);
+        RLockTimed(shard.latch_);
+        frame_id_t resident_frame_id;
+        Swip *no_swip = nullptr;
+        if (shard.Find(page_id, &resident_frame_id) && resident_frame_id == frame_id
+            && frame.swip_.compare_exchange_strong(no_swip, &swip)) {
+            auto word = Swip::EncodePageId(page_id);
+            if (!swip.word_.compare_exchange_strong(word, Swip::EncodePointer((char *)&pages_[frame_id]))) {
+                frame.swip_ = nullptr;
+            }
+        }
+        shard.latch_.RUnlock();
+    }
+
+    /**
+     *  @brief Turn the swip swizzled to frame_id, if any, back into page_id. The shard of page_id
+     *         must be latched in write mode, or the pool be going away.
+     */
+    void UnswizzleFrame(const frame_id_t frame_id, const page_id_t page_id) {
+        auto swip = frames_[frame_id].swip_.exchange(nullptr);
+        if (swip != nullptr) swip->word_.store(Swip::EncodePageId(page_id));
+    }
+
+    /**
+     *  @brief Make the log durable up to lsn, before writing a page of that LSN.
+     */
+    void FlushLog(const lsn_t lsn) {
+        if (options_.log_manager_ != nullptr) options_.log_manager_->Flush(lsn);
+    }
+
+    /**
+     *  @brief Increment the pin count of a frame.
+     *
+     *  The frame must not be under eviction, i.e. the caller holds the latch of the shard
+     *  mapping it. Only a pin count changing from 0 tells the replacer, other pins are
+     *  counted in access_num_ of the frame and told by UnpinFrame, so that pages kept pinned
+     *  by concurrent users still build up an access history.
+     *
+     *  @param update_replacer false to pin without touching the replacer order, the frame may
+     *         then still be chosen as victim, which GetFreePage rejects as the frame is pinned.
+     */
+    void PinFrame(const frame_id_t frame_id, const bool update_replacer = true) {
+        auto &frame = frames_[frame_id];
+        auto &pin_count = frame.pin_count_;
+        int32_t old_count = pin_count.load();
+        while (old_count > 0 || !update_replacer) {
+            if (pin_count.compare_exchange_weak(old_count, old_count + 1)) {
+                if (update_replacer) frame.access_num_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        std::lock_guard<std::mutex> guard(replacer_latch_);
+        if (pin_count.fetch_add(1) == 0) {
+            replacer_->Pin(frame_id);
+        } else {
+            frame.access_num_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     *  @brief Wait for the read of a page that Prefetch is loading into a frame the caller pinned.
+     */
+    void WaitForLoad(FrameHeader &frame) {
+        if (!frame.is_loading_.load()) return;
+        auto start = NowNanos();
+        while (frame.is_loading_.load()) std::this_thread::yield();
+        RecordFrameWait(start);
+    }
+
+    void RecordFrameWait(const uint64_t start) {
+        stat_counters_.Add(STAT_FRAME_WAIT);
+        stat_counters_.Add(STAT_FRAME_WAIT_NANOS, NowNanos() - start);
+    }
+
+    /**
+     *  @brief Latch in shared mode, a wait for the latch is recorded as a frame wait.
+     */
+    template<typename Latch>
+    void RLockTimed(Latch &latch) {
+        if (latch.TryRLock()) return;
+        auto start = NowNanos();
+        latch.RLock();
+        RecordFrameWait(start);
+    }
+
+    /**
+     *  @brief Latch in exclusive mode, a wait for the latch is recorded as a frame wait.
+     */
+    template<typename Latch>
+    void WLockTimed(Latch &latch) {
+        if (latch.TryWLock()) return;
+        auto start = NowNanos();
+        latch.WLock();
+        RecordFrameWait(start);
+    }
+
+    /**
+     *  @brief Tell the replacer which page a victimized frame now holds.
+     */
+    void AdmitFrame(const frame_id_t frame_id, const page_id_t page_id) {
+        std::lock_guard<std::mutex> guard(replacer_latch_);
+        replacer_->Admit(frame_id, page_id);
+    }
+
+    /**
+     *  @brief Decrement the pin count of a frame, nothing happens if it is already 0.
+     *
+     *  The last unpin hands the accesses counted by PinFrame to the replacer first.
+     */
+    void UnpinFrame(const frame_id_t frame_id) {
+        auto &frame = frames_[frame_id];
+        auto &pin_count = frame.pin_count_;
+        int32_t old_count = pin_count.load();
+        while (old_count > 1) {
+            if (pin_count.compare_exchange_weak(old_count, old_count - 1)) return;
+        }
+        std::lock_guard<std::mutex> guard(replacer_latch_);
+        if (pin_count.load() == 0) return;
+        if (pin_count.fetch_sub(1) == 1) {
+            auto access_num = frame.access_num_.exchange(0);
+            if (access_num != 0) replacer_->RecordAccess(frame_id, access_num);
+            replacer_->Unpin(frame_id);
+        }
+    }
+
+    /**
+     *  @brief Drop the pin of the caller on a frame that holds no page, the frame becomes free.
+     *
+     *  A fetch through a stale swip may have pinned the frame meanwhile, it then unpins it as
+     *  usual once it sees the swip changed.
+     */
+    void FreeFrame(const frame_id_t frame_id) {
+        std::lock_guard<std::mutex> guard(replacer_latch_);
+        if (frames_[frame_id].pin_count_.fetch_sub(1) == 1) {
+            frames_[frame_id].access_num_ = 0;
+            replacer_->Free(frame_id);
+        }
+    }
 
     /**
      *  @brief Get free page.
-     * 
-     *  If free_list_ not empty, return a free page frame_id, 
+     *
+     *  If free_list_ not empty, return a free page frame_id,
      *  else evict least recent unused page, return it's frame_id.
-     * 
-     *  If there is no free page, return false and set frame_id nullptr.
-     * 
+     *  The returned frame is pinned once, and no longer in the page table.
+     *
+     *  If there is no free page, return false.
+     *
      *  @param[out] frame_id the frame id of free page
+     *  @param strategy if not nullptr, the frame is taken from its ring
      */
-    bool GetFreePage(frame_id_t *frame_id) {
-        auto r = replacer_->Victim(frame_id);
-        if (!r) {
-            frame_id = nullptr;
-            return false;
+    bool GetFreePage(frame_id_t *frame_id, AccessStrategy *strategy = nullptr) {
+        if (strategy != nullptr && strategy->UseRing()) return GetRingFrame(frame_id, strategy);
+        // when waiting for frames pinned by prefetches
+        uint64_t wait_start = 0;
+        while (true) {
+            bool found;
+            {
+                std::lock_guard<std::mutex> guard(replacer_latch_);
+                found = replacer_->Victim(frame_id);
+                if (found) frames_[*frame_id].pin_count_.fetch_add(1);
+            }
+            if (!found) {
+                // frames pinned by Prefetch are given back as soon as their page is read
+                if (prefetch_num_.load() == 0) {
+                    if (wait_start != 0) RecordFrameWait(wait_start);
+                    return false;
+                }
+                if (wait_start == 0) wait_start = NowNanos();
+                std::this_thread::yield();
+                continue;
+            }
+            if (wait_start != 0) {
+                RecordFrameWait(wait_start);
+                wait_start = 0;
+            }
+            if (EvictPage(*frame_id)) return true;
+            // pinned through the page table or changed after it became a victim, it goes
+            // back to the replacer once its last user unpins it.
+            UnpinFrame(*frame_id);
+        }
+    }
+
+    /**
+     *  @brief Get the frame of the next slot of the ring of strategy.
+     *
+     *  The page loaded there a lap before is evicted, unless somebody else has it pinned,
+     *  then the frame is left to the pool and a new one joins the ring through the replacer.
+     *  The returned frame is pinned once for the caller, besides the pin of the ring.
+     */
+    bool GetRingFrame(frame_id_t *frame_id, AccessStrategy *strategy) {
+        auto &slot = strategy->NextSlot();
+        if (slot != -1) {
+            // more than the pin of the ring, the frame may still be loading for Prefetch
+            if (frames_[slot].pin_count_.load() == 1 && EvictPage(slot)) {
+                frames_[slot].pin_count_.fetch_add(1);
+                *frame_id = slot;
+                return true;
+            }
+            UnpinFrame(slot);
+            slot = -1;
         }
-        auto page = &pages_[*frame_id];
-        if (page->IsDirty()) {
-            disk_manager_->WritePage(page->GetPageId(), page->GetData());
+        if (!GetFreePage(frame_id)) return false;
+        frames_[*frame_id].pin_count_.fetch_add(1);
+        slot = *frame_id;
+        return true;
+    }
+
+    /**
+     *  @brief Write back and unmap the page held by a frame whose only pin is the caller's.
+     *
+     *  A dirty page is written before the shard is latched, under the frame latch in shared
+     *  mode, so that lookups in the shard don't wait for the write. The page may be pinned or
+     *  changed meanwhile, both are checked again under the shard latch.
+     *
+     *  @return false if the page got pinned through the page table or changed meanwhile
+     */
+    bool EvictPage(const frame_id_t frame_id) {
+        auto &frame = frames_[frame_id];
+        auto page = &pages_[frame_id];
+        auto page_id = page->GetPageId();
+        if (page_id == INVALID_PAGE_ID) return true;
+
+        if (frame.is_dirty_.load()) {
+            // a holder of the latch pinned the page after the replacer gave it up, waiting for it
+            // would deadlock with one that waits for a latch of the caller
+            if (frame.pin_count_.load() != 1 || !frame.latch_.TryRLock()) return false;
+            if (frame.is_dirty_.exchange(false)) {
+                FlushLog(page->GetLSN());
+                auto write_start = NowNanos();
+                disk_manager_->WritePage(page_id, page->GetData());
+                write_latency_.RecordSince(write_start);
+                // still latched, a change made afterwards sets a new recLSN
+                frame.rec_lsn_ = INVALID_LSN;
+                stat_counters_.Add(STAT_EVICTION_WRITE);
+                WakeUpWriter();
+            }
+            frame.latch_.RUnlock();
         }
-        auto it = pages_map_.find(page->GetPageId());
-        if (it != pages_map_.end()) {
-            pages_map_.erase(it);
+
+        auto &shard = page_table_.GetShard(page_id);
+        WLockTimed(shard.latch_);
+        // before the pin count is checked, see FetchPage(Swip &)
+        UnswizzleFrame(frame_id, page_id);
+        if (frame.pin_count_.load() != 1 || frame.is_dirty_.load()) {
+            shard.latch_.WUnlock();
+            return false;
         }
+        frame.rec_lsn_ = INVALID_LSN;
+        // accesses of a ring or of users pinning it with the ring, the next page starts over
+        frame.access_num_ = 0;
+        shard.Erase(page_id);
+        shard.latch_.WUnlock();
+        frame.latch_.BeginChange();
+        frame.epoch_.fetch_add(1);
         page->ResetMemory();
+        page->SetPageId(INVALID_PAGE_ID);
+        frame.latch_.EndChange();
+        frame.read_ahead_next_ = INVALID_PAGE_ID;
+        stat_counters_.Add(STAT_EVICTION);
         return true;
     }
+
+    /**
+     *  @brief An eviction had to write a page, the writer is behind, let it catch up now.
+     */
+    void WakeUpWriter() {
+        if (!writer_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> guard(writer_latch_);
+            writer_wakeup_ = true;
+        }
+        writer_cv_.notify_one();
+    }
+
+    /**
+     *  @brief Take an unpinned frame out of the pool for a shrink, evicting its page. The frame
+     *         stays pinned once, so that the replacer never hands it out.
+     *  @return false if the frame is pinned
+     */
+    bool RetireFrame(const frame_id_t frame_id) {
+        auto &frame = frames_[frame_id];
+        {
+            // pinned as a victim is, see GetFreePage
+            std::lock_guard<std::mutex> guard(replacer_latch_);
+            if (frame.pin_count_.load() != 0) return false;
+            replacer_->Pin(frame_id);
+            frame.pin_count_.fetch_add(1);
+        }
+        if (EvictPage(frame_id)) return true;
+        UnpinFrame(frame_id);
+        return false;
+    }
+
+    /**
+     *  @brief Load the read-ahead window starting at first_page_id.
+     *
+     *  The window is read_ahead_page_num_ pages, at most half the ring of a scan or a quarter
+     *  of the pool, and its middle page is marked to load the next window when fetched.
+     *
+     *  With read_ahead_extent_page_num_, the window stops at the end of the extent of the page
+     *  before it, the page that started the read-ahead, and the last window of the extent marks
+     *  no page.
+     */
+    void ReadAhead(const page_id_t first_page_id, AccessStrategy *strategy) {
+        size_t page_num = std::min(options_.read_ahead_page_num_, strategy != nullptr && strategy->UseRing()
+                                                                  ? strategy->GetRingSize() / 2 : pool_size_.load() / 4);
+        bool read_ahead = true;
+        auto extent_page_num = (page_id_t)options_.read_ahead_extent_page_num_;
+        if (extent_page_num != 0 && first_page_id > 0) {
+            auto extent_end = ((first_page_id - 1) / extent_page_num + 1) * extent_page_num;
+            if ((size_t)(extent_end - first_page_id) <= page_num) {
+                page_num = extent_end - first_page_id;
+                read_ahead = false;
+            }
+        }
+        if (page_num != 0) LoadPages(first_page_id, page_num, strategy, read_ahead);
+    }
+
+    /**
+     *  @brief Start reading the pages of a range that are on disk and not resident.
+     *
+     *  The reads are handed to the disk together once frames are mapped for all of them, or
+     *  when no frame is left. Until then, they don't count in prefetch_num_, so that
+     *  GetFreePage doesn't wait for reads that only start after it returns.
+     *
+     *  @param read_ahead mark the middle page of the range to load the range after it
+     */
+    void LoadPages(const page_id_t first_page_id, const size_t page_num, AccessStrategy *strategy,
+                   const bool read_ahead) {
+        auto end_page_id = (page_id_t)std::min<size_t>(first_page_id + page_num, disk_manager_->GetPageNum());
+        auto mark_page_id = read_ahead ? first_page_id + (page_id_t)page_num / 2 : INVALID_PAGE_ID;
+        auto next_page_id = first_page_id + (page_id_t)page_num;
+        std::vector<std::pair<page_id_t, char *>> reads;
+        // the page and frame of each read
+        std::vector<std::pair<page_id_t, frame_id_t>> loads;
+        for (auto page_id = first_page_id; page_id < end_page_id; ++page_id) {
+            auto &shard = page_table_.GetShard(page_id);
+            frame_id_t frame_id;
+            RLockTimed(shard.latch_);
+            bool is_resident = shard.Find(page_id, &frame_id);
+            if (is_resident && page_id == mark_page_id) frames_[frame_id].read_ahead_next_ = next_page_id;
+            shard.latch_.RUnlock();
+            if (is_resident || disk_manager_->IsFreePage(page_id)) continue;
+
+            if (!GetFreePage(&frame_id, strategy)) break;
+            // mapped right away, so that users of the page wait for this read instead of
+            // reading it again
+            auto &frame = frames_[frame_id];
+            WLockTimed(shard.latch_);
+            frame_id_t resident_frame_id;
+            if (shard.Find(page_id, &resident_frame_id)) {
+                shard.latch_.WUnlock();
+                UnpinFrame(frame_id);
+                continue;
+            }
+            frame.is_loading_ = true;
+            if (page_id == mark_page_id) frame.read_ahead_next_ = next_page_id;
+            shard.Insert(page_id, frame_id);
+            shard.latch_.WUnlock();
+            frame.latch_.BeginChange();
+            reads.emplace_back(page_id, pages_[frame_id].GetData());
+            loads.emplace_back(page_id, frame_id);
+        }
+        if (reads.empty()) return;
+        prefetch_num_.fetch_add(reads.size());
+        auto read_start = NowNanos();
+        disk_manager_->ReadPagesAsync(reads, [this, loads = std::move(loads), read_start](size_t i) {
+            read_latency_.RecordSince(read_start);
+            FinishLoad(loads[i].first, loads[i].second);
+        });
+    }
+
+    /**
+     *  @brief Complete a read of LoadPages, on the I/O thread, and unpin its frame.
+     */
+    void FinishLoad(const page_id_t page_id, const frame_id_t frame_id) {
+        auto page = &pages_[frame_id];
+        auto &frame = frames_[frame_id];
+        auto &shard = page_table_.GetShard(page_id);
+        frame_id_t resident_frame_id;
+        // a page deallocated since LoadPages looked, by a DeletePage that found it not resident
+        // yet, may still be on disk, or cut off the file and left unread
+        bool is_allocated = (size_t)page_id < disk_manager_->GetPageNum() && !disk_manager_->IsFreePage(page_id);
+        WLockTimed(shard.latch_);
+        // a page never written has no header naming it, NewPage may have mapped it meanwhile
+        bool is_mapped = shard.Find(page_id, &resident_frame_id) && resident_frame_id == frame_id;
+        bool is_loaded = is_mapped && is_allocated && page->GetPageId() == page_id;
+        if (is_mapped && !is_loaded) shard.Erase(page_id);
+        shard.latch_.WUnlock();
+        if (is_loaded) {
+            AdmitFrame(frame_id, page_id);
+            stat_counters_.Add(STAT_PREFETCH);
+        } else {
+            frame.epoch_.fetch_add(1);
+            page->ResetMemory();
+            page->SetPageId(INVALID_PAGE_ID);
+            frame.read_ahead_next_ = INVALID_PAGE_ID;
+        }
+        // the change began with the read in LoadPages
+        frame.latch_.EndChange();
+        frame.is_loading_.store(false);
+        UnpinFrame(frame_id);
+        prefetch_num_.fetch_sub(1);
+    }
+
+    /**
+     *  @brief Write the dirty pages of frames the caller has pinned once each, and unpin them.
+     *
+     *  Pages are copied out under their frame latch, then written in page id order, in batches
+     *  of FLUSH_BATCH_PAGE_NUM with neighbouring pages in one vectored write. The frames stay
+     *  pinned until their page is on disk, so an evicted page is never read back stale. The log
+     *  is flushed up to the highest LSN of a batch before the batch is written.
+     *
+     *  @param frames pairs of page id and frame, sorted by this call
+     *  @return the number of pages written
+     */
+    size_t WritePinnedFrames(std::vector<std::pair<page_id_t, frame_id_t>> &frames) {
+        if (frames.empty()) return 0;
+        std::sort(frames.begin(), frames.end());
+        FrameArena batch_arena(std::min(frames.size(), FLUSH_BATCH_PAGE_NUM), page_size);
+        std::vector<std::pair<page_id_t, const char *>> batch;
+        std::vector<frame_id_t> batch_frames;
+        lsn_t batch_lsn = INVALID_LSN;
+        size_t write_num = 0;
+        for (size_t i = 0; i < frames.size(); ++i) {
+            auto page_id = frames[i].first;
+            auto frame_id = frames[i].second;
+            auto &frame = frames_[frame_id];
+            frame.latch_.RLock();
+            bool is_dirty = page_id != INVALID_PAGE_ID && frame.is_dirty_.exchange(false);
+            if (is_dirty) {
+                char *data = batch_arena.GetFrame(batch.size());
+                memcpy(data, pages_[frame_id].GetData(), page_size);
+                batch_lsn = std::max(batch_lsn, ((disk::Page<page_size> *)data)->GetLSN());
+                batch.emplace_back(page_id, data);
+                batch_frames.push_back(frame_id);
+            }
+            frame.latch_.RUnlock();
+            if (!is_dirty) UnpinFrame(frame_id);
+            if (batch.size() == batch_arena.GetFrameNum() || (i + 1 == frames.size() && !batch.empty())) {
+                FlushLog(batch_lsn);
+                auto write_start = NowNanos();
+                disk_manager_->WritePages(batch);
+                write_latency_.RecordSince(write_start);
+                for (auto batch_frame_id : batch_frames) {
+                    // changed again since copied, the page keeps its recLSN until written again
+                    auto &batch_frame = frames_[batch_frame_id];
+                    batch_frame.latch_.RLock();
+                    if (!batch_frame.is_dirty_.load()) batch_frame.rec_lsn_ = INVALID_LSN;
+                    batch_frame.latch_.RUnlock();
+                    UnpinFrame(batch_frame_id);
+                }
+                batch_lsn = INVALID_LSN;
+                write_num += batch.size();
+                batch.clear();
+                batch_frames.clear();
+            }
+        }
+        return write_num;
+    }
+
+    /**
+     *  @brief Body of the background writer thread, runs rounds until the pool is destroyed.
+     */
+    void RunWriter() {
+        std::unique_lock<std::mutex> lock(writer_latch_);
+        while (true) {
+            writer_cv_.wait_for(lock, std::chrono::milliseconds(options_.writer_interval_ms_),
+                                [this]() { return writer_stop_ || writer_wakeup_; });
+            if (writer_stop_) return;
+            writer_wakeup_ = false;
+            lock.unlock();
+            stat_counters_.Add(STAT_WRITER_WRITE, RunWriterRound() + RunDrainRound());
+            lock.lock();
+        }
+    }
+
+    /**
+     *  @brief Write the dirty pages among the next victims of the replacer, if too few are clean.
+     *  @return the number of pages written
+     */
+    size_t RunWriterRound() {
+        std::vector<frame_id_t> victims(options_.writer_high_watermark_);
+        std::vector<std::pair<page_id_t, frame_id_t>> frames;
+        {
+            std::lock_guard<std::mutex> guard(replacer_latch_);
+            size_t victim_num = replacer_->NextVictims(victims.data(), victims.size());
+            size_t clean_num = 0;
+            for (size_t i = 0; i < victim_num; ++i) {
+                if (!frames_[victims[i]].is_dirty_.load()) ++clean_num;
+            }
+            if (clean_num >= options_.writer_low_watermark_) return 0;
+            for (size_t i = 0; i < victim_num && frames.size() < options_.writer_max_pages_; ++i) {
+                auto frame_id = victims[i];
+                if (!frames_[frame_id].is_dirty_.load()) continue;
+                // a frame the replacer may victimize is not under eviction, and it takes the
+                // replacer latch to become one, so it is pinned safely without its shard latch
+                frames_[frame_id].pin_count_.fetch_add(1);
+                frames.emplace_back(pages_[frame_id].GetPageId(), frame_id);
+            }
+        }
+        return WritePinnedFrames(frames);
+    }
+
+    /**
+     *  @brief Write the next pages asked for by DrainDirtyPages, at most writer_max_pages_.
+     *  @return the number of pages written
+     */
+    size_t RunDrainRound() {
+        std::vector<page_id_t> page_ids;
+        {
+            std::lock_guard<std::mutex> guard(writer_latch_);
+            size_t page_num = std::min(drain_pages_.size(), options_.writer_max_pages_);
+            page_ids.assign(drain_pages_.begin(), drain_pages_.begin() + page_num);
+            drain_pages_.erase(drain_pages_.begin(), drain_pages_.begin() + page_num);
+        }
+        std::vector<std::pair<page_id_t, frame_id_t>> frames;
+        for (auto page_id : page_ids) {
+            auto &shard = page_table_.GetShard(page_id);
+            frame_id_t frame_id;
+            RLockTimed(shard.latch_);
+            if (shard.Find(page_id, &frame_id) && frames_[frame_id].is_dirty_.load()) {
+                PinFrame(frame_id, false);
+                frames.emplace_back(page_id, frame_id);
+            }
+            shard.latch_.RUnlock();
+        }
+        return WritePinnedFrames(frames);
+    }
 };
 
 
-} // dsbus
\ No newline at end of file
+} // dsbus
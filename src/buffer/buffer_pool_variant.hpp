@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "buffer/buffer_pool_manager.hpp"
+#include "buffer/lru_replacer.hpp"
+#include "disk/disk_manager.hpp"
+
+namespace dsbus {
+
+/**
+ *  A compile time list of page sizes, the specializations a runtime page size dispatches to.
+ */
+template<size_t... page_sizes>
+struct PageSizeList {
+    static constexpr bool Contains(const size_t page_size) { return ((page_size == page_sizes) || ...); }
+};
+
+// page sizes a store may be opened with at runtime, see DispatchPageSize and BufferPoolVariant
+using SupportedPageSizes = PageSizeList<4096, 8192, 16384, 65536>;
+
+/**
+ *  @brief Call body with std::integral_constant<size_t, page_size> for a page size known only at
+ *         runtime, so that code templated on the page size runs on the matching specialization.
+ *
+ *  The dispatch is one comparison per listed size, done once per store rather than per page.
+ *  A page size not in the list is an error.
+ *
+ *  @param body generic callable, it must return the same type for every page size
+ */
+template<size_t first, size_t... rest, typename Body>
+decltype(auto) DispatchPageSize(PageSizeList<first, rest...>, const size_t page_size, Body &&body) {
+    if constexpr (sizeof...(rest) == 0) {
+        if (page_size != first) {
+            std::cerr << "unsupported page size " << page_size << std::endl;
+            exit(0);
+        }
+        return body(std::integral_constant<size_t, first>());
+    } else {
+        if (page_size == first) return body(std::integral_constant<size_t, first>());
+        return DispatchPageSize(PageSizeList<rest...>(), page_size, std::forward<Body>(body));
+    }
+}
+
+template<typename Body>
+decltype(auto) DispatchPageSize(const size_t page_size, Body &&body) {
+    return DispatchPageSize(SupportedPageSizes(), page_size, std::forward<Body>(body));
+}
+
+template<typename Replacer = LRUReplacer, typename Disk = DiskManager, typename PageSizes = SupportedPageSizes>
+class BufferPoolVariant;
+
+/**
+ *  BufferPoolVariant is a BufferPoolManager whose page size is taken from its Disk at runtime,
+ *  so that one process hosts stores of different page sizes.
+ *
+ *  It holds the BufferPoolManager specialization of the page size, one of PageSizes. Visit
+ *  hands it to a generic callable, which runs on the specialization with the page size as a
+ *  constant, as fast as code written for that page size. Visit once around a piece of work,
+ *  e.g. a scan or a transaction, not around every page.
+ */
+template<typename Replacer, typename Disk, size_t... page_sizes>
+class BufferPoolVariant<Replacer, Disk, PageSizeList<page_sizes...>> {
+    using Pool = std::variant<std::unique_ptr<BufferPoolManager<page_sizes, Replacer, Disk>>...>;
+public:
+    /**
+     *  @param pool_size buffer pool size
+     *  @param disk_manager for read write db file, its page size selects the specialization
+     *  @param options see BufferPoolOptions
+     */
+    BufferPoolVariant(const size_t pool_size, Disk *disk_manager,
+                      const BufferPoolOptions &options = BufferPoolOptions())
+                    : page_size_(disk_manager->GetPageSize()),
+                      pool_(DispatchPageSize(PageSizeList<page_sizes...>(), page_size_, [&](auto page_size) {
+                          using BufferPool = BufferPoolManager<decltype(page_size)::value, Replacer, Disk>;
+                          return Pool(std::make_unique<BufferPool>(pool_size, disk_manager, options));
+                      })) {}
+
+    size_t GetPageSize() const { return page_size_; }
+
+    /**
+     *  @brief Call visit with the BufferPoolManager, of the specialization of the page size.
+     *  @param visit generic callable taking BufferPoolManager<page_size, Replacer, Disk> &
+     */
+    template<typename Body>
+    decltype(auto) Visit(Body &&visit) {
+        return std::visit([&](auto &bpm) -> decltype(auto) { return visit(*bpm); }, pool_);
+    }
+
+private:
+    size_t page_size_;
+    Pool pool_;
+};
+
+} // dsbus
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "buffer/frame_list.hpp"
+#include "disk/disk_config.h"
+
+namespace dsbus {
+/**
+ * ClockReplacer implements the CLOCK (second chance) replacement policy.
+ *
+ * Frames form a ring swept by a clock hand. Accessing a frame sets its reference bit, the hand
+ * clears the bit of referenced frames and victimizes the first unpinned frame without it.
+ * A freshly loaded page starts without the bit, so pages touched once are the first to go.
+ */
+class ClockReplacer {
+public:
+    /**
+     *  @brief Create a new ClockReplacer.
+     *  @param num_pages the maximum number of pages the ClockReplacer will be required to store
+     */
+    explicit ClockReplacer(const size_t num_pages)
+                          : num_pages_(num_pages), capacity_(num_pages), nodes_(num_pages), free_list_(num_pages, 1) {
+        for (size_t i = 0; i < num_pages; ++i) free_list_.PushBack(0, (frame_id_t)i);
+    }
+
+    ~ClockReplacer() {}
+
+    /**
+     *  @brief Remove the victim frame as defined by the replacement policy.
+     *         Pin the evicted frame.
+     *  @param[out] frame_id id of frame that was removed
+     *  @return true if a victim frame was found, false otherwise
+     */
+    bool Victim(frame_id_t *frame_id) {
+        if (!free_list_.Empty(0)) {
+            *frame_id = free_list_.Front(0);
+            free_list_.Remove(*frame_id);
+        } else if (evictable_size_ != 0) {
+            // at most two turns: the first one clears every reference bit
+            while (true) {
+                auto &node = nodes_[hand_];
+                frame_id_t current = (frame_id_t)hand_;
+                hand_ = hand_ + 1 == num_pages_ ? 0 : hand_ + 1;
+                if (node.state_ != FrameState::EVICTABLE) continue;
+                if (node.referenced_) {
+                    node.referenced_ = false;
+                    continue;
+                }
+                *frame_id = current;
+                break;
+            }
+            --evictable_size_;
+        } else {
+            return false;
+        }
+        auto &node = nodes_[*frame_id];
+        node.state_ = FrameState::PINNED;
+        node.pin_count_ = 1;
+        node.referenced_ = false;
+        return true;
+    }
+
+    /**
+     *  @brief Pins a frame and sets its reference bit.
+     *  @param frame_id the id of the frame to pin
+     */
+    void Pin(frame_id_t frame_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        switch (node.state_) {
+        case FrameState::FREE:
+            free_list_.Remove(frame_id);
+            break;
+        case FrameState::EVICTABLE:
+            --evictable_size_;
+            node.referenced_ = true;
+            break;
+        case FrameState::PINNED:
+            ++node.pin_count_;
+            node.referenced_ = true;
+            return;
+        }
+        node.state_ = FrameState::PINNED;
+        node.pin_count_ = 1;
+    }
+
+    /**
+     *  @brief Unpins a frame, indicating that it can now be victimized.
+     *  @param frame_id the id of the frame to unpin
+     */
+    void Unpin(frame_id_t frame_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        if (node.state_ != FrameState::PINNED) return;
+        if (--node.pin_count_ != 0) return;
+        node.state_ = FrameState::EVICTABLE;
+        ++evictable_size_;
+    }
+
+    /**
+     *  @brief Sets the reference bit of a pinned frame.
+     */
+    void RecordAccess(frame_id_t frame_id, size_t access_num) {
+        if (!IsValid(frame_id) || nodes_[frame_id].state_ != FrameState::PINNED) return;
+        nodes_[frame_id].referenced_ = true;
+    }
+
+    void Admit(frame_id_t frame_id, page_id_t page_id) {}
+
+    /**
+     *  @brief The number of elements in the replacer that can be victimized.
+     */
+    size_t Size() { return free_list_.Size(0) + evictable_size_; }
+
+    /**
+     *  @brief Copy the at most n next victims: unpinned frames from the hand on, the ones
+     *         without reference bit first, as the hand clears the others on its first turn.
+     */
+    size_t NextVictims(frame_id_t *frame_ids, const size_t n) const {
+        size_t count = 0;
+        for (bool referenced : {false, true}) {
+            for (size_t i = 0; i < num_pages_ && count < n; ++i) {
+                size_t frame_id = hand_ + i < num_pages_ ? hand_ + i : hand_ + i - num_pages_;
+                auto &node = nodes_[frame_id];
+                if (node.state_ == FrameState::EVICTABLE && node.referenced_ == referenced) {
+                    frame_ids[count++] = (frame_id_t)frame_id;
+                }
+            }
+        }
+        return count;
+    }
+
+    /**
+     *  @brief Move a pinned frame that holds no page to the free list.
+     */
+    void Free(frame_id_t frame_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        if (node.state_ != FrameState::PINNED) return;
+        node.state_ = FrameState::FREE;
+        node.pin_count_ = 0;
+        node.referenced_ = false;
+        free_list_.PushBack(0, frame_id);
+    }
+
+    /**
+     *  @brief Frames past frame_num stay pinned, which the hand passes over, frames used again
+     *         join the free list.
+     */
+    void SetCapacity(const size_t frame_num) {
+        auto capacity = std::min(frame_num, num_pages_);
+        for (size_t i = capacity_; i < capacity; ++i) Free((frame_id_t)i);
+        capacity_ = capacity;
+    }
+
+private:
+    enum class FrameState : uint8_t { FREE, EVICTABLE, PINNED };
+
+    struct Node {
+        uint32_t pin_count_ = 0;
+        bool referenced_ = false;
+        FrameState state_ = FrameState::FREE;
+    };
+
+    size_t num_pages_;
+    // frames the pool uses, see SetCapacity
+    size_t capacity_;
+    std::vector<Node> nodes_;
+    size_t hand_ = 0;
+    size_t evictable_size_ = 0;
+    FrameLists free_list_;
+
+    bool IsValid(frame_id_t frame_id) const { return frame_id >= 0 && (size_t)frame_id < num_pages_; }
+};
+
+} // dsbus
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "common/config.h"
+#include "common/numa.h"
+#include "disk/disk_config.h"
+
+namespace dsbus {
+
+/**
+ *  How the memory of a FrameArena is backed.
+ */
+enum class HugePageMode {
+    // regular pages
+    NONE,
+    // transparent huge pages, asked for with madvise(MADV_HUGEPAGE), the kernel backs the
+    // arena with huge pages as it can
+    TRANSPARENT,
+    // huge pages reserved by the administrator, mmap(MAP_HUGETLB)
+    EXPLICIT
+};
+
+/**
+ *  FrameArena is the memory of the buffer pool frames, one block of frame_num * frame_size
+ *  bytes whose start is aligned to DIRECT_IO_ALIGNMENT.
+ *
+ *  Frames of a size multiple of the alignment are then all aligned, as O_DIRECT requires of
+ *  I/O buffers, and no frame straddles more memory pages than it needs to.
+ *
+ *  Large arenas may be backed by huge pages, so that a pool of many GiB needs far fewer TLB
+ *  entries. The arena is then mapped in whole HUGE_PAGE_SIZE units, aligned to one. Asking for
+ *  EXPLICIT falls back to TRANSPARENT when no huge page is reserved, which falls back to
+ *  regular pages when the kernel has no transparent huge pages. Arenas smaller than a huge
+ *  page always use regular pages. GetHugePageMode tells what the arena got.
+ *
+ *  Given a NUMA node, the arena is placed on the memory of that node, see GetNumaNode.
+ *
+ *  An arena given max_frame_num reserves address space for that many frames, and Resize moves
+ *  the number of frames in use within it. The kernel only backs memory pages once touched, and
+ *  takes back those of the frames a shrink gives up, so memory follows the frames in use while
+ *  frame addresses never change. Such an arena takes transparent huge pages when asked for
+ *  explicit ones, which are reserved for the whole mapping.
+ */
+class FrameArena {
+public:
+    FrameArena(const size_t frame_num, const size_t frame_size, const HugePageMode huge_page_mode = HugePageMode::NONE,
+               const int numa_node = -1, const size_t max_frame_num = 0)
+              : frame_num_(frame_num), max_frame_num_(std::max(frame_num, max_frame_num)), frame_size_(frame_size) {
+        size_t size = max_frame_num_ * frame_size;
+        bool resizable = max_frame_num_ > frame_num;
+        if (huge_page_mode != HugePageMode::NONE && size >= HUGE_PAGE_SIZE) {
+            map_size_ = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+            memory_page_size_ = HUGE_PAGE_SIZE;
+            if (huge_page_mode == HugePageMode::EXPLICIT && !resizable) MapExplicit();
+            if (data_ == nullptr) MapTransparent();
+        }
+        if (data_ == nullptr && resizable) {
+            memory_page_size_ = (size_t)sysconf(_SC_PAGESIZE);
+            map_size_ = (size + memory_page_size_ - 1) / memory_page_size_ * memory_page_size_;
+            MapRegular();
+        }
+        if (data_ == nullptr) {
+            map_size_ = 0;
+            // aligned_alloc wants a size multiple of the alignment
+            size = (size + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+            data_ = (char *)aligned_alloc(DIRECT_IO_ALIGNMENT, size == 0 ? DIRECT_IO_ALIGNMENT : size);
+        }
+        if (data_ == nullptr) {
+            std::cerr << "can't allocate buffer pool frames" << std::endl;
+            exit(0);
+        }
+        // the whole mapping, so that frames a resize adds are placed on the node as well
+        auto bind_size = map_size_ != 0 ? map_size_ : GetReservedSize();
+        if (numa_node >= 0 && numa::BindMemory(data_, bind_size, numa_node)) numa_node_ = numa_node;
+    }
+
+    ~FrameArena() {
+        if (map_size_ != 0) {
+            munmap(data_, map_size_);
+        } else {
+            free(data_);
+        }
+    }
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    char *GetData() const { return data_; }
+
+    char *GetFrame(const size_t frame_id) const { return data_ + frame_id * frame_size_; }
+
+    size_t GetFrameNum() const { return frame_num_.load(); }
+
+    /**
+     *  @brief Returns the number of frames the arena has address space for, see Resize.
+     */
+    size_t GetMaxFrameNum() const { return max_frame_num_; }
+
+    /**
+     *  @brief Use frames 0 .. frame_num - 1, at most GetMaxFrameNum().
+     *
+     *  The memory pages past the last frame in use are given back to the kernel, unless the
+     *  arena was allocated without mmap. The caller must no longer write the frames given up,
+     *  reads of them return zeroes or stale data, frames used again may hold either.
+     */
+    void Resize(size_t frame_num) {
+        frame_num = std::min(frame_num, max_frame_num_);
+        if (frame_num < frame_num_.load() && map_size_ != 0) {
+            size_t begin = RoundToMemoryPage(frame_num * frame_size_);
+            size_t end = std::min(map_size_, RoundToMemoryPage(frame_num_.load() * frame_size_));
+            if (begin < end) madvise(data_ + begin, end - begin, MADV_DONTNEED);
+        }
+        frame_num_.store(frame_num);
+    }
+
+    size_t GetFrameSize() const { return frame_size_; }
+
+    HugePageMode GetHugePageMode() const { return huge_page_mode_; }
+
+    /**
+     *  @brief Returns the NUMA node the arena is bound to, -1 if none was asked for or the
+     *         kernel refused.
+     */
+    int GetNumaNode() const { return numa_node_; }
+
+    /**
+     *  @brief Returns the bytes of memory the arena holds for the frames in use, and rounding.
+     */
+    size_t GetReservedSize() const {
+        if (map_size_ != 0) return std::min(map_size_, RoundToMemoryPage(frame_num_.load() * frame_size_));
+        size_t size = (frame_num_.load() * frame_size_ + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT
+                      * DIRECT_IO_ALIGNMENT;
+        return size == 0 ? DIRECT_IO_ALIGNMENT : size;
+    }
+
+    /**
+     *  @brief Returns the bytes of the arena backed by huge pages.
+     *
+     *  For transparent huge pages, the kernel reports them in /proc/self/smaps once frames are
+     *  touched. Reading it takes a while, this is meant for statistics.
+     */
+    size_t GetHugePageSize() const {
+        switch (huge_page_mode_) {
+            case HugePageMode::EXPLICIT: return map_size_;
+            case HugePageMode::TRANSPARENT: return ReadAnonHugePages();
+            default: return 0;
+        }
+    }
+
+private:
+    // frames in use, changed by Resize
+    std::atomic<size_t> frame_num_;
+    size_t max_frame_num_;
+    size_t frame_size_;
+    char *data_ = nullptr;
+    // bytes mapped with mmap, 0 if allocated with aligned_alloc
+    size_t map_size_ = 0;
+    // unit in which the mapping is backed and given back
+    size_t memory_page_size_ = 0;
+    HugePageMode huge_page_mode_ = HugePageMode::NONE;
+    int numa_node_ = -1;
+
+    size_t RoundToMemoryPage(const size_t size) const {
+        return (size + memory_page_size_ - 1) / memory_page_size_ * memory_page_size_;
+    }
+
+    void MapRegular() {
+        // mappings start on a memory page, which is a multiple of DIRECT_IO_ALIGNMENT
+        void *data = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data != MAP_FAILED) data_ = (char *)data;
+    }
+
+    void MapExplicit() {
+        void *data = mmap(nullptr, map_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (data == MAP_FAILED) return;
+        data_ = (char *)data;
+        huge_page_mode_ = HugePageMode::EXPLICIT;
+    }
+
+    void MapTransparent() {
+        // one more huge page, so that an aligned block can be cut out of the mapping
+        size_t size = map_size_ + HUGE_PAGE_SIZE;
+        void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED) return;
+        auto start = (uintptr_t)data;
+        auto aligned = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        auto end = aligned + map_size_;
+        if (aligned != start) munmap(data, aligned - start);
+        if (end != start + size) munmap((char *)end, start + size - end);
+        data_ = (char *)aligned;
+        // without transparent huge pages the mapping is still good, on regular pages
+        if (madvise(data_, map_size_, MADV_HUGEPAGE) == 0) huge_page_mode_ = HugePageMode::TRANSPARENT;
+    }
+
+    /**
+     *  @brief Sum AnonHugePages over the mappings of /proc/self/smaps overlapping the arena.
+     */
+    size_t ReadAnonHugePages() const {
+        FILE *smaps = fopen("/proc/self/smaps", "r");
+        if (smaps == nullptr) return 0;
+        auto begin = (uintptr_t)data_;
+        auto end = begin + map_size_;
+        bool in_arena = false;
+        size_t huge_page_size = 0;
+        char line[256];
+        while (fgets(line, sizeof(line), smaps) != nullptr) {
+            uintptr_t start;
+            uintptr_t stop;
+            size_t kb;
+            if (sscanf(line, "%lx-%lx ", &start, &stop) == 2) {
+                in_arena = start < end && stop > begin;
+            } else if (in_arena && sscanf(line, "AnonHugePages: %zu kB", &kb) == 1) {
+                huge_page_size += kb << 10;
+            }
+        }
+        fclose(smaps);
+        return huge_page_size;
+    }
+};
+
+} // dsbus
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <atomic>
+
+#include "common/config.h"
+#include "common/optimistic_latch.h"
+#include "disk/disk_config.h"
+
+namespace dsbus {
+
+class Swip;
+
+/**
+ *  Bookkeeping of one buffer pool frame, kept apart from the page data so that
+ *  frames stay exactly page_size bytes.
+ */
+class FrameHeader {
+public:
+    // number of users of the frame, changes to and from 0 are made under the replacer latch
+    std::atomic<int32_t> pin_count_{0};
+    // fetches that found the frame pinned already, and so did not tell the replacer, handed
+    // to it when the pin count drops to 0
+    std::atomic<uint32_t> access_num_{0};
+    // the page in the frame differs from its copy on disk
+    std::atomic<bool> is_dirty_{false};
+    // LSN of the first logged change since the page was last written, INVALID_LSN if none,
+    // set under the exclusive latch and cleared once the page is on disk
+    std::atomic<lsn_t> rec_lsn_{INVALID_LSN};
+    // protects the page content, taken by callers that read or write the page; its version
+    // also moves while the buffer pool loads, creates or drops the page of the frame
+    OptimisticLatch latch_;
+    // moves on, within a change of the latch, each time the frame drops its page. Kept out of
+    // the page, whose memory a shrink gives back and which then reads as page 0
+    std::atomic<uint64_t> epoch_{0};
+    // the page is being read in the background, users that pinned it wait until it is loaded
+    std::atomic<bool> is_loading_{false};
+    // set on a page of a read-ahead window, the first page of the next window to load once
+    // this one is fetched, INVALID_PAGE_ID otherwise
+    std::atomic<page_id_t> read_ahead_next_{INVALID_PAGE_ID};
+    // the swip swizzled to this frame, nullptr if none, set and cleared under the latch of the
+    // page table shard of the page
+    std::atomic<Swip *> swip_{nullptr};
+};
+
+} // dsbus
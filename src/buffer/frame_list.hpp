@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+
+namespace dsbus {
+
+/**
+ *  FrameLists is a fixed number of intrusive doubly-linked lists of frame ids.
+ *
+ *  Links live in one flat array indexed by frame id, followed by one sentinel head per list,
+ *  a frame is in at most one list at a time. All operations are O(1) and never allocate.
+ */
+class FrameLists {
+public:
+    static constexpr int32_t NO_LIST = -1;
+
+    FrameLists(const size_t num_frames, const size_t num_lists)
+              : num_frames_(num_frames), links_(num_frames + num_lists),
+                list_of_(num_frames, NO_LIST), sizes_(num_lists, 0) {
+        for (size_t i = 0; i < num_lists; ++i) {
+            auto head = Head(i);
+            links_[head].prev_ = links_[head].next_ = head;
+        }
+    }
+
+    void PushBack(const size_t list, const frame_id_t frame_id) {
+        auto head = Head(list);
+        auto tail = links_[head].prev_;
+        links_[frame_id].prev_ = tail;
+        links_[frame_id].next_ = head;
+        links_[tail].next_ = frame_id;
+        links_[head].prev_ = frame_id;
+        list_of_[frame_id] = (int32_t)list;
+        ++sizes_[list];
+    }
+
+    /**
+     *  @brief Unlink frame_id from the list it is in, if any.
+     */
+    void Remove(const frame_id_t frame_id) {
+        auto list = list_of_[frame_id];
+        if (list == NO_LIST) return;
+        auto &link = links_[frame_id];
+        links_[link.prev_].next_ = link.next_;
+        links_[link.next_].prev_ = link.prev_;
+        list_of_[frame_id] = NO_LIST;
+        --sizes_[list];
+    }
+
+    /**
+     *  @brief Returns the oldest frame of list, which must not be empty.
+     */
+    frame_id_t Front(const size_t list) const { return links_[Head(list)].next_; }
+
+    /**
+     *  @brief Copy the at most n oldest frames of list to frame_ids.
+     *  @return the number of frames copied
+     */
+    size_t CopyFront(const size_t list, frame_id_t *frame_ids, const size_t n) const {
+        size_t count = 0;
+        for (auto frame_id = Front(list); frame_id != Head(list) && count < n; frame_id = links_[frame_id].next_) {
+            frame_ids[count++] = frame_id;
+        }
+        return count;
+    }
+
+    int32_t ListOf(const frame_id_t frame_id) const { return list_of_[frame_id]; }
+
+    size_t Size(const size_t list) const { return sizes_[list]; }
+
+    bool Empty(const size_t list) const { return sizes_[list] == 0; }
+
+private:
+    struct Link {
+        frame_id_t prev_;
+        frame_id_t next_;
+    };
+
+    size_t num_frames_;
+    std::vector<Link> links_;
+    std::vector<int32_t> list_of_;
+    std::vector<size_t> sizes_;
+
+    frame_id_t Head(const size_t list) const { return (frame_id_t)(num_frames_ + list); }
+};
+
+} // dsbus
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "disk/disk_config.h"
+
+namespace dsbus {
+
+/**
+ *  GhostList remembers the ids of recently evicted pages in FIFO order, with O(1) lookup.
+ *
+ *  Entries live in a ring of `capacity` slots. Erasing a page leaves a stale slot behind
+ *  which is skipped when the ring wraps, so capacity bounds slots rather than live pages.
+ */
+class GhostList {
+public:
+    explicit GhostList(const size_t capacity) : ring_(capacity) {}
+
+    /**
+     *  @brief Remember page_id as the newest entry, forgetting the oldest one if the ring is full.
+     */
+    void PushBack(const page_id_t page_id) {
+        if (ring_.empty() || page_id == INVALID_PAGE_ID) return;
+        Erase(page_id);
+        if (tail_ - head_ == ring_.size()) PopFront();
+        ring_[tail_ % ring_.size()] = page_id;
+        map_[page_id] = tail_++;
+    }
+
+    /**
+     *  @brief Forget the oldest entry.
+     */
+    void PopFront() {
+        while (head_ != tail_) {
+            auto seq = head_++;
+            auto it = map_.find(ring_[seq % ring_.size()]);
+            if (it != map_.end() && it->second == seq) {
+                map_.erase(it);
+                return;
+            }
+        }
+    }
+
+    bool Contains(const page_id_t page_id) const { return map_.count(page_id) != 0; }
+
+    /**
+     *  @brief Forget page_id.
+     *  @return true if page_id was remembered
+     */
+    bool Erase(const page_id_t page_id) { return map_.erase(page_id) != 0; }
+
+    size_t Size() const { return map_.size(); }
+
+private:
+    std::vector<page_id_t> ring_;
+    // page id -> sequence number of its slot
+    std::unordered_map<page_id_t, size_t> map_;
+    size_t head_ = 0;
+    size_t tail_ = 0;
+};
+
+} // dsbus
@@ -0,0 +1,269 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "buffer/frame_list.hpp"
+#include "disk/disk_config.h"
+
+namespace dsbus {
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the unpinned frame whose K-th most recent access is the oldest. Frames with
+ * fewer than K recorded accesses have an infinite backward K-distance and go first, the one
+ * with the oldest first access among them. A page touched once by a scan therefore leaves
+ * before pages that were accessed repeatedly.
+ *
+ * The last K access timestamps of each frame are kept in a flat array, unpinned frames sit
+ * in an indexed binary heap, so Victim / Pin / Unpin are O(log n) and never allocate.
+ */
+class LRUKReplacer {
+public:
+    /**
+     *  @brief Create a new LRUKReplacer.
+     *  @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+     *  @param k the number of accesses remembered per frame
+     */
+    explicit LRUKReplacer(const size_t num_pages, const size_t k = LRUK_REPLACER_K)
+                         : num_pages_(num_pages), capacity_(num_pages), k_(k == 0 ? 1 : k), nodes_(num_pages),
+                           history_(num_pages * k_), heap_(num_pages), free_list_(num_pages, 1) {
+        for (size_t i = 0; i < num_pages; ++i) free_list_.PushBack(0, (frame_id_t)i);
+    }
+
+    ~LRUKReplacer() {}
+
+    /**
+     *  @brief Remove the victim frame as defined by the replacement policy.
+     *         Pin the evicted frame.
+     *  @param[out] frame_id id of frame that was removed
+     *  @return true if a victim frame was found, false otherwise
+     */
+    bool Victim(frame_id_t *frame_id) {
+        if (!free_list_.Empty(0)) {
+            *frame_id = free_list_.Front(0);
+            free_list_.Remove(*frame_id);
+        } else if (heap_size_ != 0) {
+            *frame_id = heap_[0];
+            HeapRemove(*frame_id);
+        } else {
+            return false;
+        }
+        auto &node = nodes_[*frame_id];
+        node.state_ = FrameState::PINNED;
+        node.pin_count_ = 1;
+        // the frame will hold another page, its history is gone
+        node.access_num_ = 0;
+        node.history_head_ = 0;
+        return true;
+    }
+
+    /**
+     *  @brief Pins a frame and records an access to it.
+     *  @param frame_id the id of the frame to pin
+     */
+    void Pin(frame_id_t frame_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        switch (node.state_) {
+        case FrameState::FREE:
+            free_list_.Remove(frame_id);
+            break;
+        case FrameState::EVICTABLE:
+            HeapRemove(frame_id);
+            RecordAccess(frame_id);
+            break;
+        case FrameState::PINNED:
+            ++node.pin_count_;
+            RecordAccess(frame_id);
+            return;
+        }
+        node.state_ = FrameState::PINNED;
+        node.pin_count_ = 1;
+    }
+
+    /**
+     *  @brief Unpins a frame, indicating that it can now be victimized.
+     *  @param frame_id the id of the frame to unpin
+     */
+    void Unpin(frame_id_t frame_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        if (node.state_ != FrameState::PINNED) return;
+        if (--node.pin_count_ != 0) return;
+        node.state_ = FrameState::EVICTABLE;
+        node.key_ = Key(frame_id);
+        HeapPush(frame_id);
+    }
+
+    /**
+     *  @brief Record the accesses of a pinned frame, the last k_ of them are all it keeps.
+     */
+    void RecordAccess(frame_id_t frame_id, size_t access_num) {
+        if (!IsValid(frame_id) || nodes_[frame_id].state_ != FrameState::PINNED) return;
+        for (size_t i = 0; i < std::min(access_num, k_); ++i) RecordAccess(frame_id);
+    }
+
+    /**
+     *  @brief Loading a page is its first access.
+     */
+    void Admit(frame_id_t frame_id, page_id_t page_id) {
+        if (!IsValid(frame_id)) return;
+        nodes_[frame_id].access_num_ = 0;
+        nodes_[frame_id].history_head_ = 0;
+        RecordAccess(frame_id);
+    }
+
+    /**
+     *  @brief The number of elements in the replacer that can be victimized.
+     */
+    size_t Size() { return free_list_.Size(0) + heap_size_; }
+
+    /**
+     *  @brief Copy the at most n unpinned frames of the smallest keys, the next victims.
+     *
+     *  The heap is searched from its root, keeping the positions whose parent was taken in
+     *  a small heap of its own, so only O(n) entries are looked at.
+     */
+    size_t NextVictims(frame_id_t *frame_ids, const size_t n) const {
+        if (heap_size_ == 0) return 0;
+        auto later = [this](size_t a, size_t b) { return nodes_[heap_[a]].key_ > nodes_[heap_[b]].key_; };
+        std::vector<size_t> next{0};
+        size_t count = 0;
+        while (!next.empty() && count < n) {
+            std::pop_heap(next.begin(), next.end(), later);
+            size_t pos = next.back();
+            next.pop_back();
+            frame_ids[count++] = heap_[pos];
+            for (size_t child = pos * 2 + 1; child <= pos * 2 + 2 && child < heap_size_; ++child) {
+                next.push_back(child);
+                std::push_heap(next.begin(), next.end(), later);
+            }
+        }
+        return count;
+    }
+
+    /**
+     *  @brief Move a pinned frame that holds no page to the free list, without history.
+     */
+    void Free(frame_id_t frame_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        if (node.state_ != FrameState::PINNED) return;
+        node.state_ = FrameState::FREE;
+        node.pin_count_ = 0;
+        node.access_num_ = 0;
+        node.history_head_ = 0;
+        free_list_.PushBack(0, frame_id);
+    }
+
+    /**
+     *  @brief Frames past frame_num stay pinned, frames used again join the free list.
+     */
+    void SetCapacity(const size_t frame_num) {
+        auto capacity = std::min(frame_num, num_pages_);
+        for (size_t i = capacity_; i < capacity; ++i) Free((frame_id_t)i);
+        capacity_ = capacity;
+    }
+
+private:
+    enum class FrameState : uint8_t { FREE, EVICTABLE, PINNED };
+
+    struct Node {
+        uint64_t key_ = 0;
+        uint32_t pin_count_ = 0;
+        uint32_t heap_pos_ = 0;
+        // number of valid entries in the history, at most k_
+        uint32_t access_num_ = 0;
+        // slot of the oldest entry once the history is full
+        uint32_t history_head_ = 0;
+        FrameState state_ = FrameState::FREE;
+    };
+
+    size_t num_pages_;
+    // frames the pool uses, see SetCapacity
+    size_t capacity_;
+    size_t k_;
+    uint64_t current_timestamp_ = 0;
+    std::vector<Node> nodes_;
+    // history_[frame_id * k_, frame_id * k_ + k_) are the access timestamps of frame_id
+    std::vector<uint64_t> history_;
+    // min-heap of unpinned frames on key_
+    std::vector<frame_id_t> heap_;
+    size_t heap_size_ = 0;
+    FrameLists free_list_;
+
+    bool IsValid(frame_id_t frame_id) const { return frame_id >= 0 && (size_t)frame_id < num_pages_; }
+
+    void RecordAccess(frame_id_t frame_id) {
+        auto &node = nodes_[frame_id];
+        auto history = &history_[frame_id * k_];
+        if (node.access_num_ < k_) {
+            history[node.access_num_++] = current_timestamp_++;
+        } else {
+            history[node.history_head_] = current_timestamp_++;
+            node.history_head_ = (node.history_head_ + 1) % k_;
+        }
+    }
+
+    /**
+     *  @brief Frames with less than k accesses sort before all others, then by oldest access.
+     */
+    uint64_t Key(frame_id_t frame_id) const {
+        auto &node = nodes_[frame_id];
+        if (node.access_num_ == 0) return 0;
+        auto oldest = history_[frame_id * k_ + (node.access_num_ < k_ ? 0 : node.history_head_)];
+        return node.access_num_ < k_ ? oldest : (1ULL << 63) | oldest;
+    }
+
+    void HeapPush(frame_id_t frame_id) {
+        heap_[heap_size_] = frame_id;
+        nodes_[frame_id].heap_pos_ = heap_size_;
+        SiftUp(heap_size_++);
+    }
+
+    void HeapRemove(frame_id_t frame_id) {
+        size_t pos = nodes_[frame_id].heap_pos_;
+        size_t last = --heap_size_;
+        if (pos == last) return;
+        auto moved = heap_[last];
+        HeapSet(pos, moved);
+        SiftUp(pos);
+        SiftDown(nodes_[moved].heap_pos_);
+    }
+
+    void HeapSet(size_t pos, frame_id_t frame_id) {
+        heap_[pos] = frame_id;
+        nodes_[frame_id].heap_pos_ = pos;
+    }
+
+    void SiftUp(size_t pos) {
+        auto frame_id = heap_[pos];
+        auto key = nodes_[frame_id].key_;
+        while (pos > 0) {
+            size_t parent = (pos - 1) / 2;
+            if (nodes_[heap_[parent]].key_ <= key) break;
+            HeapSet(pos, heap_[parent]);
+            pos = parent;
+        }
+        HeapSet(pos, frame_id);
+    }
+
+    void SiftDown(size_t pos) {
+        auto frame_id = heap_[pos];
+        auto key = nodes_[frame_id].key_;
+        while (true) {
+            size_t child = pos * 2 + 1;
+            if (child >= heap_size_) break;
+            if (child + 1 < heap_size_ && nodes_[heap_[child + 1]].key_ < nodes_[heap_[child]].key_) ++child;
+            if (key <= nodes_[heap_[child]].key_) break;
+            HeapSet(pos, heap_[child]);
+            pos = child;
+        }
+        HeapSet(pos, frame_id);
+    }
+};
+
+} // dsbus
@@ -1,14 +1,19 @@
 #pragma once
 
-#include <iostream>
-#include <list>
-#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
 
 #include "common/config.h"
+#include "disk/disk_config.h"
 
 namespace dsbus {
 /**
  * LRUReplacer implements the Least Recently Used replacement policy.
+ *
+ * Frame ids are dense (0 .. num_pages - 1), so the free list and the lru list are
+ * intrusive doubly-linked lists threaded through one flat node array indexed by frame id,
+ * with pin counts kept inline. Victim / Pin / Unpin are O(1) and never allocate.
  */
 class LRUReplacer {
 public:
@@ -16,11 +21,16 @@ public:
      *  @brief Create a new LRUReplacer.
      *  @param num_pages the maximum number of pages the LRUReplacer will be required to store
      */
-    explicit LRUReplacer(const size_t num_pages) {
+    explicit LRUReplacer(const size_t num_pages)
+                        : num_pages_(num_pages), capacity_(num_pages), nodes_(num_pages + 2) {
+        // the two list heads are sentinel nodes after the frames
+        InitList(FreeHead());
+        InitList(LRUHead());
         for (size_t i = 0; i < num_pages; ++i) {
-            free_list_.push_back((frame_id_t)i);
-            free_map_[(frame_id_t)i] = std::prev(free_list_.end());
+            nodes_[i].state_ = FrameState::FREE;
+            PushBack(FreeHead(), (frame_id_t)i);
         }
+        free_size_ = num_pages;
     }
 
     ~LRUReplacer() {}
@@ -33,26 +43,19 @@ public:
      */
     bool Victim(frame_id_t *frame_id) {
         // select evicted frame
-        if (!free_list_.empty()) {
-            *frame_id = free_list_.front();
-            free_list_.pop_front();
-            free_map_.erase(free_map_.find(*frame_id));
-        } else if (!lru_list_.empty()) {
-            *frame_id = lru_list_.front();
-            lru_list_.pop_front();
-            lru_map_.erase(*frame_id);
+        if (free_size_ != 0) {
+            *frame_id = nodes_[FreeHead()].next_;
+            --free_size_;
+        } else if (lru_size_ != 0) {
+            *frame_id = nodes_[LRUHead()].next_;
+            --lru_size_;
         } else {
-            frame_id = nullptr;
             return false;
         }
         // pin frame
-        auto it = pin_map_.find(*frame_id);
-        if (it == pin_map_.end()) {
-            pin_map_[*frame_id] = 1;
-        } else {
-            std::cerr << "frame both exist in lru_list and pin_map" << std::endl;
-            exit(0);
-        }
+        Remove(*frame_id);
+        nodes_[*frame_id].state_ = FrameState::PINNED;
+        nodes_[*frame_id].pin_count_ = 1;
         return true;
     }
 
@@ -61,26 +64,23 @@ public:
      *  @param frame_id the id of the frame to pin
      */
     void Pin(frame_id_t frame_id) {
-        auto it1 = lru_map_.find(frame_id);
-        auto it2 = pin_map_.find(frame_id);
-        if (it1 == lru_map_.end() && it2 == pin_map_.end()) {
-            auto it3 = free_map_.find(frame_id);
-            if (it3 != free_map_.end()) {
-                free_list_.erase(it3->second);
-                free_map_.erase(it3);
-                pin_map_[frame_id] = 1;
-            }
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        switch (node.state_) {
+        case FrameState::FREE:
+            Remove(frame_id);
+            --free_size_;
+            break;
+        case FrameState::EVICTABLE:
+            Remove(frame_id);
+            --lru_size_;
+            break;
+        case FrameState::PINNED:
+            ++node.pin_count_;
             return;
         }
-        if (it1 != lru_map_.end()) {
-            lru_list_.erase(it1->second);
-            lru_map_.erase(it1);
-        }
-        if (it2 != pin_map_.end()) {
-            ++it2->second;
-        } else {
-            pin_map_[frame_id] = 1;
-        }
+        node.state_ = FrameState::PINNED;
+        node.pin_count_ = 1;
     }
 
     /**
@@ -88,34 +88,98 @@ public:
      *  @param frame_id the id of the frame to unpin
      */
     void Unpin(frame_id_t frame_id) {
-        auto it1 = pin_map_.find(frame_id);
-        auto it2 = lru_map_.find(frame_id);
-        if (it1 == pin_map_.end() && it2 == lru_map_.end()) return;
-        if (it1 == pin_map_.end()) return;
-        --it1->second;
-        if (it1->second != 0) return;
-        pin_map_.erase(it1);
-        if (it2 == lru_map_.end()) {
-            lru_list_.push_back(frame_id);
-            lru_map_[frame_id] = std::prev(lru_list_.end());
-        } else {
-            std::cerr << "frame both exist in lru_list and pin_map" << std::endl;
-            exit(0);
-        }
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        if (node.state_ != FrameState::PINNED) return;
+        if (--node.pin_count_ != 0) return;
+        node.state_ = FrameState::EVICTABLE;
+        PushBack(LRUHead(), frame_id);
+        ++lru_size_;
     }
 
+    /**
+     *  @brief Nothing to record, a frame joins the most recently used end once unpinned.
+     */
+    void RecordAccess(frame_id_t frame_id, size_t access_num) {}
+
+    void Admit(frame_id_t frame_id, page_id_t page_id) {}
+
     /**
      *  @brief The number of elements in the replacer that can be victimized.
      */
-    size_t Size() { return free_list_.size() + lru_list_.size(); }
+    size_t Size() { return free_size_ + lru_size_; }
+
+    /**
+     *  @brief Copy the at most n least recently used unpinned frames, the next victims.
+     */
+    size_t NextVictims(frame_id_t *frame_ids, const size_t n) const {
+        size_t count = 0;
+        for (auto frame_id = nodes_[LRUHead()].next_; frame_id != LRUHead() && count < n; frame_id = nodes_[frame_id].next_) {
+            frame_ids[count++] = frame_id;
+        }
+        return count;
+    }
+
+    /**
+     *  @brief Move a pinned frame that holds no page to the free list.
+     */
+    void Free(frame_id_t frame_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        if (node.state_ != FrameState::PINNED) return;
+        node.state_ = FrameState::FREE;
+        node.pin_count_ = 0;
+        PushBack(FreeHead(), frame_id);
+        ++free_size_;
+    }
+
+    /**
+     *  @brief Frames past frame_num stay pinned, frames used again join the free list.
+     */
+    void SetCapacity(const size_t frame_num) {
+        auto capacity = std::min(frame_num, num_pages_);
+        for (size_t i = capacity_; i < capacity; ++i) Free((frame_id_t)i);
+        capacity_ = capacity;
+    }
 
 private:
-    std::list<frame_id_t> free_list_;
-    std::list<frame_id_t> lru_list_;
-    std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> free_map_;
-    std::unordered_map<frame_id_t, std::list<frame_id_t>::iterator> lru_map_;
-    std::unordered_map<frame_id_t, size_t> pin_map_;
-    
+    enum class FrameState : uint8_t { FREE, EVICTABLE, PINNED };
+
+    struct Node {
+        frame_id_t prev_;
+        frame_id_t next_;
+        uint32_t pin_count_ = 0;
+        FrameState state_ = FrameState::FREE;
+    };
+
+    size_t num_pages_;
+    // frames the pool uses, see SetCapacity
+    size_t capacity_;
+    // nodes_[0, num_pages_) are frames, then the heads of the free list and the lru list
+    std::vector<Node> nodes_;
+    size_t free_size_ = 0;
+    size_t lru_size_ = 0;
+
+    frame_id_t FreeHead() const { return (frame_id_t)num_pages_; }
+    frame_id_t LRUHead() const { return (frame_id_t)num_pages_ + 1; }
+
+    bool IsValid(frame_id_t frame_id) const { return frame_id >= 0 && (size_t)frame_id < num_pages_; }
+
+    void InitList(frame_id_t head) { nodes_[head].prev_ = nodes_[head].next_ = head; }
+
+    void PushBack(frame_id_t head, frame_id_t frame_id) {
+        frame_id_t tail = nodes_[head].prev_;
+        nodes_[frame_id].prev_ = tail;
+        nodes_[frame_id].next_ = head;
+        nodes_[tail].next_ = frame_id;
+        nodes_[head].prev_ = frame_id;
+    }
+
+    void Remove(frame_id_t frame_id) {
+        auto &node = nodes_[frame_id];
+        nodes_[node.prev_].next_ = node.next_;
+        nodes_[node.next_].prev_ = node.prev_;
+    }
 };
 
-} // dsbus
\ No newline at end of file
+} // dsbus
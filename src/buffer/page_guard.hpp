@@ -0,0 +1,242 @@
+#pragma once
+
+#include <thread>
+#include <utility>
+
+#include "common/config.h"
+#include "buffer/frame_header.hpp"
+#include "disk/disk_config.h"
+
+namespace dsbus {
+
+/**
+ *  ReadPageGuard keeps a page pinned and its latch held in shared mode.
+ *
+ *  The latch is released and the page unpinned when the guard is destroyed or dropped,
+ *  straight through the frame, without looking the page up again.
+ *  Guards are move only. An empty guard, IsValid() == false, stands for a page that
+ *  could not be fetched.
+ */
+template<typename BufferPool>
+class ReadPageGuard {
+    using PageType = typename BufferPool::PageType;
+public:
+    ReadPageGuard() = default;
+
+    /**
+     *  @brief Latch a page already pinned by bpm, the guard owns that pin from now on.
+     */
+    ReadPageGuard(BufferPool *bpm, PageType *page, const frame_id_t frame_id, FrameHeader *frame)
+                : bpm_(bpm), page_(page), frame_(frame), frame_id_(frame_id) {
+        bpm_->RLockTimed(frame_->latch_);
+    }
+
+    ReadPageGuard(const ReadPageGuard &) = delete;
+    ReadPageGuard &operator=(const ReadPageGuard &) = delete;
+
+    ReadPageGuard(ReadPageGuard &&other) noexcept { Take(other); }
+
+    ReadPageGuard &operator=(ReadPageGuard &&other) noexcept {
+        if (this != &other) {
+            Drop();
+            Take(other);
+        }
+        return *this;
+    }
+
+    ~ReadPageGuard() { Drop(); }
+
+    /**
+     *  @brief Release the latch and unpin the page, the guard becomes empty.
+     */
+    void Drop() {
+        if (page_ == nullptr) return;
+        frame_->latch_.RUnlock();
+        bpm_->UnpinFrame(frame_id_);
+        page_ = nullptr;
+    }
+
+    bool IsValid() const { return page_ != nullptr; }
+
+    page_id_t GetPageId() const { return page_->GetPageId(); }
+
+    const char *GetData() const { return page_->GetData(); }
+
+    const char *GetContent() const { return page_->GetContent(); }
+
+    lsn_t GetLSN() const { return page_->GetLSN(); }
+
+private:
+    BufferPool *bpm_ = nullptr;
+    PageType *page_ = nullptr;
+    FrameHeader *frame_ = nullptr;
+    frame_id_t frame_id_ = 0;
+
+    void Take(ReadPageGuard &other) {
+        bpm_ = other.bpm_;
+        page_ = other.page_;
+        frame_ = other.frame_;
+        frame_id_ = other.frame_id_;
+        other.page_ = nullptr;
+    }
+};
+
+/**
+ *  WritePageGuard keeps a page pinned and its latch held in exclusive mode.
+ *
+ *  Asking for mutable data marks the page dirty, the flag is published to the
+ *  buffer pool before the latch is released.
+ */
+template<typename BufferPool>
+class WritePageGuard {
+    using PageType = typename BufferPool::PageType;
+public:
+    WritePageGuard() = default;
+
+    /**
+     *  @brief Latch a page already pinned by bpm, the guard owns that pin from now on.
+     */
+    WritePageGuard(BufferPool *bpm, PageType *page, const frame_id_t frame_id, FrameHeader *frame)
+                 : bpm_(bpm), page_(page), frame_(frame), frame_id_(frame_id) {
+        bpm_->WLockTimed(frame_->latch_);
+    }
+
+    WritePageGuard(const WritePageGuard &) = delete;
+    WritePageGuard &operator=(const WritePageGuard &) = delete;
+
+    WritePageGuard(WritePageGuard &&other) noexcept { Take(other); }
+
+    WritePageGuard &operator=(WritePageGuard &&other) noexcept {
+        if (this != &other) {
+            Drop();
+            Take(other);
+        }
+        return *this;
+    }
+
+    ~WritePageGuard() { Drop(); }
+
+    /**
+     *  @brief Release the latch and unpin the page, the guard becomes empty.
+     */
+    void Drop() {
+        if (page_ == nullptr) return;
+        if (is_dirty_) frame_->is_dirty_ = true;
+        frame_->latch_.WUnlock();
+        bpm_->UnpinFrame(frame_id_);
+        page_ = nullptr;
+    }
+
+    bool IsValid() const { return page_ != nullptr; }
+
+    page_id_t GetPageId() const { return page_->GetPageId(); }
+
+    const char *GetData() const { return page_->GetData(); }
+
+    const char *GetContent() const { return page_->GetContent(); }
+
+    char *GetDataMut() { is_dirty_ = true; return page_->GetData(); }
+
+    char *GetContentMut() { is_dirty_ = true; return page_->GetContent(); }
+
+    lsn_t GetLSN() const { return page_->GetLSN(); }
+
+    /**
+     *  @brief Record the log record of a change to the page, written before the page is.
+     */
+    void SetLSN(const lsn_t lsn) {
+        is_dirty_ = true;
+        page_->SetLSN(lsn);
+        if (frame_->rec_lsn_.load() == INVALID_LSN) frame_->rec_lsn_ = lsn;
+    }
+
+private:
+    BufferPool *bpm_ = nullptr;
+    PageType *page_ = nullptr;
+    FrameHeader *frame_ = nullptr;
+    frame_id_t frame_id_ = 0;
+    bool is_dirty_ = false;
+
+    void Take(WritePageGuard &other) {
+        bpm_ = other.bpm_;
+        page_ = other.page_;
+        frame_ = other.frame_;
+        frame_id_ = other.frame_id_;
+        is_dirty_ = other.is_dirty_;
+        other.page_ = nullptr;
+    }
+};
+
+/**
+ *  OptimisticReadGuard reads a page without pinning it or taking its latch, through the
+ *  version of the frame latch.
+ *
+ *  The guard remembers the frame of the page and the version last seen. Read runs a reader on
+ *  the page and runs it again until no writer changed the page meanwhile, it writes no shared
+ *  memory: a hot page read through a guard kept around costs no cache line transfer. The
+ *  reader may see the page change under it, so it must only copy out and compute, and bound
+ *  anything it uses as an offset. Changes made without the page latch are not noticed.
+ *
+ *  Nothing keeps the page in its frame. Once it was evicted or deleted, Read returns false and
+ *  the guard becomes empty, the page has to be fetched again. The frame is known to have lost
+ *  the page by its epoch, which holds even for a frame given back by a shrink, whose memory
+ *  reads as zeroes. Guards are copyable.
+ */
+template<typename BufferPool>
+class OptimisticReadGuard {
+    using PageType = typename BufferPool::PageType;
+public:
+    OptimisticReadGuard() = default;
+
+    /**
+     *  @param version of the frame latch, seen while the page was pinned in the frame
+     *  @param epoch of the frame, seen then too
+     */
+    OptimisticReadGuard(PageType *page, FrameHeader *frame, const page_id_t page_id, const uint64_t version,
+                        const uint64_t epoch)
+                      : page_(page), frame_(frame), page_id_(page_id), version_(version), epoch_(epoch) {}
+
+    bool IsValid() const { return page_ != nullptr; }
+
+    page_id_t GetPageId() const { return page_id_; }
+
+    /**
+     *  @brief Run read(const char *content) until it ran on a page no writer changed meanwhile.
+     *  @return false if the frame no longer holds the page, read may then not have run at all
+     */
+    template<typename Body>
+    bool Read(Body read) {
+        while (page_ != nullptr) {
+            auto version = frame_->latch_.GetVersion();
+            if (OptimisticLatch::IsChanging(version)) {
+                std::this_thread::yield();
+                continue;
+            }
+            bool is_same_page = frame_->epoch_.load() == epoch_ && page_->GetPageId() == page_id_;
+            if (is_same_page) read(page_->GetContent());
+            if (!frame_->latch_.Validate(version)) continue;
+            if (!is_same_page) {
+                page_ = nullptr;
+                return false;
+            }
+            version_ = version;
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     *  @brief Returns true if the page is unchanged since the last Read, or since the guard was
+     *         taken, for a reader combining what it read of several pages.
+     */
+    bool Validate() const { return page_ != nullptr && frame_->latch_.Validate(version_); }
+
+private:
+    PageType *page_ = nullptr;
+    FrameHeader *frame_ = nullptr;
+    page_id_t page_id_ = INVALID_PAGE_ID;
+    uint64_t version_ = 0;
+    uint64_t epoch_ = 0;
+};
+
+} // dsbus
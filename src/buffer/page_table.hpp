@@ -0,0 +1,96 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "common/rwlatch.h"
+#include "disk/disk_config.h"
+
+namespace dsbus {
+
+/**
+ *  PageTable maps the page ids resident in a buffer pool to their frame ids.
+ *
+ *  The table is split into shards by page id, each with its own ReaderWriterLatch,
+ *  so lookups of different pages never contend on a single mutex.
+ *  Callers latch the shard themselves, this lets the buffer pool keep a shard latched
+ *  while it pins or evicts the frame it found there.
+ */
+class PageTable {
+public:
+    class alignas(64) Shard {
+    public:
+        ReaderWriterLatch latch_;
+
+        /**
+         *  @brief Look up page_id, the shard latch must be held.
+         *  @param[out] frame_id the frame holding page_id
+         *  @return true if page_id is in this shard
+         */
+        bool Find(const page_id_t page_id, frame_id_t *frame_id) const {
+            auto it = map_.find(page_id);
+            if (it == map_.end()) return false;
+            *frame_id = it->second;
+            return true;
+        }
+
+        /**
+         *  @brief Map page_id to frame_id, the shard latch must be held in write mode.
+         */
+        void Insert(const page_id_t page_id, const frame_id_t frame_id) { map_[page_id] = frame_id; }
+
+        /**
+         *  @brief Remove page_id, the shard latch must be held in write mode.
+         *  @return true if page_id was in this shard
+         */
+        bool Erase(const page_id_t page_id) { return map_.erase(page_id) != 0; }
+
+        /**
+         *  @brief Copy out all entries of this shard, the shard latch must be held.
+         */
+        void Collect(std::vector<std::pair<page_id_t, frame_id_t>> *entries) const {
+            for (auto kv : map_) entries->push_back(kv);
+        }
+
+        size_t Size() const { return map_.size(); }
+
+    private:
+        std::unordered_map<page_id_t, frame_id_t> map_;
+    };
+
+    /**
+     *  @brief Create a page table.
+     *  @param shard_num number of shards, rounded up to a power of two
+     */
+    explicit PageTable(const size_t shard_num = PAGE_TABLE_SHARD_NUM) : shard_num_(1) {
+        while (shard_num_ < shard_num) shard_num_ <<= 1;
+        shards_.reset(new Shard[shard_num_]);
+    }
+
+    /**
+     *  @brief Returns the shard responsible for page_id.
+     */
+    Shard &GetShard(const page_id_t page_id) { return shards_[Hash(page_id) & (shard_num_ - 1)]; }
+
+    /**
+     *  @brief Returns the shard_idx-th shard, for walking the whole table.
+     */
+    Shard &GetShardAt(const size_t shard_idx) { return shards_[shard_idx]; }
+
+    size_t GetShardNum() const { return shard_num_; }
+
+private:
+    size_t shard_num_;
+    std::unique_ptr<Shard[]> shards_;
+
+    // page ids are dense, mix the bits so that neighbouring pages land in different shards
+    // without making every shard see the same low bits.
+    static size_t Hash(const page_id_t page_id) {
+        uint64_t h = (uint64_t)page_id * 0x9E3779B97F4A7C15ULL;
+        return (size_t)(h >> 32);
+    }
+};
+
+} // dsbus
@@ -0,0 +1,252 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/numa.h"
+#include "buffer/buffer_pool_manager.hpp"
+
+namespace dsbus {
+
+/**
+ *  PartitionedBufferPool splits a buffer pool into partitions, each a BufferPoolManager with
+ *  its own frames, page table and replacer, over one Disk.
+ *
+ *  Pages are routed by page id, in extents of extent_page_num pages: extent e belongs to
+ *  partition e % partition_num. A page is only ever cached by its partition, so threads
+ *  working on different partitions share no latch, and each replacer orders a fraction of
+ *  the frames. Read-ahead stays in the extent it starts in, the partition owning the next
+ *  extent reads ahead of its own part of a scan.
+ *
+ *  By default there is one partition per NUMA node, and partition i places its frames on
+ *  node i % node num, so that a thread bound to the node of GetPartitionNode finds the pages
+ *  of that partition in local memory. On a single node machine nothing is bound.
+ *
+ *  Resize splits the new pool size evenly over the partitions, as the max_pool_size_ of
+ *  BufferPoolOptions is split.
+ *
+ *  It offers the surface of BufferPoolManager without access strategies, the guards are those
+ *  of the partitions. GetPartition exposes a partition for the rest. All methods are thread safe.
+ */
+template<size_t page_size, typename Replacer = LRUReplacer, typename Disk = DiskManager>
+class PartitionedBufferPool {
+public:
+    using Partition = BufferPoolManager<page_size, Replacer, Disk>;
+    using PageType = disk::Page<page_size>;
+
+    /**
+     *  @param pool_size frames over all partitions, split evenly.
+     *  @param disk_manager for read write db file.
+     *  @param partition_num one per NUMA node if 0, at most pool_size.
+     *  @param options see BufferPoolOptions, applies to every partition, max_pool_size_ is split.
+     *  @param extent_page_num pages routed together to one partition.
+     */
+    PartitionedBufferPool(const size_t pool_size, Disk *disk_manager, size_t partition_num = 0,
+                          const BufferPoolOptions &options = BufferPoolOptions(),
+                          const size_t extent_page_num = PARTITION_EXTENT_PAGE_NUM)
+                        : disk_manager_(disk_manager), extent_page_num_(std::max<size_t>(1, extent_page_num)) {
+        size_t node_num = numa::GetNodeNum();
+        if (partition_num == 0) partition_num = node_num;
+        partition_num = std::max<size_t>(1, std::min(partition_num, pool_size));
+        for (size_t i = 0; i < partition_num; ++i) {
+            BufferPoolOptions partition_options = options;
+            if (node_num > 1) partition_options.numa_node_ = (int)(i % node_num);
+            // read-ahead past the extent would cache pages of another partition
+            if (partition_num > 1) partition_options.read_ahead_extent_page_num_ = extent_page_num_;
+            size_t partition_size = SplitSize(pool_size, partition_num, i);
+            partition_options.max_pool_size_ = SplitSize(options.max_pool_size_, partition_num, i);
+            partitions_.emplace_back(new Partition(partition_size, disk_manager, partition_options));
+            nodes_.push_back(partitions_.back()->arena_.GetNumaNode());
+        }
+    }
+
+    size_t GetPoolSize() const {
+        size_t pool_size = 0;
+        for (auto &partition : partitions_) pool_size += partition->GetPoolSize();
+        return pool_size;
+    }
+
+    size_t GetMaxPoolSize() const {
+        size_t max_pool_size = 0;
+        for (auto &partition : partitions_) max_pool_size += partition->GetMaxPoolSize();
+        return max_pool_size;
+    }
+
+    /**
+     *  @brief Resize every partition to its share of pool_size, see BufferPoolManager::Resize.
+     *  @return the pool size reached over all partitions
+     */
+    size_t Resize(const size_t pool_size) {
+        size_t new_pool_size = 0;
+        for (size_t i = 0; i < partitions_.size(); ++i) {
+            new_pool_size += partitions_[i]->Resize(SplitSize(pool_size, partitions_.size(), i));
+        }
+        return new_pool_size;
+    }
+
+    size_t GetPartitionNum() const { return partitions_.size(); }
+
+    size_t GetExtentPageNum() const { return extent_page_num_; }
+
+    /**
+     *  @brief Returns the index of the partition caching page_id.
+     */
+    size_t GetPartitionIndex(const page_id_t page_id) const {
+        return (size_t)page_id / extent_page_num_ % partitions_.size();
+    }
+
+    Partition &GetPartition(const size_t index) { return *partitions_[index]; }
+
+    /**
+     *  @brief Returns the NUMA node the frames of partition index were placed on, -1 if none.
+     */
+    int GetPartitionNode(const size_t index) const { return nodes_[index]; }
+
+    /**
+     *  @brief Create a new page in the partition its id routes to.
+     *  @return nullptr if that partition is full
+     */
+    PageType *NewPage() {
+        auto page_id = disk_manager_->AllocatePage();
+        auto &partition = GetPartitionOf(page_id);
+        frame_id_t frame_id;
+        if (!partition.GetFreePage(&frame_id)) {
+            disk_manager_->DeallocatePage(page_id);
+            return nullptr;
+        }
+        return partition.MapNewPage(frame_id, page_id);
+    }
+
+    PageType *FetchPage(const page_id_t page_id) { return GetPartitionOf(page_id).FetchPage(page_id); }
+
+    ReadPageGuard<Partition> FetchPageRead(const page_id_t page_id) {
+        return GetPartitionOf(page_id).FetchPageRead(page_id);
+    }
+
+    PageType *FetchPage(Swip &swip) { return GetPartitionOf(swip.GetPageId()).FetchPage(swip); }
+
+    ReadPageGuard<Partition> FetchPageRead(Swip &swip) { return GetPartitionOf(swip.GetPageId()).FetchPageRead(swip); }
+
+    WritePageGuard<Partition> FetchPageWrite(Swip &swip) {
+        return GetPartitionOf(swip.GetPageId()).FetchPageWrite(swip);
+    }
+
+    void Unswizzle(Swip &swip) { GetPartitionOf(swip.GetPageId()).Unswizzle(swip); }
+
+    OptimisticReadGuard<Partition> FetchPageOptimistic(const page_id_t page_id) {
+        return GetPartitionOf(page_id).FetchPageOptimistic(page_id);
+    }
+
+    WritePageGuard<Partition> FetchPageWrite(const page_id_t page_id) {
+        return GetPartitionOf(page_id).FetchPageWrite(page_id);
+    }
+
+    /**
+     *  @brief Create a new page latched in exclusive mode, it is unpinned when the guard is dropped.
+     *  @return an empty guard if the partition of the page is full
+     */
+    WritePageGuard<Partition> NewPageGuarded() {
+        auto page = NewPage();
+        if (page == nullptr) return WritePageGuard<Partition>();
+        auto &partition = GetPartitionOf(page->GetPageId());
+        frame_id_t frame_id = page - partition.pages_;
+        return WritePageGuard<Partition>(&partition, page, frame_id, &partition.frames_[frame_id]);
+    }
+
+    /**
+     *  @brief Start loading pages [first_page_id, first_page_id + page_num) in the background,
+     *         each extent of the range in its partition.
+     */
+    void Prefetch(const page_id_t first_page_id, const size_t page_num) {
+        auto end_page_id = first_page_id + (page_id_t)page_num;
+        for (auto page_id = first_page_id; page_id < end_page_id;) {
+            auto extent_end = std::min(end_page_id, (page_id / (page_id_t)extent_page_num_ + 1)
+                                                    * (page_id_t)extent_page_num_);
+            GetPartitionOf(page_id).Prefetch(page_id, extent_end - page_id);
+            page_id = extent_end;
+        }
+    }
+
+    bool UnpinPage(const page_id_t page_id, const bool is_dirty) {
+        return GetPartitionOf(page_id).UnpinPage(page_id, is_dirty);
+    }
+
+    bool DeletePage(const page_id_t page_id) {
+        if (page_id < 0) return false;
+        return GetPartitionOf(page_id).DeletePage(page_id);
+    }
+
+    void FlushAllData() {
+        for (auto &partition : partitions_) partition->FlushAllData();
+    }
+
+    /**
+     *  @brief Returns the dirty page table of every partition, see BufferPoolManager.
+     */
+    std::vector<std::pair<page_id_t, lsn_t>> GetDirtyPageTable() {
+        std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+        for (auto &partition : partitions_) {
+            auto partition_dirty_pages = partition->GetDirtyPageTable();
+            dirty_pages.insert(dirty_pages.end(), partition_dirty_pages.begin(), partition_dirty_pages.end());
+        }
+        return dirty_pages;
+    }
+
+    /**
+     *  @brief Sync the Disk shared by the partitions, see BufferPoolManager.
+     */
+    void SyncData() { disk_manager_->Sync(); }
+
+    /**
+     *  @brief Hand each page to the background writer of its partition, see BufferPoolManager.
+     */
+    void DrainDirtyPages(const std::vector<page_id_t> &page_ids) {
+        std::vector<std::vector<page_id_t>> parts(partitions_.size());
+        for (auto page_id : page_ids) parts[GetPartitionIndex(page_id)].push_back(page_id);
+        for (size_t i = 0; i < partitions_.size(); ++i) {
+            if (!parts[i].empty()) partitions_[i]->DrainDirtyPages(parts[i]);
+        }
+    }
+
+    size_t GetDrainPageNum() {
+        size_t page_num = 0;
+        for (auto &partition : partitions_) page_num += partition->GetDrainPageNum();
+        return page_num;
+    }
+
+    /**
+     *  @brief Returns the stats of every partition merged, GetPartition(i).GetStats() has those
+     *         of one, see BufferPoolManager.
+     */
+    BufferPoolStats GetStats() {
+        BufferPoolStats stats;
+        for (auto &partition : partitions_) stats.Merge(partition->GetStats());
+        return stats;
+    }
+
+    /**
+     *  @brief Returns the latch protecting the content of page, which must be pinned.
+     */
+    OptimisticLatch &GetPageLatch(PageType *page) { return GetPartitionOf(page->GetPageId()).GetPageLatch(page); }
+
+private:
+    Disk *disk_manager_;
+    size_t extent_page_num_;
+    std::vector<std::unique_ptr<Partition>> partitions_;
+    // NUMA node of each partition, -1 if not bound
+    std::vector<int> nodes_;
+
+    Partition &GetPartitionOf(const page_id_t page_id) { return *partitions_[GetPartitionIndex(page_id)]; }
+
+    /**
+     *  @brief Returns the share of size of partition index, the first ones take the remainder.
+     */
+    static size_t SplitSize(const size_t size, const size_t partition_num, const size_t index) {
+        return size / partition_num + (index < size % partition_num ? 1 : 0);
+    }
+};
+
+} // dsbus
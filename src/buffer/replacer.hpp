@@ -0,0 +1,61 @@
+#pragma once
+
+#include <type_traits>
+#include <utility>
+
+#include "common/config.h"
+#include "disk/disk_config.h"
+
+namespace dsbus {
+
+/**
+ *  The Replacer concept, the replacement policy a BufferPoolManager is templated on.
+ *
+ *  A replacer tracks frames 0 .. num_pages - 1, all of them free at construction.
+ *
+ *    Replacer(size_t num_pages)
+ *    bool Victim(frame_id_t *frame_id)  evict a free frame first, else the frame chosen by the
+ *                                       policy among unpinned ones, and pin it once.
+ *    void Pin(frame_id_t frame_id)      a user accesses the frame, it can't be victimized.
+ *    void Unpin(frame_id_t frame_id)    a user is done, the frame can be victimized when its
+ *                                       pin count drops to 0. Unpinning a frame that is not
+ *                                       pinned does nothing.
+ *    void RecordAccess(frame_id_t frame_id, size_t access_num)
+ *                                       the pinned frame_id was accessed access_num more times
+ *                                       by users that found it pinned already, and so never
+ *                                       called Pin. Told before the Unpin that releases it.
+ *    void Admit(frame_id_t frame_id, page_id_t page_id)
+ *                                       the victimized frame_id now holds page_id, policies that
+ *                                       remember evicted pages (ghost lists) look it up here.
+ *    size_t Size()                      the number of frames that can be victimized.
+ *    size_t NextVictims(frame_id_t *frame_ids, size_t n)
+ *                                       copy the unpinned frames holding a page that the next
+ *                                       calls to Victim would return, at most n in that order,
+ *                                       without changing any state. Free frames are left out.
+ *    void Free(frame_id_t frame_id)     the pinned frame_id no longer holds a page, it becomes
+ *                                       free and goes before any frame holding one.
+ *    void SetCapacity(size_t frame_num) the pool now uses frames 0 .. frame_num - 1. The frames
+ *                                       it stops using were pinned once and hold no page, they
+ *                                       leave the queues of the policy. Frames it uses again
+ *                                       come back free. Policies sized on the pool follow it.
+ *
+ *  Replacers are not thread safe, the buffer pool serializes calls.
+ */
+template<typename T, typename = void>
+struct IsReplacer : std::false_type {};
+
+template<typename T>
+struct IsReplacer<T, std::void_t<
+        decltype(T(std::declval<size_t>())),
+        decltype(std::declval<bool &>() = std::declval<T &>().Victim(std::declval<frame_id_t *>())),
+        decltype(std::declval<T &>().Pin(std::declval<frame_id_t>())),
+        decltype(std::declval<T &>().Unpin(std::declval<frame_id_t>())),
+        decltype(std::declval<T &>().RecordAccess(std::declval<frame_id_t>(), std::declval<size_t>())),
+        decltype(std::declval<T &>().Admit(std::declval<frame_id_t>(), std::declval<page_id_t>())),
+        decltype(std::declval<size_t &>() = std::declval<T &>().Size()),
+        decltype(std::declval<size_t &>() = std::declval<T &>().NextVictims(std::declval<frame_id_t *>(),
+                                                                             std::declval<size_t>())),
+        decltype(std::declval<T &>().Free(std::declval<frame_id_t>())),
+        decltype(std::declval<T &>().SetCapacity(std::declval<size_t>()))>> : std::true_type {};
+
+} // dsbus
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "disk/disk_config.h"
+#include "disk/disk_page.hpp"
+
+namespace dsbus {
+
+template<size_t page_size, typename Replacer, typename Disk>
+class BufferPoolManager;
+
+/**
+ *  Swip is a reference to a page, as in LeanStore: one 64-bit word holding either the page id,
+ *  or once swizzled a pointer straight to the frame holding the page.
+ *
+ *  Fetching a page through a swip swizzles it, the next fetches go to the frame without
+ *  looking the page up in the page table. Evicting or deleting the page unswizzles the swip
+ *  back to the page id first. A page is swizzled by one swip at a time, fetches through other
+ *  swips of the same page look it up.
+ *
+ *  The buffer pool keeps the address of the swip swizzled to a frame, so a swip does not move,
+ *  and must be unswizzled with BufferPoolManager::Unswizzle before it is destroyed, unless it
+ *  outlives the pool, whose destructor unswizzles it. A swip holds a pointer while swizzled, it
+ *  belongs in memory, not in pages that are written to disk.
+ *
+ *  The word is tagged by its lowest bit, set in pointers to frames, which are aligned.
+ */
+class Swip {
+    template<size_t page_size, typename Replacer, typename Disk>
+    friend class BufferPoolManager;
+public:
+    explicit Swip(const page_id_t page_id = INVALID_PAGE_ID) : word_(EncodePageId(page_id)) {}
+
+    Swip(const Swip &) = delete;
+    Swip &operator=(const Swip &) = delete;
+
+    bool IsSwizzled() const { return IsPointer(word_.load()); }
+
+    /**
+     *  @brief Returns the id of the page, read from the frame if swizzled.
+     */
+    page_id_t GetPageId() const {
+        while (true) {
+            auto word = word_.load();
+            if (!IsPointer(word)) return DecodePageId(word);
+            // the swip is unswizzled before its frame changes, a word still the same after
+            // reading the frame means the frame held the page meanwhile
+            page_id_t page_id;
+            memcpy(&page_id, DecodePointer(word) + disk::OFFSET_PAGE_ID, sizeof(page_id));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (word_.load(std::memory_order_relaxed) == word) return page_id;
+        }
+    }
+
+    /**
+     *  @brief Point the swip to another page, it must not be swizzled.
+     */
+    void SetPageId(const page_id_t page_id) { word_.store(EncodePageId(page_id)); }
+
+private:
+    std::atomic<uint64_t> word_;
+
+    static bool IsPointer(const uint64_t word) { return (word & 1) != 0; }
+
+    static uint64_t EncodePageId(const page_id_t page_id) { return (uint64_t)page_id << 1; }
+
+    static page_id_t DecodePageId(const uint64_t word) { return (page_id_t)word >> 1; }
+
+    static uint64_t EncodePointer(const char *frame) { return (uint64_t)(uintptr_t)frame | 1; }
+
+    static char *DecodePointer(const uint64_t word) { return (char *)(uintptr_t)(word & ~(uint64_t)1); }
+};
+
+} // dsbus
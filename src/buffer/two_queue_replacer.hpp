@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "buffer/frame_list.hpp"
+#include "buffer/ghost_list.hpp"
+#include "disk/disk_config.h"
+
+namespace dsbus {
+/**
+ * TwoQueueReplacer implements the 2Q replacement policy (Johnson & Shasha).
+ *
+ * Newly loaded pages enter A1in, a FIFO holding about a quarter of the frames. Pages evicted
+ * from A1in are remembered in the ghost queue A1out, and only a page loaded again while still
+ * remembered there enters Am, the LRU list of the hot set. A scan thus only cycles through A1in.
+ *
+ * Queues link unpinned frames only, a frame keeps its queue while pinned and rejoins its tail
+ * when unpinned.
+ */
+class TwoQueueReplacer {
+public:
+    /**
+     *  @brief Create a new TwoQueueReplacer.
+     *  @param num_pages the maximum number of pages the TwoQueueReplacer will be required to store
+     *  @param kin A1in size above which it is evicted from first, num_pages / 4 if 0
+     *  @param kout the number of pages remembered by A1out, num_pages / 2 if 0
+     */
+    explicit TwoQueueReplacer(const size_t num_pages, const size_t kin = 0, const size_t kout = 0)
+                             : num_pages_(num_pages), capacity_(num_pages), kin_arg_(kin), kout_arg_(kout),
+                               kin_(kin != 0 ? kin : std::max<size_t>(1, num_pages / 4)),
+                               kout_(kout != 0 ? kout : std::max<size_t>(1, num_pages / 2)),
+                               nodes_(num_pages), lists_(num_pages, 3), a1out_(kout_) {
+        for (size_t i = 0; i < num_pages; ++i) lists_.PushBack(FREE_LIST, (frame_id_t)i);
+    }
+
+    ~TwoQueueReplacer() {}
+
+    /**
+     *  @brief Remove the victim frame as defined by the replacement policy.
+     *         Pin the evicted frame.
+     *  @param[out] frame_id id of frame that was removed
+     *  @return true if a victim frame was found, false otherwise
+     */
+    bool Victim(frame_id_t *frame_id) {
+        if (!lists_.Empty(FREE_LIST)) {
+            *frame_id = lists_.Front(FREE_LIST);
+        } else if (!lists_.Empty(A1IN_LIST) && (a1in_size_ > kin_ || lists_.Empty(AM_LIST))) {
+            *frame_id = lists_.Front(A1IN_LIST);
+            a1out_.PushBack(nodes_[*frame_id].page_id_);
+            while (a1out_.Size() > kout_) a1out_.PopFront();
+        } else if (!lists_.Empty(AM_LIST)) {
+            *frame_id = lists_.Front(AM_LIST);
+        } else {
+            return false;
+        }
+        Take(*frame_id);
+        return true;
+    }
+
+    /**
+     *  @brief Pins a frame, indicating that it should not be victimized until it is unpinned.
+     *  @param frame_id the id of the frame to pin
+     */
+    void Pin(frame_id_t frame_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        if (node.pin_count_ != 0) {
+            ++node.pin_count_;
+        } else if (node.queue_ == FREE_LIST) {
+            Take(frame_id);
+        } else {
+            lists_.Remove(frame_id);
+            node.pin_count_ = 1;
+        }
+    }
+
+    /**
+     *  @brief Unpins a frame, indicating that it can now be victimized.
+     *  @param frame_id the id of the frame to unpin
+     */
+    void Unpin(frame_id_t frame_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        if (node.pin_count_ == 0) return;
+        if (--node.pin_count_ != 0) return;
+        lists_.PushBack(node.queue_, frame_id);
+    }
+
+    /**
+     *  @brief Nothing to record, a frame rejoins the tail of its queue once unpinned and only
+     *         A1out moves a page to Am.
+     */
+    void RecordAccess(frame_id_t frame_id, size_t access_num) {}
+
+    /**
+     *  @brief A page remembered by A1out enters Am, any other page stays in A1in.
+     */
+    void Admit(frame_id_t frame_id, page_id_t page_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        node.page_id_ = page_id;
+        if (node.queue_ == A1IN_LIST && a1out_.Erase(page_id)) {
+            node.queue_ = AM_LIST;
+            --a1in_size_;
+        }
+    }
+
+    /**
+     *  @brief The number of elements in the replacer that can be victimized.
+     */
+    size_t Size() { return lists_.Size(FREE_LIST) + lists_.Size(A1IN_LIST) + lists_.Size(AM_LIST); }
+
+    /**
+     *  @brief Copy the at most n next victims, taken from A1in and Am as Victim would.
+     *
+     *  A frame victimized from A1in starts over in A1in, one from Am moves there, so A1in
+     *  grows by one per Am victim.
+     */
+    size_t NextVictims(frame_id_t *frame_ids, const size_t n) const {
+        std::vector<frame_id_t> a1in(n), am(n);
+        size_t a1in_num = lists_.CopyFront(A1IN_LIST, a1in.data(), n);
+        size_t am_num = lists_.CopyFront(AM_LIST, am.data(), n);
+        size_t a1in_size = a1in_size_;
+        size_t i = 0, j = 0, count = 0;
+        while (count < n && (i < a1in_num || j < am_num)) {
+            if (i < a1in_num && (a1in_size > kin_ || j == am_num)) {
+                frame_ids[count++] = a1in[i++];
+            } else {
+                frame_ids[count++] = am[j++];
+                ++a1in_size;
+            }
+        }
+        return count;
+    }
+
+    /**
+     *  @brief Move a pinned frame that holds no page out of its queue to the free list.
+     */
+    void Free(frame_id_t frame_id) {
+        if (!IsValid(frame_id)) return;
+        auto &node = nodes_[frame_id];
+        if (node.pin_count_ == 0) return;
+        if (node.queue_ == A1IN_LIST) --a1in_size_;
+        node.queue_ = FREE_LIST;
+        node.page_id_ = INVALID_PAGE_ID;
+        node.pin_count_ = 0;
+        lists_.PushBack(FREE_LIST, frame_id);
+    }
+
+    /**
+     *  @brief Frames past frame_num leave their queue, frames used again join the free list.
+     *         The default sizes of A1in and A1out follow the frames used.
+     */
+    void SetCapacity(const size_t frame_num) {
+        auto capacity = std::min(frame_num, num_pages_);
+        for (size_t i = capacity; i < capacity_; ++i) {
+            auto &node = nodes_[i];
+            if (node.queue_ == A1IN_LIST) --a1in_size_;
+            node.queue_ = FREE_LIST;
+            node.page_id_ = INVALID_PAGE_ID;
+        }
+        for (size_t i = capacity_; i < capacity; ++i) Free((frame_id_t)i);
+        capacity_ = capacity;
+        if (kin_arg_ == 0) kin_ = std::max<size_t>(1, capacity / 4);
+        if (kout_arg_ == 0) kout_ = std::max<size_t>(1, capacity / 2);
+        while (a1out_.Size() > kout_) a1out_.PopFront();
+    }
+
+private:
+    static constexpr size_t FREE_LIST = 0;
+    static constexpr size_t A1IN_LIST = 1;
+    static constexpr size_t AM_LIST = 2;
+
+    struct Node {
+        uint32_t pin_count_ = 0;
+        // queue the frame belongs to, FREE_LIST until it is first used
+        uint32_t queue_ = FREE_LIST;
+        page_id_t page_id_ = INVALID_PAGE_ID;
+    };
+
+    size_t num_pages_;
+    // frames the pool uses, see SetCapacity
+    size_t capacity_;
+    // sizes asked for at construction, 0 to follow the capacity
+    size_t kin_arg_;
+    size_t kout_arg_;
+    size_t kin_;
+    size_t kout_;
+    std::vector<Node> nodes_;
+    FrameLists lists_;
+    // number of frames in A1in, pinned ones included
+    size_t a1in_size_ = 0;
+    GhostList a1out_;
+
+    bool IsValid(frame_id_t frame_id) const { return frame_id >= 0 && (size_t)frame_id < num_pages_; }
+
+    /**
+     *  @brief Pin an unpinned frame for a new page, which starts in A1in.
+     */
+    void Take(frame_id_t frame_id) {
+        auto &node = nodes_[frame_id];
+        if (node.queue_ == A1IN_LIST) --a1in_size_;
+        lists_.Remove(frame_id);
+        node.pin_count_ = 1;
+        node.queue_ = A1IN_LIST;
+        node.page_id_ = INVALID_PAGE_ID;
+        ++a1in_size_;
+    }
+};
+
+} // dsbus
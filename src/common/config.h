@@ -1,7 +1,44 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 namespace dsbus {
 
 using frame_id_t = int32_t;
 
-} // dsbus
\ No newline at end of file
+// number of shards of the buffer pool page table, must be a power of two
+static constexpr size_t PAGE_TABLE_SHARD_NUM = 16;
+
+// number of accesses remembered per frame by LRUKReplacer
+static constexpr size_t LRUK_REPLACER_K = 2;
+
+// default number of frames in the ring of a buffer access strategy, at most 1/8 of the pool is used
+static constexpr size_t SEQUENTIAL_SCAN_RING_SIZE = 32;
+static constexpr size_t BULK_WRITE_RING_SIZE = 256;
+
+// defaults of the background writer of the buffer pool, see BufferPoolOptions
+static constexpr size_t BG_WRITER_INTERVAL_MS = 10;
+static constexpr size_t BG_WRITER_MAX_PAGES = 64;
+static constexpr size_t BG_WRITER_LOW_WATERMARK = 16;
+static constexpr size_t BG_WRITER_HIGH_WATERMARK = 64;
+
+// default number of pages loaded ahead of a sequential read, see BufferPoolOptions
+static constexpr size_t READ_AHEAD_PAGE_NUM = 32;
+
+// size of the huge pages backing large frame arenas, see HugePageMode
+static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+
+// pages of an extent of a PartitionedBufferPool, extents are spread over the partitions
+static constexpr size_t PARTITION_EXTENT_PAGE_NUM = 64;
+
+// frames a buffer pool shrink releases at a time, see BufferPoolManager::Resize
+static constexpr size_t RESIZE_CHUNK_FRAME_NUM = 1024;
+
+// number of dirty pages FlushAllData copies out before writing them in one batch
+static constexpr size_t FLUSH_BATCH_PAGE_NUM = 256;
+
+// slots of StripedCounters, threads beyond this number share slots
+static constexpr size_t STATS_SLOT_NUM = 32;
+
+} // dsbus
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace dsbus {
+
+/**
+ *  CRC32C, the CRC with the Castagnoli polynomial, as used by iSCSI, ext4 and RocksDB.
+ *
+ *  On x86-64 CPUs with SSE4.2 it runs on the crc32 instruction, in three independent streams
+ *  so that the latency of the instruction is hidden, then the three CRCs are combined. Other
+ *  CPUs use tables, slicing 8 bytes at a time.
+ */
+namespace crc32c {
+
+// the Castagnoli polynomial, reflected
+static constexpr uint32_t POLY = 0x82f63b78;
+// bytes per stream of one round of the three stream loop
+static constexpr size_t LONG_LANE_SIZE = 8192;
+static constexpr size_t SHORT_LANE_SIZE = 256;
+
+/**
+ *  @brief Multiply a and b modulo POLY, polynomials stored reflected.
+ */
+inline uint32_t MultModP(uint32_t a, uint32_t b) {
+    uint32_t m = (uint32_t)1 << 31;
+    uint32_t p = 0;
+    while (true) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) break;
+        }
+        m >>= 1;
+        b = b & 1 ? (b >> 1) ^ POLY : b >> 1;
+    }
+    return p;
+}
+
+/**
+ *  @brief Returns x^(8 * size) modulo POLY, which shifts a CRC over size zero bytes.
+ */
+inline uint32_t ZerosOperator(size_t size) {
+    // x^1, squared into x^2, x^4, ... while walking the bits of 8 * size
+    uint32_t square = (uint32_t)1 << 30;
+    uint32_t p = (uint32_t)1 << 31;
+    for (size_t n = size * 8; n != 0; n >>= 1) {
+        if (n & 1) p = MultModP(square, p);
+        square = MultModP(square, square);
+    }
+    return p;
+}
+
+struct Tables {
+    // byte_[k][b] is the CRC of byte b followed by k zero bytes
+    uint32_t byte_[8][256];
+    // shift a CRC over a lane, one table per byte of the CRC
+    uint32_t long_shift_[4][256];
+    uint32_t short_shift_[4][256];
+
+    Tables() {
+        for (uint32_t b = 0; b < 256; ++b) {
+            uint32_t crc = b;
+            for (int i = 0; i < 8; ++i) crc = crc & 1 ? (crc >> 1) ^ POLY : crc >> 1;
+            byte_[0][b] = crc;
+        }
+        for (uint32_t b = 0; b < 256; ++b) {
+            for (int k = 1; k < 8; ++k) byte_[k][b] = (byte_[k - 1][b] >> 8) ^ byte_[0][byte_[k - 1][b] & 0xff];
+        }
+        uint32_t long_op = ZerosOperator(LONG_LANE_SIZE);
+        uint32_t short_op = ZerosOperator(SHORT_LANE_SIZE);
+        for (uint32_t b = 0; b < 256; ++b) {
+            for (int k = 0; k < 4; ++k) {
+                long_shift_[k][b] = MultModP(long_op, b << (8 * k));
+                short_shift_[k][b] = MultModP(short_op, b << (8 * k));
+            }
+        }
+    }
+};
+
+inline const Tables &GetTables() {
+    static const Tables tables;
+    return tables;
+}
+
+inline uint32_t Shift(const uint32_t table[4][256], uint32_t crc) {
+    return table[0][crc & 0xff] ^ table[1][(crc >> 8) & 0xff] ^ table[2][(crc >> 16) & 0xff] ^ table[3][crc >> 24];
+}
+
+inline uint64_t Load64(const unsigned char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+ *  @brief Table driven CRC of the register crc, no pre or post conditioning.
+ */
+inline uint32_t ExtendSoftware(uint32_t crc, const unsigned char *data, size_t size) {
+    auto &t = GetTables().byte_;
+    for (; size != 0 && (uintptr_t)data % 8 != 0; --size) crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xff];
+    for (; size >= 8; size -= 8, data += 8) {
+        uint64_t v = Load64(data) ^ crc;
+        crc = t[7][v & 0xff] ^ t[6][(v >> 8) & 0xff] ^ t[5][(v >> 16) & 0xff] ^ t[4][(v >> 24) & 0xff]
+            ^ t[3][(v >> 32) & 0xff] ^ t[2][(v >> 40) & 0xff] ^ t[1][(v >> 48) & 0xff] ^ t[0][v >> 56];
+    }
+    for (; size != 0; --size) crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xff];
+    return crc;
+}
+
+#if defined(__x86_64__)
+/**
+ *  @brief Run three streams of the crc32 instruction, each over a lane, while size holds three
+ *         lanes. Lanes 0 and 1 are then shifted over the lanes after them and combined.
+ */
+__attribute__((target("sse4.2")))
+inline void ExtendLanes(uint64_t &crc, const unsigned char *&data, size_t &size, const size_t lane_size,
+                        const uint32_t shift[4][256]) {
+    while (size >= 3 * lane_size) {
+        uint64_t crc1 = 0;
+        uint64_t crc2 = 0;
+        const unsigned char *end = data + lane_size;
+        do {
+            crc = _mm_crc32_u64(crc, Load64(data));
+            crc1 = _mm_crc32_u64(crc1, Load64(data + lane_size));
+            crc2 = _mm_crc32_u64(crc2, Load64(data + 2 * lane_size));
+            data += 8;
+        } while (data < end);
+        crc = Shift(shift, (uint32_t)crc) ^ crc1;
+        crc = Shift(shift, (uint32_t)crc) ^ crc2;
+        data += 2 * lane_size;
+        size -= 3 * lane_size;
+    }
+}
+
+/**
+ *  @brief CRC of the register crc on the crc32 instruction, no pre or post conditioning.
+ */
+__attribute__((target("sse4.2")))
+inline uint32_t ExtendHardware(uint32_t crc, const unsigned char *data, size_t size) {
+    auto &tables = GetTables();
+    uint64_t crc0 = crc;
+    for (; size != 0 && (uintptr_t)data % 8 != 0; --size) crc0 = _mm_crc32_u8((uint32_t)crc0, *data++);
+    ExtendLanes(crc0, data, size, LONG_LANE_SIZE, tables.long_shift_);
+    ExtendLanes(crc0, data, size, SHORT_LANE_SIZE, tables.short_shift_);
+    for (; size >= 8; size -= 8, data += 8) crc0 = _mm_crc32_u64(crc0, Load64(data));
+    for (; size != 0; --size) crc0 = _mm_crc32_u8((uint32_t)crc0, *data++);
+    return (uint32_t)crc0;
+}
+
+inline bool HasHardware() {
+    static const bool has_hardware = __builtin_cpu_supports("sse4.2");
+    return has_hardware;
+}
+#else
+inline uint32_t ExtendHardware(uint32_t crc, const unsigned char *data, size_t size) {
+    return ExtendSoftware(crc, data, size);
+}
+
+inline bool HasHardware() { return false; }
+#endif
+
+} // crc32c
+
+/**
+ *  @brief Returns the CRC32C of data, extending crc, the CRC32C of the bytes before.
+ */
+inline uint32_t Crc32c(const char *data, const size_t size, const uint32_t crc = 0) {
+    auto bytes = (const unsigned char *)data;
+    return ~(crc32c::HasHardware() ? crc32c::ExtendHardware(~crc, bytes, size)
+                                   : crc32c::ExtendSoftware(~crc, bytes, size));
+}
+
+} // dsbus
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace dsbus {
+
+/**
+ *  NUMA topology and memory placement, on the system calls directly so that no libnuma is
+ *  needed. Machines or kernels without NUMA look like a single node 0.
+ */
+namespace numa {
+
+/**
+ *  @brief Returns one past the highest online NUMA node.
+ */
+inline size_t GetNodeNum() {
+    static const size_t node_num = []() {
+        // a list of ranges such as "0" or "0-1,3", the last number is the highest node
+        FILE *online = fopen("/sys/devices/system/node/online", "r");
+        if (online == nullptr) return (size_t)1;
+        size_t node = 0;
+        int c;
+        while ((c = fgetc(online)) != EOF) {
+            if (c >= '0' && c <= '9') {
+                node = node * 10 + (c - '0');
+            } else if (c == '-' || c == ',') {
+                node = 0;
+            }
+        }
+        fclose(online);
+        return node + 1;
+    }();
+    return node_num;
+}
+
+/**
+ *  @brief Returns the NUMA node of the CPU the calling thread runs on, 0 if unknown.
+ */
+inline int GetCurrentNode() {
+    unsigned cpu = 0;
+    unsigned node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0) return 0;
+    return (int)node;
+}
+
+/**
+ *  @brief Place the memory pages of [data, data + size) on node, moving those already there.
+ *
+ *  data must be aligned to the memory page, and size a multiple of it.
+ *
+ *  @return false if the kernel refused, the memory then stays where the policy of the process
+ *          puts it
+ */
+inline bool BindMemory(void *data, const size_t size, const int node) {
+    if (node < 0 || (size_t)node >= GetNodeNum()) return false;
+    const size_t word_bits = 8 * sizeof(unsigned long);
+    std::vector<unsigned long> mask(node / word_bits + 1, 0);
+    mask[node / word_bits] = 1UL << (node % word_bits);
+    // the kernel reads one bit less than maxnode
+    return syscall(SYS_mbind, data, size, MPOL_BIND, mask.data(), mask.size() * word_bits + 1, MPOL_MF_MOVE) == 0;
+}
+
+} // numa
+
+} // dsbus
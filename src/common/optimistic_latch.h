@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+
+namespace dsbus {
+
+/**
+ *  OptimisticLatch is a reader-writer latch with a version counter, as the hybrid latches of
+ *  LeanStore and Umbra.
+ *
+ *  Writers lock it exclusively like a ReaderWriterLatch. The version is odd while a writer
+ *  holds it, and moves on by 2 with every exclusive section. Optimistic readers take no lock:
+ *  they sample the version with GetVersion, read, then Validate the version. Their read counts
+ *  only if the version did not move, a writer may have torn it otherwise. They write no shared
+ *  memory, so data read far more often than written keeps its cache lines shared by every
+ *  core. Readers that can't retry lock it in shared mode.
+ *
+ *  BeginChange / EndChange move the version without locking, for an owner keeping writers out
+ *  by other means.
+ */
+class OptimisticLatch {
+public:
+    void WLock() {
+        mutex_.lock();
+        BeginChange();
+    }
+
+    void WUnlock() {
+        EndChange();
+        mutex_.unlock();
+    }
+
+    /**
+     *  @brief Lock exclusively if nobody holds the latch, without waiting.
+     */
+    bool TryWLock() {
+        if (!mutex_.try_lock()) return false;
+        BeginChange();
+        return true;
+    }
+
+    void RLock() { mutex_.lock_shared(); }
+
+    bool TryRLock() { return mutex_.try_lock_shared(); }
+
+    void RUnlock() { mutex_.unlock_shared(); }
+
+    /**
+     *  @brief Make the version odd, before changing the protected data.
+     */
+    void BeginChange() { version_.fetch_add(1, std::memory_order_acq_rel); }
+
+    /**
+     *  @brief Make the version even again, once the change is done.
+     */
+    void EndChange() { version_.fetch_add(1, std::memory_order_release); }
+
+    /**
+     *  @brief Returns the version to validate an optimistic read against, odd if a change is
+     *         in progress, and the read bound to fail.
+     */
+    uint64_t GetVersion() const { return version_.load(std::memory_order_acquire); }
+
+    static bool IsChanging(const uint64_t version) { return (version & 1) != 0; }
+
+    /**
+     *  @brief Returns true if nothing changed since version was sampled, so that what was read
+     *         in between is consistent.
+     */
+    bool Validate(const uint64_t version) const {
+        // keep the reads of the data before the second read of the version
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return version_.load(std::memory_order_relaxed) == version;
+    }
+
+private:
+    std::shared_mutex mutex_;
+    std::atomic<uint64_t> version_{0};
+};
+
+} // dsbus
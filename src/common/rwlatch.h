@@ -20,6 +20,11 @@ class ReaderWriterLatch {
    */
   void WUnlock() { mutex_.unlock(); }
 
+  /**
+   * Acquire a write latch if it is free, without waiting.
+   */
+  bool TryWLock() { return mutex_.try_lock(); }
+
   /**
    * Acquire a read latch.
    */
@@ -30,6 +35,11 @@ class ReaderWriterLatch {
    */
   void RUnlock() { mutex_.unlock_shared(); }
 
+  /**
+   * Acquire a read latch if no writer holds it, without waiting.
+   */
+  bool TryRLock() { return mutex_.try_lock_shared(); }
+
  private:
   std::shared_mutex mutex_;
 };
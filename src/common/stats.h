@@ -0,0 +1,137 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "common/config.h"
+
+namespace dsbus {
+
+/**
+ *  @brief Returns a monotonic time in nanoseconds, to measure latencies with.
+ */
+inline uint64_t NowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ *  StripedCounters is a fixed set of event counters cheap enough for hot paths.
+ *
+ *  Each thread adds to a slot of its own, a cache line apart from the others, with relaxed
+ *  atomics: counting costs an uncontended add, and never bounces a line between cores. Threads
+ *  share slots round robin beyond STATS_SLOT_NUM. Get sums the slots on demand, counts added
+ *  concurrently may or may not be seen.
+ */
+template<size_t counter_num>
+class StripedCounters {
+public:
+    void Add(const size_t counter, const uint64_t value = 1) {
+        slots_[GetSlotIndex()].counters_[counter].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t Get(const size_t counter) const {
+        uint64_t sum = 0;
+        for (auto &slot : slots_) sum += slot.counters_[counter].load(std::memory_order_relaxed);
+        return sum;
+    }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> counters_[counter_num] = {};
+    };
+
+    Slot slots_[STATS_SLOT_NUM];
+
+    static size_t GetSlotIndex() {
+        static std::atomic<size_t> next_slot_index{0};
+        // constant initialized, so that reading it needs no guard of a dynamic initialization
+        thread_local size_t slot_index = STATS_SLOT_NUM;
+        if (slot_index == STATS_SLOT_NUM) slot_index = next_slot_index.fetch_add(1) % STATS_SLOT_NUM;
+        return slot_index;
+    }
+};
+
+/**
+ *  A copy of a LatencyHistogram, bucket i counts latencies of [2^(i-1), 2^i) ns, bucket 0 those
+ *  of 0 ns, and the last bucket everything above.
+ */
+struct LatencySnapshot {
+    static constexpr size_t BUCKET_NUM = 40;
+
+    uint64_t count_ = 0;
+    uint64_t sum_nanos_ = 0;
+    uint64_t max_nanos_ = 0;
+    uint64_t buckets_[BUCKET_NUM] = {};
+
+    double GetMeanNanos() const { return count_ == 0 ? 0 : (double)sum_nanos_ / count_; }
+
+    /**
+     *  @brief Returns an upper bound of the latency under which a fraction of the samples fall,
+     *         the end of the bucket it is reached in.
+     *  @param fraction in [0, 1], 0.99 for the 99th percentile
+     */
+    uint64_t GetPercentileNanos(const double fraction) const {
+        if (count_ == 0) return 0;
+        auto rank = std::max<uint64_t>(1, (uint64_t)(fraction * count_ + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_NUM; ++i) {
+            seen += buckets_[i];
+            if (seen >= rank) return std::min(max_nanos_, i == 0 ? 0 : ((uint64_t)1 << i) - 1);
+        }
+        return max_nanos_;
+    }
+
+    void Merge(const LatencySnapshot &other) {
+        count_ += other.count_;
+        sum_nanos_ += other.sum_nanos_;
+        max_nanos_ = std::max(max_nanos_, other.max_nanos_);
+        for (size_t i = 0; i < BUCKET_NUM; ++i) buckets_[i] += other.buckets_[i];
+    }
+};
+
+/**
+ *  LatencyHistogram records latencies in power of two buckets, with relaxed atomics, for events
+ *  slow enough that a shared cache line does not matter, such as I/O.
+ */
+class LatencyHistogram {
+public:
+    void Record(const uint64_t nanos) {
+        auto bucket = nanos == 0 ? 0 : std::min<size_t>(64 - __builtin_clzll(nanos), LatencySnapshot::BUCKET_NUM - 1);
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_nanos_.fetch_add(nanos, std::memory_order_relaxed);
+        auto max_nanos = max_nanos_.load(std::memory_order_relaxed);
+        while (nanos > max_nanos && !max_nanos_.compare_exchange_weak(max_nanos, nanos, std::memory_order_relaxed)) {}
+    }
+
+    /**
+     *  @brief Record the time elapsed since start, taken with NowNanos.
+     */
+    void RecordSince(const uint64_t start) { Record(NowNanos() - start); }
+
+    /**
+     *  @brief Returns a copy of the histogram, samples recorded concurrently may be half in it.
+     */
+    LatencySnapshot GetSnapshot() const {
+        LatencySnapshot snapshot;
+        snapshot.count_ = count_.load(std::memory_order_relaxed);
+        snapshot.sum_nanos_ = sum_nanos_.load(std::memory_order_relaxed);
+        snapshot.max_nanos_ = max_nanos_.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < LatencySnapshot::BUCKET_NUM; ++i) {
+            snapshot.buckets_[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+private:
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_nanos_{0};
+    std::atomic<uint64_t> max_nanos_{0};
+    std::atomic<uint64_t> buckets_[LatencySnapshot::BUCKET_NUM] = {};
+};
+
+} // dsbus
@@ -1,7 +1,30 @@
 #pragma once
+
+#include <cstddef>
+#include <cstdint>
+
 namespace dsbus {
 
-using page_id_t = int32_t;
-static constexpr int32_t INVALID_PAGE_ID = -1; 
+// 64 bits, a tablespace may outgrow what 32 bit page ids address
+using page_id_t = int64_t;
+static constexpr page_id_t INVALID_PAGE_ID = -1;
+
+// log sequence number, the offset of a log record in the log file, see LogManager
+using lsn_t = int64_t;
+static constexpr lsn_t INVALID_LSN = -1;
+
+// alignment of file offsets, sizes and buffers of O_DIRECT I/O, and of buffer pool frames
+static constexpr size_t DIRECT_IO_ALIGNMENT = 4096;
+
+// initial capacity in pages of the file and the mapping of MMapDiskManager
+static constexpr size_t MMAP_MIN_PAGE_NUM = 16;
+
+// pages of a tablespace extent, the unit in which pages are striped over its segment files
+static constexpr size_t TABLESPACE_EXTENT_PAGE_NUM = 64;
+
+// submission queue entries of the io_uring engine of DiskManager
+static constexpr unsigned IO_ENGINE_QUEUE_DEPTH = 128;
+// worker threads of the thread pool engine used where io_uring is not available
+static constexpr size_t IO_ENGINE_THREAD_NUM = 4;
 
-} // dsbus
\ No newline at end of file
+} // dsbus
@@ -1,19 +1,69 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
-#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "slice/slice.hpp"
 #include "disk/disk_config.h"
 #include "disk/disk_page.hpp"
+#include "disk/free_page_list.hpp"
+#include "disk/io_engine.hpp"
+#include "disk/io_uring_engine.hpp"
+#include "disk/thread_pool_io_engine.hpp"
 
 namespace dsbus {
 
+struct DiskManagerOptions {
+    // open the file with O_DIRECT, bypassing the kernel page cache. Needs a page size
+    // multiple of DIRECT_IO_ALIGNMENT and a file system supporting it, else ignored.
+    bool direct_io_ = false;
+    // keep a CRC32C of each page in its header, set by writes and verified by reads, see
+    // disk::PAGE_HEADER_SIZE. Needs pages larger than the header, else ignored.
+    bool checksum_ = false;
+};
+
 /**
  *  DiskManager takes care of the allocation and deallocation of pages within a storage engine. It performs the reading and
  *  writing of pages to and from disk, providing a logical file layer within the context of a storage engine.
  *  
- *  Now one DiskManager instance only support manage single file.
- *  Structure: HeaderPage(16B) + Page * N
+ *  One DiskManager instance manages a single file, TablespaceManager spreads pages over several.
+ *  Structure: HeaderPage(4KB) + Page * N
+ *
+ *  All methods are thread safe. Pages are read and written with pread / pwrite at their own
+ *  offset, there is no shared file cursor, so I/O on different pages runs in parallel.
+ *  ReadPages / WritePages take a batch of pages and transfer each run of consecutive page ids
+ *  with a single preadv / pwritev.
+ *
+ *  ReadPageAsync / WritePageAsync run page I/O on an IOEngine instead, io_uring where the
+ *  kernel allows it, a pool of pread / pwrite threads otherwise, so many pages can be in
+ *  flight at once. ReadPagesAsync hands a batch of reads to the engine together. The engine
+ *  is started by the first asynchronous request. As for the synchronous methods, an I/O
+ *  error is fatal.
+ *
+ *  AllocatePage hands out page ids, reusing pages given back by DeallocatePage before growing
+ *  the file. Free pages at the end of the file are cut off. The free pages are kept in a
+ *  FreePageList, stored in the file by ShutDown.
+ *
+ *  With checksums, every page written gets a CRC32C in its header, and every page read is
+ *  checked against it. A mismatch, e.g. a torn write, is reported and counted, the page is
+ *  still returned. Pages with no checksum, never written or written without checksums, are
+ *  not checked. Writes without checksums clear the checksum field, so that a page read while
+ *  checksums were on and changed since is not found corrupt once they are on again.
+ *
+ *  In direct I/O mode pages bypass the kernel page cache. Buffers should then be aligned to
+ *  DIRECT_IO_ALIGNMENT, as buffer pool frames are, others are copied through an aligned one.
  *  
  */
 class DiskManager {
@@ -23,81 +73,477 @@ public:
      *  
      *  @param db_file_name db file path.
      *  @param page_size the size of page in the db file.
+     *  @param options see DiskManagerOptions.
      */
-    DiskManager(const Slice &db_file_name, const size_t page_size) : db_file_name_(db_file_name) {
-        db_io_.open(db_file_name.Data(), std::ios::binary | std::ios::in | std::ios::out);
+    DiskManager(const Slice &db_file_name, const size_t page_size,
+                const DiskManagerOptions &options = DiskManagerOptions()) : db_file_name_(db_file_name) {
+        db_fd_ = open(db_file_name.Data(), O_RDWR);
         // directory or file does not exist
-        if (!db_io_.is_open()) {
-            db_io_.clear();
+        if (db_fd_ < 0) {
             // create a new file
-            db_io_.open(db_file_name.Data(), std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-            if (!db_io_.is_open()) {
+            db_fd_ = open(db_file_name.Data(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (db_fd_ < 0) {
                 std::cerr << "can't open db file" << std::endl;
                 exit(0);
             }
             header_page_.page_num_ = 0;
             header_page_.page_size_ = page_size;
             WriteHeaderPage();
-            return;
+        } else {
+            ReadHeaderPage();
+        }
+        page_num_ = header_page_.page_num_;
+        // the header is written on ShutDown, pages written past its page count before a crash
+        // are still in the file
+        off_t file_size = lseek(db_fd_, 0, SEEK_END);
+        if (file_size > (off_t)disk::DISK_HEADER_PAGE_SIZE) {
+            size_t file_page_num = (file_size - disk::DISK_HEADER_PAGE_SIZE) / header_page_.page_size_;
+            page_num_ = std::max<size_t>(page_num_, file_page_num);
+        }
+        if (options.direct_io_ && header_page_.page_size_ % DIRECT_IO_ALIGNMENT == 0) {
+            // reopen, the file system may refuse O_DIRECT
+            int direct_fd = open(db_file_name.Data(), O_RDWR | O_DIRECT);
+            if (direct_fd >= 0) {
+                close(db_fd_);
+                db_fd_ = direct_fd;
+                direct_io_ = true;
+            }
+        }
+        checksum_ = options.checksum_ && header_page_.page_size_ > disk::PAGE_HEADER_SIZE;
+        LoadFreePages();
+    }
+
+    ~DiskManager() {
+        ShutDown();
+        io_engine_.reset();
+        close(db_fd_);
+    }
+
+    /**
+     *  @brief Wait for asynchronous requests, then store the free pages and write the header.
+     *
+     *  The file stays open until the DiskManager is destroyed, pages written afterwards,
+     *  e.g. flushed by a buffer pool destroyed later, still reach the file and the header
+     *  is written again on destruction.
+     */
+    void ShutDown() {
+        if (io_engine_ != nullptr) io_engine_->Drain();
+        std::lock_guard<std::mutex> guard(free_latch_);
+        auto write_page = [this](page_id_t page_id, const char *data) { WritePage(page_id, data); };
+        header_page_.free_list_head_ = free_pages_.Store(header_page_.page_size_, write_page);
+        header_page_.free_page_num_ = header_page_.free_list_head_ == INVALID_PAGE_ID ? 0 : free_pages_.Size();
+        WriteHeaderPage();
+    }
+
+    /**
+     *  @brief Returns a page id to write a new page to, the lowest free page if any.
+     */
+    page_id_t AllocatePage() {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        if (!free_pages_.Empty()) return free_pages_.Allocate();
+        // pages may have been written without being allocated
+        next_page_id_ = std::max(next_page_id_, page_num_.load());
+        return (page_id_t)next_page_id_++;
+    }
+
+    /**
+     *  @brief Give back a page, which must not be read or written until allocated again.
+     *
+     *  Free pages ending the file are cut off it. The header is made durable with the lower page
+     *  count first, a crash must not reopen the file with pages it no longer holds.
+     */
+    void DeallocatePage(page_id_t page_id) {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        if (free_pages_.Contains(page_id)) return;
+        free_pages_.Insert(page_id);
+        next_page_id_ = free_pages_.Trim(std::max(next_page_id_, page_num_.load()));
+        if (next_page_id_ < page_num_.load()) {
+            page_num_ = next_page_id_;
+            WriteHeaderPage();
+            Sync();
+            if (ftruncate(db_fd_, GetPageOffset((page_id_t)next_page_id_)) != 0) {
+                std::cerr << "I/O error while truncating" << std::endl;
+                exit(0);
+            }
         }
-        ReadHeaderPage();
     }
 
-    ~DiskManager() { ShutDown(); }
+    bool IsFreePage(page_id_t page_id) {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        return free_pages_.Contains(page_id);
+    }
 
-    void ShutDown() { WriteHeaderPage(); db_io_.close(); }
+    size_t GetFreePageNum() {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        return free_pages_.Size();
+    }
 
     void ReadPage(page_id_t page_id, char *page_data) {
-        size_t offset = disk::DISK_HEADER_PAGE_SIZE + (size_t)page_id * header_page_.page_size_;
-        ReadDisk(offset, page_data, header_page_.page_size_);
+        ReadDisk(GetPageOffset(page_id), page_data, header_page_.page_size_);
+        VerifyChecksum(page_id, page_data);
     }
 
     void WritePage(page_id_t page_id, const char *page_data) {
-        size_t offset = disk::DISK_HEADER_PAGE_SIZE + (size_t)page_id * header_page_.page_size_;
-        WriteDisk(offset, page_data, header_page_.page_size_);
-        // update header_page_.page_num_, but not flush to disk immediately.
-        header_page_.page_num_ = header_page_.page_num_ > (size_t)page_id ? header_page_.page_num_ : page_id + 1;
+        if (NeedsChecksumCopy(page_data)) {
+            char *buf = CopyForWrite(page_data);
+            WriteDisk(GetPageOffset(page_id), buf, header_page_.page_size_);
+            free(buf);
+        } else {
+            WriteDisk(GetPageOffset(page_id), page_data, header_page_.page_size_);
+        }
+        // update page_num_, but not flush to disk immediately.
+        GrowPageNum(page_id);
+    }
+
+    /**
+     *  @brief Read a batch of pages, each pair is a page id and the buffer receiving it.
+     */
+    void ReadPages(std::vector<std::pair<page_id_t, char *>> pages) {
+        for (auto &page : pages) CheckReadRange(GetPageOffset(page.first), header_page_.page_size_);
+        TransferPages(false, pages);
+        for (auto &page : pages) VerifyChecksum(page.first, page.second);
     }
 
+    /**
+     *  @brief Write a batch of pages, each pair is a page id and the buffer holding it.
+     */
+    void WritePages(std::vector<std::pair<page_id_t, const char *>> pages) {
+        std::vector<std::pair<page_id_t, char *>> buffers;
+        buffers.reserve(pages.size());
+        for (auto &page : pages) buffers.emplace_back(page.first, const_cast<char *>(page.second));
+        TransferPages(true, buffers);
+        for (auto &page : pages) GrowPageNum(page.first);
+    }
+
+    /**
+     *  @brief Make the pages written so far durable, asynchronous writes not completed yet excepted.
+     */
+    void Sync() {
+        if (fdatasync(db_fd_) != 0) {
+            std::cerr << "I/O error while syncing" << std::endl;
+            exit(0);
+        }
+    }
+
+    /**
+     *  @brief Read a page asynchronously, page_data must stay valid until callback has run.
+     *
+     *  A page past the end of the file, e.g. cut off by DeallocatePage since the caller looked,
+     *  is not an error: page_data is left as it is and callback runs all the same, so that
+     *  prefetches racing with a trim are dropped by their caller instead of ending the process.
+     *
+     *  @param callback run on an I/O thread once page_data holds the page
+     */
+    void ReadPageAsync(page_id_t page_id, char *page_data, std::function<void()> callback) {
+        StartRead(page_id, page_data, std::move(callback), false);
+    }
+
+    /**
+     *  @brief Read a batch of pages asynchronously, each pair is a page id and the buffer
+     *         receiving it, which must stay valid until its callback has run.
+     *
+     *  The reads are queued on the engine and started together, in one io_uring_enter on
+     *  io_uring. Pages past the end of the file are left as they are, as for ReadPageAsync.
+     *
+     *  @param callback run on an I/O thread with the index of each page in pages once it is read
+     */
+    void ReadPagesAsync(const std::vector<std::pair<page_id_t, char *>> &pages, std::function<void(size_t)> callback) {
+        auto shared_callback = std::make_shared<std::function<void(size_t)>>(std::move(callback));
+        for (size_t i = 0; i < pages.size(); ++i) {
+            StartRead(pages[i].first, pages[i].second, [shared_callback, i]() { (*shared_callback)(i); }, true);
+        }
+        GetIOEngine()->Flush();
+    }
+
+    /**
+     *  @brief Write a page asynchronously, page_data must stay valid until callback has run.
+     *  @param callback run on an I/O thread once the page is written
+     */
+    void WritePageAsync(page_id_t page_id, const char *page_data, std::function<void()> callback) {
+        GrowPageNum(page_id);
+        char *buf = const_cast<char *>(page_data);
+        if (NeedsChecksumCopy(page_data)) {
+            buf = CopyForWrite(page_data);
+        } else if (NeedsBounce(page_data)) {
+            buf = AllocateAligned(header_page_.page_size_);
+            memcpy(buf, page_data, header_page_.page_size_);
+        }
+        GetIOEngine()->SubmitWrite(db_fd_, buf, header_page_.page_size_, GetPageOffset(page_id),
+                                   [size = header_page_.page_size_, buf, page_data, callback](ssize_t result) {
+            if (result != (ssize_t)size) {
+                std::cerr << "I/O error while writing" << std::endl;
+                exit(0);
+            }
+            if (buf != page_data) free(buf);
+            if (callback) callback();
+        });
+    }
+
+    /**
+     *  @brief Read a page asynchronously, the future is ready once page_data holds the page.
+     */
+    std::future<void> ReadPageAsync(page_id_t page_id, char *page_data) {
+        auto promise = std::make_shared<std::promise<void>>();
+        auto future = promise->get_future();
+        ReadPageAsync(page_id, page_data, [promise]() { promise->set_value(); });
+        return future;
+    }
+
+    /**
+     *  @brief Write a page asynchronously, the future is ready once the page is written.
+     */
+    std::future<void> WritePageAsync(page_id_t page_id, const char *page_data) {
+        auto promise = std::make_shared<std::promise<void>>();
+        auto future = promise->get_future();
+        WritePageAsync(page_id, page_data, [promise]() { promise->set_value(); });
+        return future;
+    }
+
+    /**
+     *  @brief Returns the name of the engine running asynchronous requests.
+     */
+    const char *GetIOEngineName() { return GetIOEngine()->GetName(); }
+
     size_t GetPageSize() const { return header_page_.page_size_; }
 
-    size_t GetPageNum() const { return header_page_.page_num_; }
+    bool IsDirectIO() const { return direct_io_; }
+
+    bool HasChecksums() const { return checksum_; }
+
+    /**
+     *  @brief The number of pages read whose checksum did not match.
+     */
+    size_t GetChecksumFailureNum() const { return checksum_failure_num_.load(); }
+
+    size_t GetPageNum() const { return page_num_.load(); }
 
 private:
     const Slice db_file_name_;
+    // page_size_ is fixed, page_num_ is only written back from page_num_ below
     disk::DiskHeaderPage header_page_;
-    std::fstream db_io_;
+    int db_fd_ = -1;
+    // db_fd_ was opened with O_DIRECT
+    bool direct_io_ = false;
+    bool checksum_ = false;
+    std::atomic<size_t> checksum_failure_num_{0};
+    // number of pages in the file, grows with writes past its end
+    std::atomic<size_t> page_num_{0};
+    std::unique_ptr<IOEngine> io_engine_;
+    std::once_flag io_engine_once_;
+    // protects free_pages_ and next_page_id_
+    std::mutex free_latch_;
+    FreePageList free_pages_;
+    // pages allocated so far, not all written yet
+    size_t next_page_id_ = 0;
+
+    IOEngine *GetIOEngine() {
+        std::call_once(io_engine_once_, [this]() {
+            io_engine_ = IOUringEngine::Create();
+            if (io_engine_ == nullptr) io_engine_.reset(new ThreadPoolIOEngine());
+        });
+        return io_engine_.get();
+    }
+
+    /**
+     *  @brief Read a page on the engine, see ReadPageAsync.
+     *  @param queue leave the read queued on the engine for a later Flush
+     */
+    void StartRead(page_id_t page_id, char *page_data, std::function<void()> callback, const bool queue) {
+        size_t offset = GetPageOffset(page_id);
+        if (offset + header_page_.page_size_ > GetPageOffset((page_id_t)page_num_.load())) {
+            if (callback) callback();
+            return;
+        }
+        char *buf = NeedsBounce(page_data) ? AllocateAligned(header_page_.page_size_) : page_data;
+        IOCallback on_read = [this, page_id, size = header_page_.page_size_, buf, page_data,
+                              callback](ssize_t result) {
+            if (result < 0) {
+                std::cerr << "I/O error while reading" << std::endl;
+                exit(0);
+            }
+            // the file was cut at a page boundary since the read was submitted
+            bool is_read = result == (ssize_t)size;
+            if (buf != page_data) {
+                if (is_read) memcpy(page_data, buf, size);
+                free(buf);
+            }
+            if (is_read) VerifyChecksum(page_id, page_data);
+            if (callback) callback();
+        };
+        if (queue) {
+            GetIOEngine()->QueueRead(db_fd_, buf, header_page_.page_size_, offset, std::move(on_read));
+        } else {
+            GetIOEngine()->SubmitRead(db_fd_, buf, header_page_.page_size_, offset, std::move(on_read));
+        }
+    }
+
+    size_t GetPageOffset(page_id_t page_id) const {
+        return disk::DISK_HEADER_PAGE_SIZE + (size_t)page_id * header_page_.page_size_;
+    }
+
+    void GrowPageNum(page_id_t page_id) {
+        size_t page_num = page_num_.load();
+        while (page_num <= (size_t)page_id && !page_num_.compare_exchange_weak(page_num, page_id + 1)) {}
+    }
+
+    void CheckReadRange(const size_t offset, const size_t data_size) const {
+        auto file_size = disk::DISK_HEADER_PAGE_SIZE + header_page_.page_size_ * page_num_.load();
+        if (offset + data_size > file_size) {
+            std::cerr << "I/O error reading past end of file" << std::endl;
+            exit(0);
+        }
+    }
+
+    bool NeedsBounce(const char *data) const { return direct_io_ && (uintptr_t)data % DIRECT_IO_ALIGNMENT != 0; }
+
+    static char *AllocateAligned(const size_t size) {
+        size_t aligned_size = (size + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+        auto buf = (char *)aligned_alloc(DIRECT_IO_ALIGNMENT, aligned_size);
+        if (buf == nullptr) {
+            std::cerr << "can't allocate I/O buffer" << std::endl;
+            exit(0);
+        }
+        return buf;
+    }
+
+    /**
+     *  @brief Sort pages by id, and read or write each run of consecutive ids with one call.
+     */
+    void TransferPages(const bool is_write, std::vector<std::pair<page_id_t, char *>> &pages) {
+        std::sort(pages.begin(), pages.end());
+        size_t page_size = header_page_.page_size_;
+        std::vector<struct iovec> iov;
+        // pages of unaligned buffers go through aligned ones in direct I/O mode
+        std::vector<std::pair<char *, char *>> bounces;
+        for (size_t start = 0, end; start < pages.size(); start = end) {
+            iov.clear();
+            bounces.clear();
+            for (end = start; end < pages.size(); ++end) {
+                if (end > start && pages[end].first != pages[end - 1].first + 1) break;
+                char *buf = pages[end].second;
+                if (is_write && NeedsChecksumCopy(buf)) {
+                    bounces.emplace_back(buf, CopyForWrite(buf));
+                    buf = bounces.back().second;
+                } else if (NeedsBounce(buf)) {
+                    bounces.emplace_back(buf, AllocateAligned(page_size));
+                    if (is_write) memcpy(bounces.back().second, buf, page_size);
+                    buf = bounces.back().second;
+                }
+                iov.push_back({buf, page_size});
+            }
+            size_t size = (end - start) * page_size;
+            ssize_t result = PVectorFull(is_write, db_fd_, iov.data(), (int)iov.size(), GetPageOffset(pages[start].first));
+            for (auto &bounce : bounces) {
+                if (!is_write) memcpy(bounce.first, bounce.second, page_size);
+                free(bounce.second);
+            }
+            if (result != (ssize_t)size) {
+                std::cerr << (is_write ? "I/O error while writing" : "I/O error while reading") << std::endl;
+                exit(0);
+            }
+        }
+    }
+
+    /**
+     *  @brief Whether a page is written through CopyForWrite: always with checksums, without them
+     *         when the page still holds a checksum, which no longer matches once it is changed.
+     */
+    bool NeedsChecksumCopy(const char *page_data) const {
+        if (checksum_) return true;
+        if (header_page_.page_size_ <= disk::PAGE_HEADER_SIZE) return false;
+        uint32_t checksum;
+        memcpy(&checksum, page_data + disk::OFFSET_PAGE_CHECKSUM, sizeof(checksum));
+        return checksum != 0;
+    }
+
+    /**
+     *  @brief Copy a page into an aligned buffer, to be freed, and set its checksum there, or
+     *         clear it without checksums.
+     */
+    char *CopyForWrite(const char *page_data) const {
+        char *buf = AllocateAligned(header_page_.page_size_);
+        memcpy(buf, page_data, header_page_.page_size_);
+        if (checksum_) {
+            disk::SetPageChecksum(buf, header_page_.page_size_);
+        } else {
+            memset(buf + disk::OFFSET_PAGE_CHECKSUM, 0, sizeof(uint32_t));
+        }
+        return buf;
+    }
+
+    void VerifyChecksum(page_id_t page_id, const char *page_data) {
+        if (!checksum_ || disk::VerifyPageChecksum(page_data, header_page_.page_size_)) return;
+        checksum_failure_num_.fetch_add(1);
+        std::cerr << "checksum mismatch in page " << page_id << std::endl;
+    }
 
     void WriteDisk(const size_t offset, const char *data, const size_t data_size) {
-        db_io_.seekp(offset);
-        db_io_.write(data, data_size);
+        char *buf = const_cast<char *>(data);
+        if (NeedsBounce(data)) {
+            buf = AllocateAligned(data_size);
+            memcpy(buf, data, data_size);
+        }
+        ssize_t result = PWriteFull(db_fd_, buf, data_size, offset);
+        if (buf != data) free(buf);
         // check for I/O error
-        if (db_io_.bad()) {
+        if (result != (ssize_t)data_size) {
             std::cerr << "I/O error while writing" << std::endl;
             exit(0);
         }
-        // needs to flush to keep disk file in sync
-        db_io_.flush();
     }
 
     void ReadDisk(const size_t offset, char *data, const size_t data_size) {
-        auto file_size = header_page_.GetFileSize();
-        if (offset + data_size > file_size) {
-            std::cerr << "I/O error reading past end of file" << std::endl;
-            exit(0);
+        CheckReadRange(offset, data_size);
+        char *buf = NeedsBounce(data) ? AllocateAligned(data_size) : data;
+        ssize_t result = PReadFull(db_fd_, buf, data_size, offset);
+        if (buf != data) {
+            memcpy(data, buf, data_size);
+            free(buf);
         }
-        db_io_.seekp(offset);
-        db_io_.read(data, data_size);
-        if (db_io_.bad()) {
+        if (result != (ssize_t)data_size) {
             std::cerr << "I/O error while reading" << std::endl;
             exit(0);
         }
     }
 
-    void ReadHeaderPage() { ReadDisk(0, (char *)&header_page_, disk::DISK_HEADER_PAGE_SIZE); }
+    /**
+     *  @brief Read the free pages stored by the last ShutDown.
+     *
+     *  The header then forgets them until the next ShutDown stores them again. If the process
+     *  dies before, the free pages are lost to the file, but none of them is handed out twice.
+     */
+    void LoadFreePages() {
+        next_page_id_ = page_num_.load();
+        if (header_page_.free_page_num_ == 0) return;
+        free_pages_.Load(header_page_.free_list_head_, header_page_.free_page_num_, header_page_.page_size_,
+                         [this](page_id_t page_id, char *data) { ReadPage(page_id, data); });
+        header_page_.free_page_num_ = 0;
+        header_page_.free_list_head_ = INVALID_PAGE_ID;
+        WriteHeaderPage();
+    }
+
+    void ReadHeaderPage() {
+        auto size = disk::DISK_HEADER_PAGE_SIZE;
+        char *buf = AllocateAligned(size);
+        ssize_t result = PReadFull(db_fd_, buf, size, 0);
+        memcpy((char *)&header_page_, buf, sizeof(header_page_));
+        free(buf);
+        if (result != (ssize_t)size) {
+            std::cerr << "I/O error while reading" << std::endl;
+            exit(0);
+        }
+    }
 
-    void WriteHeaderPage() { WriteDisk(0, (const char *)&header_page_, disk::DISK_HEADER_PAGE_SIZE); }
+    void WriteHeaderPage() {
+        header_page_.page_num_ = page_num_.load();
+        // the padding is written too, so the first page starts at an aligned offset
+        char *buf = AllocateAligned(disk::DISK_HEADER_PAGE_SIZE);
+        memset(buf, 0, disk::DISK_HEADER_PAGE_SIZE);
+        memcpy(buf, (const char *)&header_page_, sizeof(header_page_));
+        WriteDisk(0, buf, disk::DISK_HEADER_PAGE_SIZE);
+        free(buf);
+    }
 };
 
 
-} // dsbus
\ No newline at end of file
+} // dsbus
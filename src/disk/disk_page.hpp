@@ -1,28 +1,35 @@
 #pragma once
+#include <cstring>
 #include <iostream>
+#include "common/crc32c.h"
 #include "disk/disk_config.h"
 
 namespace dsbus {
 
 namespace disk {
 
-const size_t DISK_HEADER_PAGE_SIZE = 16;
+// the header page is padded to DIRECT_IO_ALIGNMENT, so pages of a size multiple of it are aligned
+const size_t DISK_HEADER_PAGE_SIZE = DIRECT_IO_ALIGNMENT;
 
 /**
- *  The first page in a db file.
+ *  The first page in a db file, its fields are stored at the start of DISK_HEADER_PAGE_SIZE bytes.
  */
 class DiskHeaderPage {
 public:
     size_t page_size_;
     size_t page_num_;
+    // deallocated pages, listed in trunks starting at free_list_head_, see FreePageList.
+    // Files written before free pages were kept have 0 here.
+    size_t free_page_num_;
+    page_id_t free_list_head_;
 
     DiskHeaderPage() : DiskHeaderPage(0, 0) {}
 
     DiskHeaderPage(const size_t page_size, const size_t page_num)
-                  : page_size_(page_size), page_num_(page_num) {}
+                  : page_size_(page_size), page_num_(page_num), free_page_num_(0), free_list_head_(INVALID_PAGE_ID) {}
     
     DiskHeaderPage(const size_t page_size)
-                  : page_size_(page_size), page_num_(0) {}
+                  : DiskHeaderPage(page_size, 0) {}
 
     /**
      *  @brief Returns the size of file.
@@ -34,8 +41,46 @@ public:
     }    
 };
 
+// layout of the page header, shared by Page and the page checksums of DiskManager
+const size_t PAGE_HEADER_SIZE = 24;
+const size_t OFFSET_PAGE_ID = 0;
+const size_t OFFSET_PAGE_CHECKSUM = 8;
+const size_t OFFSET_PAGE_LSN = 16;
+
+/**
+ *  @brief Returns the checksum of a page, the CRC32C of the page but its checksum field.
+ *
+ *  Never 0, a page with 0 in its checksum field has no checksum.
+ */
+inline uint32_t ComputePageChecksum(const char *data, const size_t page_size) {
+    const size_t end = OFFSET_PAGE_CHECKSUM + sizeof(uint32_t);
+    uint32_t crc = Crc32c(data + end, page_size - end, Crc32c(data, OFFSET_PAGE_CHECKSUM));
+    return crc != 0 ? crc : 1;
+}
+
+inline void SetPageChecksum(char *data, const size_t page_size) {
+    uint32_t checksum = ComputePageChecksum(data, page_size);
+    memcpy(data + OFFSET_PAGE_CHECKSUM, &checksum, sizeof(checksum));
+}
+
+/**
+ *  @return false if the page has a checksum, which does not match its content
+ */
+inline bool VerifyPageChecksum(const char *data, const size_t page_size) {
+    uint32_t checksum;
+    memcpy(&checksum, data + OFFSET_PAGE_CHECKSUM, sizeof(checksum));
+    return checksum == 0 || checksum == ComputePageChecksum(data, page_size);
+}
+
 /**
  *  Original page in db file.
+ *
+ *  A Page is exactly page_size bytes, so an array of pages can be read and written
+ *  frame by frame. Bookkeeping such as dirty flags lives with the buffer pool.
+ *
+ *  The header holds the page id, the checksum DiskManager may keep and the LSN of the last log
+ *  record that changed the page, see PAGE_HEADER_SIZE. A page never logged has LSN 0, which
+ *  is before any log record.
  */
 template<size_t page_size>
 class Page {
@@ -47,10 +92,6 @@ public:
         SetPageId(INVALID_PAGE_ID);
     }
 
-    ~Page() {
-        free(data_);
-    }
-
     inline char *GetData() { return data_; }
     inline void SetData(const char *s, const size_t size) {
         if (page_size != size) {
@@ -58,29 +99,25 @@ public:
             exit(0);
         }
         memcpy(data_, s, page_size);
-        SetDirty(true);
     }
 
     inline char *GetContent() { return data_ + SIZE_PAGE_HEADER; }
 
-    inline page_id_t GetPageId() { return *(page_id_t *)(data_ + OFFSET_LSN); }
-    inline void SetPageId(const page_id_t page_id) { *(page_id_t *)(data_ + OFFSET_LSN) = page_id; }
-
-    inline void SetDirty(bool dirty) { is_dirty_ = dirty; }
+    inline page_id_t GetPageId() { return *(page_id_t *)(data_ + OFFSET_PAGE_ID); }
+    inline void SetPageId(const page_id_t page_id) { *(page_id_t *)(data_ + OFFSET_PAGE_ID) = page_id; }
 
-    inline bool IsDirty() const { return is_dirty_; }
+    inline lsn_t GetLSN() { return *(lsn_t *)(data_ + OFFSET_PAGE_LSN); }
+    inline void SetLSN(const lsn_t lsn) { *(lsn_t *)(data_ + OFFSET_PAGE_LSN) = lsn; }
 
     inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, page_size); }
 
 private:
 protected:
-    static constexpr size_t SIZE_PAGE_HEADER = 8;
+    static constexpr size_t SIZE_PAGE_HEADER = PAGE_HEADER_SIZE;
     static constexpr size_t OFFSET_PAGE_START = 0;
-    static constexpr size_t OFFSET_LSN = 4;
 
 protected:
     char data_[page_size];
-    bool is_dirty_ = false;
 };
 
 } // disk
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include "disk/disk_config.h"
+#include "disk/disk_page.hpp"
+
+namespace dsbus {
+
+/**
+ *  FreePageList keeps the deallocated pages of a db file, for allocation to reuse.
+ *
+ *  Free pages are held in memory in page id order, Allocate hands out the lowest one so that
+ *  the file stays dense, and free pages at the end of the file are cut off by Trim.
+ *
+ *  Between runs the list is stored in the free pages themselves. Some of them become trunks,
+ *  each holding the id of the next trunk, a count and as many free page ids as fit in a page:
+ *
+ *    | next trunk (page_id_t) | checksum (uint32_t) | count (uint32_t) | page id | page id | ... |
+ *
+ *  The checksum field is the one of the page header, it is left to the disk manager writing
+ *  the trunk.
+ *
+ *  The header of the file names the first trunk and the number of free pages. Pages too small
+ *  for a single id can't hold trunks, their free pages are forgotten.
+ *
+ *  Not thread safe, disk managers latch it.
+ */
+class FreePageList {
+public:
+    bool Empty() const { return pages_.empty(); }
+
+    size_t Size() const { return pages_.size(); }
+
+    bool Contains(const page_id_t page_id) const { return pages_.count(page_id) != 0; }
+
+    void Insert(const page_id_t page_id) { pages_.insert(page_id); }
+
+    /**
+     *  @brief Returns the free pages in page id order.
+     */
+    std::vector<page_id_t> GetPageIds() const { return std::vector<page_id_t>(pages_.begin(), pages_.end()); }
+
+    /**
+     *  @brief Take the lowest free page, the list must not be empty.
+     */
+    page_id_t Allocate() {
+        auto page_id = *pages_.begin();
+        pages_.erase(pages_.begin());
+        return page_id;
+    }
+
+    /**
+     *  @brief Drop the free pages ending the page range [0, page_num).
+     *  @return the number of pages left in the range
+     */
+    size_t Trim(size_t page_num) {
+        while (page_num != 0 && !pages_.empty() && *pages_.rbegin() == (page_id_t)(page_num - 1)) {
+            pages_.erase(std::prev(pages_.end()));
+            --page_num;
+        }
+        return page_num;
+    }
+
+    /**
+     *  @brief Read the list stored by Store, the list must be empty.
+     *  @param read_page callable (page_id_t, char *) reading a page
+     */
+    template<typename ReadPage>
+    void Load(page_id_t trunk_id, const size_t page_num, const size_t page_size, ReadPage read_page) {
+        std::vector<char> trunk(page_size);
+        while (trunk_id != INVALID_PAGE_ID && pages_.size() < page_num && GetTrunkCapacity(page_size) != 0) {
+            read_page(trunk_id, trunk.data());
+            pages_.insert(trunk_id);
+            uint32_t count;
+            memcpy(&count, &trunk[OFFSET_TRUNK_COUNT], sizeof(count));
+            for (uint32_t i = 0; i < count; ++i) {
+                page_id_t page_id;
+                memcpy(&page_id, &trunk[TRUNK_HEADER_SIZE + i * sizeof(page_id_t)], sizeof(page_id));
+                pages_.insert(page_id);
+            }
+            memcpy(&trunk_id, trunk.data(), sizeof(trunk_id));
+        }
+    }
+
+    /**
+     *  @brief Write the list into trunks, the list itself is left as it is.
+     *  @param write_page callable (page_id_t, const char *) writing a page
+     *  @return the first trunk, INVALID_PAGE_ID if nothing was stored
+     */
+    template<typename WritePage>
+    page_id_t Store(const size_t page_size, WritePage write_page) const {
+        size_t capacity = GetTrunkCapacity(page_size);
+        if (pages_.empty() || capacity == 0) return INVALID_PAGE_ID;
+        auto page_ids = GetPageIds();
+        // every trunk lists itself implicitly, so it covers capacity + 1 pages
+        size_t trunk_num = (page_ids.size() + capacity) / (capacity + 1);
+        std::vector<char> trunk(page_size, 0);
+        size_t next_id = trunk_num;
+        for (size_t t = 0; t < trunk_num; ++t) {
+            page_id_t next_trunk_id = t + 1 < trunk_num ? page_ids[t + 1] : INVALID_PAGE_ID;
+            uint32_t count = (uint32_t)std::min(capacity, page_ids.size() - next_id);
+            memcpy(trunk.data(), &next_trunk_id, sizeof(next_trunk_id));
+            memcpy(&trunk[OFFSET_TRUNK_COUNT], &count, sizeof(count));
+            memcpy(&trunk[TRUNK_HEADER_SIZE], page_ids.data() + next_id, count * sizeof(page_id_t));
+            next_id += count;
+            write_page(page_ids[t], trunk.data());
+        }
+        return page_ids[0];
+    }
+
+private:
+    static constexpr size_t OFFSET_TRUNK_COUNT = disk::OFFSET_PAGE_CHECKSUM + sizeof(uint32_t);
+    static constexpr size_t TRUNK_HEADER_SIZE = OFFSET_TRUNK_COUNT + sizeof(uint32_t);
+
+    std::set<page_id_t> pages_;
+
+    static size_t GetTrunkCapacity(const size_t page_size) {
+        return page_size < TRUNK_HEADER_SIZE ? 0 : (page_size - TRUNK_HEADER_SIZE) / sizeof(page_id_t);
+    }
+};
+
+} // dsbus
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cerrno>
+#include <climits>
+#include <functional>
+#include <utility>
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace dsbus {
+
+/**
+ *  Invoked once an asynchronous request is complete, with the number of bytes transferred,
+ *  which is the full request size unless the file ends first, or -errno.
+ */
+using IOCallback = std::function<void(ssize_t)>;
+
+/**
+ *  One asynchronous read or write of a contiguous file range.
+ */
+struct IORequest {
+    bool is_write_;
+    int fd_;
+    char *buf_;
+    size_t size_;
+    off_t offset_;
+    IOCallback callback_;
+    // for engines submitting vectored I/O, kept with the request until it completes
+    struct iovec iov_;
+};
+
+/**
+ *  IOEngine runs file reads and writes asynchronously.
+ *
+ *  Requests are started by SubmitRead / SubmitWrite, or queued by QueueRead / QueueWrite to be
+ *  started together by Flush, and may complete in any order. Callbacks run
+ *  on a thread of the engine, they must be short and must not wait for other requests of the
+ *  same engine. The buffer of a request must stay valid until its callback has run.
+ *
+ *  All methods are thread safe. Destroying an engine waits for the requests in flight.
+ */
+class IOEngine {
+public:
+    virtual ~IOEngine() = default;
+
+    virtual void SubmitRead(int fd, char *buf, size_t size, off_t offset, IOCallback callback) = 0;
+
+    virtual void SubmitWrite(int fd, const char *buf, size_t size, off_t offset, IOCallback callback) = 0;
+
+    /**
+     *  @brief Queue a read, started by the next Flush at the latest. Engines without a queue
+     *         of their own start it right away.
+     */
+    virtual void QueueRead(int fd, char *buf, size_t size, off_t offset, IOCallback callback) {
+        SubmitRead(fd, buf, size, offset, std::move(callback));
+    }
+
+    /**
+     *  @brief Queue a write, started by the next Flush at the latest.
+     */
+    virtual void QueueWrite(int fd, const char *buf, size_t size, off_t offset, IOCallback callback) {
+        SubmitWrite(fd, buf, size, offset, std::move(callback));
+    }
+
+    /**
+     *  @brief Start the requests queued so far.
+     */
+    virtual void Flush() {}
+
+    /**
+     *  @brief Wait until every request submitted or queued so far has completed.
+     */
+    virtual void Drain() = 0;
+
+    virtual const char *GetName() const = 0;
+};
+
+/**
+ *  @brief pread until size bytes are read, the file ends or an error other than EINTR occurs.
+ *  @return the number of bytes read, or -errno
+ */
+inline ssize_t PReadFull(const int fd, char *buf, const size_t size, const off_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t r = pread(fd, buf + done, size - done, offset + done);
+        if (r == 0) break;
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -errno;
+        }
+        done += r;
+    }
+    return done;
+}
+
+/**
+ *  @brief pwrite until size bytes are written or an error other than EINTR occurs.
+ *  @return size, or -errno
+ */
+inline ssize_t PWriteFull(const int fd, const char *buf, const size_t size, const off_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t r = pwrite(fd, buf + done, size - done, offset + done);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -errno;
+        }
+        done += r;
+    }
+    return done;
+}
+
+/**
+ *  @brief preadv / pwritev until all of iov is transferred, the file ends or an error other than
+ *         EINTR occurs. iov is consumed, iovcnt may exceed IOV_MAX.
+ *  @return the number of bytes transferred, or -errno
+ */
+inline ssize_t PVectorFull(const bool is_write, const int fd, struct iovec *iov, int iovcnt, const off_t offset) {
+    size_t done = 0;
+    while (iovcnt > 0) {
+        int count = iovcnt < IOV_MAX ? iovcnt : IOV_MAX;
+        ssize_t r = is_write ? pwritev(fd, iov, count, offset + done) : preadv(fd, iov, count, offset + done);
+        if (r == 0) break;
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -errno;
+        }
+        done += r;
+        // skip what was transferred, the last vector may be partly done
+        while (iovcnt > 0 && (size_t)r >= iov->iov_len) {
+            r -= iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + r;
+            iov->iov_len -= r;
+        }
+    }
+    return done;
+}
+
+} // dsbus
@@ -0,0 +1,313 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "disk/disk_config.h"
+#include "disk/io_engine.hpp"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define DSBUS_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+// requests reach the completion thread through the kernel, which ThreadSanitizer cannot see
+#if defined(__SANITIZE_THREAD__)
+extern "C" void __tsan_acquire(void *addr);
+extern "C" void __tsan_release(void *addr);
+#define DSBUS_TSAN_ACQUIRE(addr) __tsan_acquire(addr)
+#define DSBUS_TSAN_RELEASE(addr) __tsan_release(addr)
+#else
+#define DSBUS_TSAN_ACQUIRE(addr)
+#define DSBUS_TSAN_RELEASE(addr)
+#endif
+
+namespace dsbus {
+
+#ifdef DSBUS_HAVE_IO_URING
+
+/**
+ *  IOUringEngine submits requests to an io_uring instance, without liburing.
+ *
+ *  Submitters fill the submission queue under a latch, and one of them at a time hands every
+ *  entry queued so far to the kernel, in one io_uring_enter made outside the latch. Entries
+ *  queued meanwhile are entered by that submitter before it leaves, so concurrent requests
+ *  share the syscall. QueueRead / QueueWrite only fill the queue, which is entered on Flush,
+ *  when it is full, or by the next submission. A completion thread reaps the completion queue
+ *  and runs the callbacks. At most as many requests as the completion queue holds are in
+ *  flight, submitters wait beyond that, so completions are never dropped.
+ *
+ *  A request completed short, e.g. interrupted, is finished with pread / pwrite on the
+ *  completion thread.
+ */
+class IOUringEngine : public IOEngine {
+public:
+    /**
+     *  @brief Create an engine, nullptr if the kernel refuses io_uring.
+     *  @param queue_depth number of submission queue entries
+     */
+    static std::unique_ptr<IOUringEngine> Create(const unsigned queue_depth = IO_ENGINE_QUEUE_DEPTH) {
+        std::unique_ptr<IOUringEngine> engine(new IOUringEngine());
+        if (!engine->Setup(queue_depth == 0 ? 1 : queue_depth)) return nullptr;
+        engine->reaper_ = std::thread([e = engine.get()]() { e->Reap(); });
+        return engine;
+    }
+
+    ~IOUringEngine() override {
+        if (reaper_.joinable()) {
+            Drain();
+            // a nop without request stops the completion thread
+            Submit(IORING_OP_NOP, nullptr, true);
+            reaper_.join();
+        }
+        if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+        if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+        if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+        if (ring_fd_ >= 0) close(ring_fd_);
+    }
+
+    void SubmitRead(int fd, char *buf, size_t size, off_t offset, IOCallback callback) override {
+        Submit(IORING_OP_READV, NewRequest(false, fd, buf, size, offset, std::move(callback)), true);
+    }
+
+    void SubmitWrite(int fd, const char *buf, size_t size, off_t offset, IOCallback callback) override {
+        Submit(IORING_OP_WRITEV, NewRequest(true, fd, const_cast<char *>(buf), size, offset, std::move(callback)), true);
+    }
+
+    void QueueRead(int fd, char *buf, size_t size, off_t offset, IOCallback callback) override {
+        Submit(IORING_OP_READV, NewRequest(false, fd, buf, size, offset, std::move(callback)), false);
+    }
+
+    void QueueWrite(int fd, const char *buf, size_t size, off_t offset, IOCallback callback) override {
+        Submit(IORING_OP_WRITEV, NewRequest(true, fd, const_cast<char *>(buf), size, offset, std::move(callback)), false);
+    }
+
+    void Flush() override {
+        std::unique_lock<std::mutex> lock(latch_);
+        EnterQueued(lock);
+    }
+
+    void Drain() override {
+        std::unique_lock<std::mutex> lock(latch_);
+        EnterQueued(lock);
+        inflight_cv_.wait(lock, [this]() { return inflight_ == 0; });
+    }
+
+    const char *GetName() const override { return "io_uring"; }
+
+private:
+    int ring_fd_ = -1;
+    void *sq_ring_ = MAP_FAILED;
+    void *cq_ring_ = MAP_FAILED;
+    void *sqes_ = MAP_FAILED;
+    size_t sq_ring_size_ = 0;
+    size_t cq_ring_size_ = 0;
+    size_t sqes_size_ = 0;
+    // submission queue, written by submitters under latch_, its head is moved by the kernel
+    unsigned *sq_head_ = nullptr;
+    unsigned *sq_tail_ = nullptr;
+    unsigned *sq_mask_ = nullptr;
+    unsigned *sq_array_ = nullptr;
+    struct io_uring_sqe *sqe_array_ = nullptr;
+    unsigned sq_entries_ = 0;
+    // completion queue, read by reaper_ only
+    unsigned *cq_head_ = nullptr;
+    unsigned *cq_tail_ = nullptr;
+    unsigned *cq_mask_ = nullptr;
+    struct io_uring_cqe *cqe_array_ = nullptr;
+    unsigned cq_entries_ = 0;
+
+    std::thread reaper_;
+    // protects the submission queue, inflight_, queued_num_ and entering_
+    std::mutex latch_;
+    std::condition_variable inflight_cv_;
+    // notified when a submitter is back from the kernel
+    std::condition_variable enter_cv_;
+    // requests submitted and not completed yet
+    unsigned inflight_ = 0;
+    // entries in the submission queue not taken by a submitter yet
+    unsigned queued_num_ = 0;
+    // a submitter is entering the kernel
+    bool entering_ = false;
+
+    IOUringEngine() = default;
+
+    static IORequest *NewRequest(const bool is_write, int fd, char *buf, size_t size, off_t offset,
+                                 IOCallback callback) {
+        return new IORequest{is_write, fd, buf, size, offset, std::move(callback), {buf, size}};
+    }
+
+    static int Enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+        return (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0);
+    }
+
+    bool Setup(const unsigned queue_depth) {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ring_fd_ = (int)syscall(__NR_io_uring_setup, queue_depth, &params);
+        if (ring_fd_ < 0) return false;
+
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) return false;
+        cq_ring_ = single_mmap ? sq_ring_
+                 : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ring_ == MAP_FAILED) return false;
+        sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+        sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring_fd_, IORING_OFF_SQES);
+        if (sqes_ == MAP_FAILED) return false;
+
+        auto sq = (char *)sq_ring_;
+        sq_head_ = (unsigned *)(sq + params.sq_off.head);
+        sq_tail_ = (unsigned *)(sq + params.sq_off.tail);
+        sq_mask_ = (unsigned *)(sq + params.sq_off.ring_mask);
+        sq_array_ = (unsigned *)(sq + params.sq_off.array);
+        sqe_array_ = (struct io_uring_sqe *)sqes_;
+        sq_entries_ = params.sq_entries;
+        auto cq = (char *)cq_ring_;
+        cq_head_ = (unsigned *)(cq + params.cq_off.head);
+        cq_tail_ = (unsigned *)(cq + params.cq_off.tail);
+        cq_mask_ = (unsigned *)(cq + params.cq_off.ring_mask);
+        cqe_array_ = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+        cq_entries_ = params.cq_entries;
+        return true;
+    }
+
+    /**
+     *  @brief Queue one entry, request is nullptr for the stop nop.
+     *  @param enter hand the queue to the kernel before returning, or leave it to a submitter
+     *         already in the kernel
+     */
+    void Submit(const uint8_t opcode, IORequest *request, const bool enter) {
+        std::unique_lock<std::mutex> lock(latch_);
+        if (request != nullptr) {
+            // queued entries count as in flight, they are entered instead of waited for
+            while (inflight_ == cq_entries_) {
+                if (queued_num_ != 0 && !entering_) {
+                    EnterQueued(lock);
+                } else {
+                    inflight_cv_.wait(lock);
+                }
+            }
+            ++inflight_;
+        }
+        // a full queue is entered before it takes more
+        while (*sq_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == sq_entries_) {
+            if (entering_) {
+                enter_cv_.wait(lock);
+            } else {
+                EnterQueued(lock);
+            }
+        }
+        unsigned tail = *sq_tail_;
+        unsigned index = tail & *sq_mask_;
+        auto sqe = &sqe_array_[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = opcode;
+        if (request != nullptr) {
+            sqe->fd = request->fd_;
+            sqe->addr = (uint64_t)&request->iov_;
+            sqe->len = 1;
+            sqe->off = request->offset_;
+        }
+        sqe->user_data = (uint64_t)request;
+        DSBUS_TSAN_RELEASE(request);
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        ++queued_num_;
+        if (enter) EnterQueued(lock);
+    }
+
+    /**
+     *  @brief Hand the queued entries to the kernel, with latch_ held by lock.
+     *
+     *  The latch is released during io_uring_enter, entries queued meanwhile are entered in a
+     *  next round. If another submitter is in the kernel, it enters them instead.
+     */
+    void EnterQueued(std::unique_lock<std::mutex> &lock) {
+        if (entering_) return;
+        entering_ = true;
+        while (queued_num_ != 0) {
+            unsigned num = queued_num_;
+            queued_num_ = 0;
+            lock.unlock();
+            while (num != 0) {
+                int result = Enter(ring_fd_, num, 0, 0);
+                if (result < 0) {
+                    if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                        std::cerr << "io_uring_enter failed: " << strerror(errno) << std::endl;
+                        exit(0);
+                    }
+                    continue;
+                }
+                num -= (unsigned)result;
+            }
+            lock.lock();
+            enter_cv_.notify_all();
+        }
+        entering_ = false;
+    }
+
+    void Reap() {
+        while (true) {
+            unsigned head = *cq_head_;
+            if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+                Enter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+                continue;
+            }
+            auto cqe = &cqe_array_[head & *cq_mask_];
+            auto request = (IORequest *)cqe->user_data;
+            ssize_t result = cqe->res;
+            __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+            if (request == nullptr) return;
+            DSBUS_TSAN_ACQUIRE(request);
+            Complete(request, result);
+        }
+    }
+
+    void Complete(IORequest *request, ssize_t result) {
+        if (result >= 0 && (size_t)result < request->size_) {
+            // finish a short transfer synchronously, a read may end with the file
+            size_t done = result;
+            ssize_t rest = request->is_write_
+                         ? PWriteFull(request->fd_, request->buf_ + done, request->size_ - done, request->offset_ + done)
+                         : PReadFull(request->fd_, request->buf_ + done, request->size_ - done, request->offset_ + done);
+            result = rest < 0 ? rest : (ssize_t)(done + rest);
+        }
+        if (request->callback_) request->callback_(result);
+        delete request;
+        std::lock_guard<std::mutex> guard(latch_);
+        --inflight_;
+        inflight_cv_.notify_all();
+    }
+};
+
+#else
+
+/**
+ *  io_uring is not available on this platform, Create always fails.
+ */
+class IOUringEngine : public IOEngine {
+public:
+    static std::unique_ptr<IOUringEngine> Create(const unsigned queue_depth = IO_ENGINE_QUEUE_DEPTH) {
+        return nullptr;
+    }
+};
+
+#endif
+
+} // dsbus
@@ -0,0 +1,325 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "common/rwlatch.h"
+#include "slice/slice.hpp"
+#include "disk/disk_config.h"
+#include "disk/disk_page.hpp"
+#include "disk/free_page_list.hpp"
+#include "disk/io_engine.hpp"
+
+namespace dsbus {
+
+enum class MMapAdvice {
+    NORMAL,
+    // pages are read in order, the kernel reads ahead aggressively
+    SEQUENTIAL,
+    // pages are read in no particular order, the kernel does not read ahead
+    RANDOM,
+    // the whole file will be read soon
+    WILLNEED
+};
+
+/**
+ *  MMapDiskManager is a DiskManager backed by a shared mapping of the db file.
+ *
+ *  The file has the DiskManager layout, either can open files written by the other, and it
+ *  offers the ReadPage / WritePage / GetPageNum surface BufferPoolManager uses. Page I/O is a
+ *  memcpy from or into the mapping, GetPageData gives read access to a page without copying.
+ *
+ *  The file grows by doubling: it is extended with ftruncate and the mapping with mremap, which
+ *  may move it. Unused capacity is cut off again when the manager is destroyed.
+ *
+ *  Pages are allocated and deallocated as with DiskManager, free pages ending the file are
+ *  dropped from page_num_ at once and cut off the file on destruction.
+ *
+ *  All methods are thread safe. Page I/O latches the mapping in shared mode, only growing it
+ *  takes the latch exclusively. An access to a page the kernel can't read raises SIGBUS.
+ */
+class MMapDiskManager {
+public:
+    /**
+     *  @brief Construct a disk manager instance.
+     *
+     *  @param db_file_name db file path.
+     *  @param page_size the size of page in the db file.
+     */
+    MMapDiskManager(const Slice &db_file_name, const size_t page_size) : db_file_name_(db_file_name) {
+        db_fd_ = open(db_file_name.Data(), O_RDWR);
+        // directory or file does not exist
+        if (db_fd_ < 0) {
+            // create a new file
+            db_fd_ = open(db_file_name.Data(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (db_fd_ < 0) {
+                std::cerr << "can't open db file" << std::endl;
+                exit(0);
+            }
+            header_page_.page_num_ = 0;
+            header_page_.page_size_ = page_size;
+        } else if (PReadFull(db_fd_, (char *)&header_page_, sizeof(header_page_), 0) != (ssize_t)sizeof(header_page_)) {
+            std::cerr << "I/O error while reading" << std::endl;
+            exit(0);
+        }
+        page_num_ = header_page_.page_num_;
+        next_page_id_ = header_page_.page_num_;
+        Map(std::max(header_page_.page_num_, MMAP_MIN_PAGE_NUM));
+        if (header_page_.free_page_num_ != 0) {
+            // the header forgets the free pages until ShutDown stores them again, see DiskManager
+            free_pages_.Load(header_page_.free_list_head_, header_page_.free_page_num_, header_page_.page_size_,
+                             [this](page_id_t page_id, char *data) { ReadPage(page_id, data); });
+            header_page_.free_page_num_ = 0;
+            header_page_.free_list_head_ = INVALID_PAGE_ID;
+        }
+        WriteHeaderPage();
+    }
+
+    ~MMapDiskManager() {
+        ShutDown();
+        munmap(data_, map_size_);
+        // give back the capacity beyond the last page
+        if (ftruncate(db_fd_, GetFileSize(page_num_.load())) != 0) {
+            std::cerr << "I/O error while truncating" << std::endl;
+        }
+        close(db_fd_);
+    }
+
+    /**
+     *  @brief Store the free pages, write the header and flush the mapping to disk.
+     */
+    void ShutDown() {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        auto free_list_head = free_pages_.Store(header_page_.page_size_, [this](page_id_t page_id, const char *data) {
+            WritePage(page_id, data);
+        });
+        map_latch_.RLock();
+        header_page_.free_list_head_ = free_list_head;
+        header_page_.free_page_num_ = free_list_head == INVALID_PAGE_ID ? 0 : free_pages_.Size();
+        WriteHeaderPage();
+        msync(data_, map_size_, MS_SYNC);
+        map_latch_.RUnlock();
+    }
+
+    void ReadPage(page_id_t page_id, char *page_data) {
+        map_latch_.RLock();
+        memcpy(page_data, GetPageAddress(page_id), header_page_.page_size_);
+        map_latch_.RUnlock();
+    }
+
+    void WritePage(page_id_t page_id, const char *page_data) {
+        Reserve(page_id);
+        map_latch_.RLock();
+        memcpy(data_ + GetPageOffset(page_id), page_data, header_page_.page_size_);
+        map_latch_.RUnlock();
+        // update page_num_, but not flush to disk immediately.
+        size_t page_num = page_num_.load();
+        while (page_num <= (size_t)page_id && !page_num_.compare_exchange_weak(page_num, page_id + 1)) {}
+    }
+
+    /**
+     *  @brief Read a page, for callers of the asynchronous DiskManager interface. The copy
+     *         is cheap, the callback runs before this returns. As for DiskManager, a page past
+     *         the end of the file is not read and page_data is left as it is.
+     */
+    void ReadPageAsync(page_id_t page_id, char *page_data, std::function<void()> callback) {
+        if ((size_t)page_id < page_num_.load()) ReadPage(page_id, page_data);
+        if (callback) callback();
+    }
+
+    /**
+     *  @brief Read a batch of pages, for callers of the asynchronous DiskManager interface,
+     *         each callback runs before this returns.
+     *  @param callback run with the index of each page in pages once it is read
+     */
+    void ReadPagesAsync(const std::vector<std::pair<page_id_t, char *>> &pages, std::function<void(size_t)> callback) {
+        for (size_t i = 0; i < pages.size(); ++i) {
+            ReadPageAsync(pages[i].first, pages[i].second, [&callback, i]() { callback(i); });
+        }
+    }
+
+    /**
+     *  @brief Read a batch of pages, each pair is a page id and the buffer receiving it.
+     */
+    void ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) {
+        map_latch_.RLock();
+        for (auto &page : pages) memcpy(page.second, GetPageAddress(page.first), header_page_.page_size_);
+        map_latch_.RUnlock();
+    }
+
+    /**
+     *  @brief Write a batch of pages, each pair is a page id and the buffer holding it.
+     */
+    void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+        for (auto &page : pages) WritePage(page.first, page.second);
+    }
+
+    /**
+     *  @brief Make the pages written so far durable, flushing the mapping to disk.
+     */
+    void Sync() {
+        map_latch_.RLock();
+        int result = msync(data_, map_size_, MS_SYNC);
+        map_latch_.RUnlock();
+        if (result != 0) {
+            std::cerr << "I/O error while syncing" << std::endl;
+            exit(0);
+        }
+    }
+
+    /**
+     *  @brief Returns a page id to write a new page to, the lowest free page if any.
+     */
+    page_id_t AllocatePage() {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        if (!free_pages_.Empty()) return free_pages_.Allocate();
+        next_page_id_ = std::max(next_page_id_, page_num_.load());
+        return (page_id_t)next_page_id_++;
+    }
+
+    /**
+     *  @brief Give back a page, which must not be read or written until allocated again.
+     */
+    void DeallocatePage(page_id_t page_id) {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        if (free_pages_.Contains(page_id)) return;
+        free_pages_.Insert(page_id);
+        next_page_id_ = free_pages_.Trim(std::max(next_page_id_, page_num_.load()));
+        if (next_page_id_ < page_num_.load()) page_num_ = next_page_id_;
+    }
+
+    bool IsFreePage(page_id_t page_id) {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        return free_pages_.Contains(page_id);
+    }
+
+    size_t GetFreePageNum() {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        return free_pages_.Size();
+    }
+
+    /**
+     *  @brief Returns the page inside the mapping, read without copying.
+     *
+     *  The pointer is valid until the file grows, as long as the file is only read it can be kept.
+     */
+    const char *GetPageData(page_id_t page_id) {
+        map_latch_.RLock();
+        auto data = GetPageAddress(page_id);
+        map_latch_.RUnlock();
+        return data;
+    }
+
+    /**
+     *  @brief Tell the kernel how the file will be accessed, the advice outlives growth.
+     */
+    void Advise(const MMapAdvice advice) {
+        map_latch_.WLock();
+        advice_ = advice;
+        ApplyAdvice();
+        map_latch_.WUnlock();
+    }
+
+    size_t GetPageSize() const { return header_page_.page_size_; }
+
+    size_t GetPageNum() const { return page_num_.load(); }
+
+private:
+    const Slice db_file_name_;
+    // page_size_ is fixed, page_num_ is only written back from page_num_ below
+    disk::DiskHeaderPage header_page_;
+    int db_fd_ = -1;
+    // number of pages in the file, grows with writes past its end
+    std::atomic<size_t> page_num_{0};
+    // shared by page I/O, exclusive to move the mapping
+    ReaderWriterLatch map_latch_;
+    char *data_ = nullptr;
+    size_t map_size_ = 0;
+    // number of pages the mapping and the file have room for
+    std::atomic<size_t> capacity_{0};
+    MMapAdvice advice_ = MMapAdvice::NORMAL;
+    // protects free_pages_ and next_page_id_
+    std::mutex free_latch_;
+    FreePageList free_pages_;
+    // pages allocated so far, not all written yet
+    size_t next_page_id_ = 0;
+
+    size_t GetPageOffset(page_id_t page_id) const {
+        return disk::DISK_HEADER_PAGE_SIZE + (size_t)page_id * header_page_.page_size_;
+    }
+
+    size_t GetFileSize(const size_t page_num) const {
+        return disk::DISK_HEADER_PAGE_SIZE + page_num * header_page_.page_size_;
+    }
+
+    const char *GetPageAddress(page_id_t page_id) const {
+        if (page_id < 0 || (size_t)page_id >= page_num_.load()) {
+            std::cerr << "I/O error reading past end of file" << std::endl;
+            exit(0);
+        }
+        return data_ + GetPageOffset(page_id);
+    }
+
+    /**
+     *  @brief Size the file and the mapping for capacity pages.
+     */
+    void Map(const size_t capacity) {
+        size_t map_size = GetFileSize(capacity);
+        if (ftruncate(db_fd_, map_size) != 0) {
+            std::cerr << "I/O error while extending file" << std::endl;
+            exit(0);
+        }
+        void *data = data_ == nullptr
+                   ? mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, db_fd_, 0)
+                   : mremap(data_, map_size_, map_size, MREMAP_MAYMOVE);
+        if (data == MAP_FAILED) {
+            std::cerr << "can't map db file" << std::endl;
+            exit(0);
+        }
+        data_ = (char *)data;
+        map_size_ = map_size;
+        capacity_ = capacity;
+        ApplyAdvice();
+    }
+
+    /**
+     *  @brief Grow the mapping until it holds page_id.
+     */
+    void Reserve(page_id_t page_id) {
+        if ((size_t)page_id < capacity_.load()) return;
+        map_latch_.WLock();
+        size_t capacity = capacity_.load();
+        if ((size_t)page_id >= capacity) {
+            while ((size_t)page_id >= capacity) capacity *= 2;
+            Map(capacity);
+        }
+        map_latch_.WUnlock();
+    }
+
+    void ApplyAdvice() {
+        int advice = MADV_NORMAL;
+        switch (advice_) {
+        case MMapAdvice::NORMAL: advice = MADV_NORMAL; break;
+        case MMapAdvice::SEQUENTIAL: advice = MADV_SEQUENTIAL; break;
+        case MMapAdvice::RANDOM: advice = MADV_RANDOM; break;
+        case MMapAdvice::WILLNEED: advice = MADV_WILLNEED; break;
+        }
+        madvise(data_, map_size_, advice);
+    }
+
+    void WriteHeaderPage() {
+        header_page_.page_num_ = page_num_.load();
+        memcpy(data_, &header_page_, sizeof(header_page_));
+    }
+};
+
+} // dsbus
@@ -0,0 +1,334 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "disk/disk_config.h"
+#include "disk/disk_manager.hpp"
+#include "disk/free_page_list.hpp"
+
+namespace dsbus {
+
+/**
+ *  TablespaceManager spreads the pages of one page id space over several segment files, which
+ *  may sit on different devices.
+ *
+ *  Pages are striped in extents of extent_page_num pages: extent e lives in segment
+ *  e % segment_num. A sequential range stays in one file for an extent, and consecutive
+ *  extents go to different files, so large scans and flushes keep every device busy.
+ *
+ *  Each segment is a file of the DiskManager layout, read and written by its own DiskManager,
+ *  with its own asynchronous engine. ReadPages / WritePages split a batch by segment and
+ *  transfer the parts in parallel. The tablespace must always be opened with the same
+ *  segment files, in the same order, and the same extent size.
+ *
+ *  Page ids are allocated over the whole tablespace, lowest free page first, from a
+ *  FreePageList. ShutDown hands the free pages to their segments, which store them, and
+ *  opening the tablespace collects them again. Free pages ending the tablespace are cut off
+ *  the segment files. No page may be allocated after ShutDown. Pages past the end of their
+ *  segment but below the end of the tablespace, such as pages a write far past the end
+ *  skipped, are free once the tablespace is opened again.
+ *
+ *  It offers the surface of DiskManager BufferPoolManager uses. All methods are thread safe.
+ */
+class TablespaceManager {
+public:
+    /**
+     *  @brief Open or create a tablespace.
+     *
+     *  @param segment_file_names the segment files, at least one.
+     *  @param page_size the size of page in the segment files.
+     *  @param extent_page_num pages striped together into one segment.
+     *  @param options see DiskManagerOptions, applies to every segment.
+     */
+    TablespaceManager(const std::vector<std::string> &segment_file_names, const size_t page_size,
+                      const size_t extent_page_num = TABLESPACE_EXTENT_PAGE_NUM,
+                      const DiskManagerOptions &options = DiskManagerOptions())
+                    : extent_page_num_(std::max<size_t>(1, extent_page_num)) {
+        if (segment_file_names.empty()) {
+            std::cerr << "tablespace without segment files" << std::endl;
+            exit(0);
+        }
+        for (auto &file_name : segment_file_names) {
+            segments_.emplace_back(new DiskManager(Slice(file_name), page_size, options));
+            if (segments_.back()->GetPageSize() != segments_[0]->GetPageSize()) {
+                std::cerr << "segment files of different page sizes" << std::endl;
+                exit(0);
+            }
+        }
+        stripe_page_num_ = extent_page_num_ * segments_.size();
+        LoadFreePages();
+    }
+
+    ~TablespaceManager() { ShutDown(); }
+
+    /**
+     *  @brief Hand the free pages to the segments, then shut them down.
+     */
+    void ShutDown() {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        for (auto page_id : free_pages_.GetPageIds()) {
+            auto &segment = GetSegment(page_id);
+            auto local_id = GetLocalId(page_id);
+            // past the end of its segment, the page is found free again on open
+            if ((size_t)local_id < segment.GetPageNum()) segment.DeallocatePage(local_id);
+        }
+        for (auto &segment : segments_) segment->ShutDown();
+    }
+
+    /**
+     *  @brief Returns a page id to write a new page to, the lowest free page if any.
+     */
+    page_id_t AllocatePage() {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        if (!free_pages_.Empty()) return free_pages_.Allocate();
+        next_page_id_ = std::max(next_page_id_, page_num_.load());
+        return (page_id_t)next_page_id_++;
+    }
+
+    /**
+     *  @brief Give back a page, which must not be read or written until allocated again.
+     *
+     *  Free pages ending the tablespace are cut off their segment files.
+     */
+    void DeallocatePage(page_id_t page_id) {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        if (free_pages_.Contains(page_id)) return;
+        free_pages_.Insert(page_id);
+        next_page_id_ = free_pages_.Trim(std::max(next_page_id_, page_num_.load()));
+        if (next_page_id_ >= page_num_.load()) return;
+        page_num_ = next_page_id_;
+        // the pages past the new end are the tail of each segment, which drops them
+        for (size_t i = 0; i < segments_.size(); ++i) {
+            auto &segment = *segments_[i];
+            auto local_page_num = GetLocalPageNum(i, next_page_id_);
+            for (auto local_id = segment.GetPageNum(); local_id > local_page_num; --local_id) {
+                segment.DeallocatePage((page_id_t)local_id - 1);
+            }
+        }
+    }
+
+    bool IsFreePage(page_id_t page_id) {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        return free_pages_.Contains(page_id);
+    }
+
+    size_t GetFreePageNum() {
+        std::lock_guard<std::mutex> guard(free_latch_);
+        return free_pages_.Size();
+    }
+
+    void ReadPage(page_id_t page_id, char *page_data) {
+        GetSegment(page_id).ReadPage(GetLocalId(page_id), page_data);
+    }
+
+    void WritePage(page_id_t page_id, const char *page_data) {
+        GetSegment(page_id).WritePage(GetLocalId(page_id), page_data);
+        GrowPageNum(page_id);
+    }
+
+    /**
+     *  @brief Read a batch of pages, each pair is a page id and the buffer receiving it.
+     */
+    void ReadPages(const std::vector<std::pair<page_id_t, char *>> &pages) {
+        TransferPages<char *>(pages, [](DiskManager &segment, std::vector<std::pair<page_id_t, char *>> &part) {
+            segment.ReadPages(std::move(part));
+        });
+    }
+
+    /**
+     *  @brief Write a batch of pages, each pair is a page id and the buffer holding it.
+     */
+    void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+        TransferPages<const char *>(pages, [](DiskManager &segment,
+                                              std::vector<std::pair<page_id_t, const char *>> &part) {
+            segment.WritePages(std::move(part));
+        });
+        for (auto &page : pages) GrowPageNum(page.first);
+    }
+
+    /**
+     *  @brief Make the pages written so far durable, one segment file after the other.
+     */
+    void Sync() {
+        for (auto &segment : segments_) segment->Sync();
+    }
+
+    /**
+     *  @brief Read a page asynchronously, on the engine of its segment, see DiskManager for a
+     *         page past the end of its segment.
+     *  @param callback run on an I/O thread once page_data holds the page
+     */
+    void ReadPageAsync(page_id_t page_id, char *page_data, std::function<void()> callback) {
+        GetSegment(page_id).ReadPageAsync(GetLocalId(page_id), page_data, std::move(callback));
+    }
+
+    /**
+     *  @brief Read a batch of pages asynchronously, each segment starting its part together.
+     *  @param callback run on an I/O thread with the index of each page in pages once it is read
+     */
+    void ReadPagesAsync(const std::vector<std::pair<page_id_t, char *>> &pages, std::function<void(size_t)> callback) {
+        std::vector<std::vector<std::pair<page_id_t, char *>>> parts(segments_.size());
+        std::vector<std::vector<size_t>> indexes(segments_.size());
+        for (size_t i = 0; i < pages.size(); ++i) {
+            size_t segment_index = GetSegmentIndex(pages[i].first);
+            parts[segment_index].emplace_back(GetLocalId(pages[i].first), pages[i].second);
+            indexes[segment_index].push_back(i);
+        }
+        for (size_t i = 0; i < segments_.size(); ++i) {
+            if (parts[i].empty()) continue;
+            segments_[i]->ReadPagesAsync(parts[i], [callback, index = std::move(indexes[i])](size_t j) {
+                callback(index[j]);
+            });
+        }
+    }
+
+    /**
+     *  @brief Write a page asynchronously, on the engine of its segment.
+     *  @param callback run on an I/O thread once the page is written
+     */
+    void WritePageAsync(page_id_t page_id, const char *page_data, std::function<void()> callback) {
+        GrowPageNum(page_id);
+        GetSegment(page_id).WritePageAsync(GetLocalId(page_id), page_data, std::move(callback));
+    }
+
+    std::future<void> ReadPageAsync(page_id_t page_id, char *page_data) {
+        return GetSegment(page_id).ReadPageAsync(GetLocalId(page_id), page_data);
+    }
+
+    std::future<void> WritePageAsync(page_id_t page_id, const char *page_data) {
+        GrowPageNum(page_id);
+        return GetSegment(page_id).WritePageAsync(GetLocalId(page_id), page_data);
+    }
+
+    size_t GetPageSize() const { return segments_[0]->GetPageSize(); }
+
+    bool IsDirectIO() const { return segments_[0]->IsDirectIO(); }
+
+    bool HasChecksums() const { return segments_[0]->HasChecksums(); }
+
+    /**
+     *  @brief The number of pages read whose checksum did not match, over all segments.
+     */
+    size_t GetChecksumFailureNum() const {
+        size_t failure_num = 0;
+        for (auto &segment : segments_) failure_num += segment->GetChecksumFailureNum();
+        return failure_num;
+    }
+
+    /**
+     *  @brief Returns one past the highest page id in use, pages below may be free.
+     */
+    size_t GetPageNum() const { return page_num_.load(); }
+
+    size_t GetSegmentNum() const { return segments_.size(); }
+
+    size_t GetExtentPageNum() const { return extent_page_num_; }
+
+    /**
+     *  @brief Returns the index of the segment file holding page_id.
+     */
+    size_t GetSegmentIndex(page_id_t page_id) const { return (size_t)page_id / extent_page_num_ % segments_.size(); }
+
+private:
+    std::vector<std::unique_ptr<DiskManager>> segments_;
+    size_t extent_page_num_;
+    // pages of one extent in every segment
+    size_t stripe_page_num_;
+    // one past the highest page written, grows with writes past the end
+    std::atomic<size_t> page_num_{0};
+    // protects free_pages_ and next_page_id_
+    std::mutex free_latch_;
+    FreePageList free_pages_;
+    // pages allocated so far, not all written yet
+    size_t next_page_id_ = 0;
+
+    DiskManager &GetSegment(page_id_t page_id) { return *segments_[GetSegmentIndex(page_id)]; }
+
+    /**
+     *  @brief Returns the page id of page_id within its segment.
+     */
+    page_id_t GetLocalId(page_id_t page_id) const {
+        return (page_id_t)((size_t)page_id / stripe_page_num_ * extent_page_num_ + (size_t)page_id % extent_page_num_);
+    }
+
+    /**
+     *  @brief Returns the page id of page local_id of segment index.
+     */
+    page_id_t GetGlobalId(const size_t index, page_id_t local_id) const {
+        return (page_id_t)((size_t)local_id / extent_page_num_ * stripe_page_num_ + index * extent_page_num_
+                           + (size_t)local_id % extent_page_num_);
+    }
+
+    /**
+     *  @brief Returns how many of the pages [0, page_num) segment index holds.
+     */
+    size_t GetLocalPageNum(const size_t index, const size_t page_num) const {
+        size_t rest = page_num % stripe_page_num_;
+        size_t extent_start = index * extent_page_num_;
+        size_t tail = rest > extent_start ? std::min(rest - extent_start, extent_page_num_) : 0;
+        return page_num / stripe_page_num_ * extent_page_num_ + tail;
+    }
+
+    void GrowPageNum(page_id_t page_id) {
+        size_t page_num = page_num_.load();
+        while (page_num <= (size_t)page_id && !page_num_.compare_exchange_weak(page_num, page_id + 1)) {}
+    }
+
+    /**
+     *  @brief Collect the free pages of the segments, and the pages past the end of a
+     *         segment but below the end of the tablespace.
+     */
+    void LoadFreePages() {
+        size_t page_num = 0;
+        for (size_t i = 0; i < segments_.size(); ++i) {
+            auto segment_page_num = segments_[i]->GetPageNum();
+            if (segment_page_num != 0) {
+                page_num = std::max<size_t>(page_num, GetGlobalId(i, (page_id_t)segment_page_num - 1) + 1);
+            }
+        }
+        for (size_t i = 0; i < segments_.size(); ++i) {
+            auto &segment = *segments_[i];
+            // the segments forget them until ShutDown hands them over again
+            while (segment.GetFreePageNum() != 0) free_pages_.Insert(GetGlobalId(i, segment.AllocatePage()));
+            for (auto local_id = segment.GetPageNum(); local_id < GetLocalPageNum(i, page_num); ++local_id) {
+                free_pages_.Insert(GetGlobalId(i, (page_id_t)local_id));
+            }
+        }
+        page_num_ = page_num;
+        next_page_id_ = page_num;
+    }
+
+    /**
+     *  @brief Split a batch by segment, and transfer the parts in parallel.
+     *  @param transfer callable (DiskManager &, std::vector<std::pair<page_id_t, Data>> &)
+     */
+    template<typename Data, typename Transfer>
+    void TransferPages(const std::vector<std::pair<page_id_t, Data>> &pages, Transfer transfer) {
+        std::vector<std::vector<std::pair<page_id_t, Data>>> parts(segments_.size());
+        for (auto &page : pages) parts[GetSegmentIndex(page.first)].emplace_back(GetLocalId(page.first), page.second);
+        std::vector<std::future<void>> futures;
+        size_t last = segments_.size();
+        for (size_t i = 0; i < segments_.size(); ++i) {
+            if (parts[i].empty()) continue;
+            if (last != segments_.size()) {
+                futures.push_back(std::async(std::launch::async, [this, &parts, &transfer, last]() {
+                    transfer(*segments_[last], parts[last]);
+                }));
+            }
+            last = i;
+        }
+        // the last part runs on the calling thread
+        if (last != segments_.size()) transfer(*segments_[last], parts[last]);
+        for (auto &future : futures) future.get();
+    }
+};
+
+} // dsbus
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "disk/disk_config.h"
+#include "disk/io_engine.hpp"
+
+namespace dsbus {
+
+/**
+ *  ThreadPoolIOEngine runs requests with blocking pread / pwrite on a pool of worker threads.
+ *
+ *  Submitted requests wait in a FIFO queue, each worker takes one at a time, so up to
+ *  thread_num requests are in the kernel at once. This is the portable engine, and the
+ *  fallback where io_uring is not available.
+ */
+class ThreadPoolIOEngine : public IOEngine {
+public:
+    explicit ThreadPoolIOEngine(const size_t thread_num = IO_ENGINE_THREAD_NUM) {
+        for (size_t i = 0; i < (thread_num == 0 ? 1 : thread_num); ++i) {
+            workers_.emplace_back([this]() { Work(); });
+        }
+    }
+
+    ~ThreadPoolIOEngine() override {
+        {
+            std::lock_guard<std::mutex> guard(latch_);
+            stop_ = true;
+        }
+        queue_cv_.notify_all();
+        for (auto &worker : workers_) worker.join();
+    }
+
+    void SubmitRead(int fd, char *buf, size_t size, off_t offset, IOCallback callback) override {
+        Submit(IORequest{false, fd, buf, size, offset, std::move(callback), {}});
+    }
+
+    void SubmitWrite(int fd, const char *buf, size_t size, off_t offset, IOCallback callback) override {
+        Submit(IORequest{true, fd, const_cast<char *>(buf), size, offset, std::move(callback), {}});
+    }
+
+    void Drain() override {
+        std::unique_lock<std::mutex> lock(latch_);
+        drain_cv_.wait(lock, [this]() { return inflight_ == 0; });
+    }
+
+    const char *GetName() const override { return "thread_pool"; }
+
+private:
+    std::vector<std::thread> workers_;
+    // protects queue_, inflight_ and stop_
+    std::mutex latch_;
+    std::condition_variable queue_cv_;
+    std::condition_variable drain_cv_;
+    std::deque<IORequest> queue_;
+    // requests submitted and not completed yet, queued ones included
+    size_t inflight_ = 0;
+    bool stop_ = false;
+
+    void Submit(IORequest &&request) {
+        {
+            std::lock_guard<std::mutex> guard(latch_);
+            queue_.push_back(std::move(request));
+            ++inflight_;
+        }
+        queue_cv_.notify_one();
+    }
+
+    void Work() {
+        while (true) {
+            IORequest request;
+            {
+                std::unique_lock<std::mutex> lock(latch_);
+                // requests still queued are run before stopping
+                queue_cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+                if (queue_.empty()) return;
+                request = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            ssize_t result = request.is_write_
+                           ? PWriteFull(request.fd_, request.buf_, request.size_, request.offset_)
+                           : PReadFull(request.fd_, request.buf_, request.size_, request.offset_);
+            if (request.callback_) request.callback_(result);
+            {
+                std::lock_guard<std::mutex> guard(latch_);
+                if (--inflight_ == 0) drain_cv_.notify_all();
+            }
+        }
+    }
+};
+
+} // dsbus
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "disk/disk_config.h"
+#include "log/log_config.h"
+#include "log/log_manager.hpp"
+#include "log/log_record.hpp"
+
+namespace dsbus {
+
+struct CheckpointOptions {
+    // take a checkpoint every interval in a background thread, 0 takes them only on Checkpoint()
+    size_t interval_ms_ = 0;
+};
+
+/**
+ *  CheckpointManager takes fuzzy checkpoints of a buffer pool and its write-ahead log, so that
+ *  recovery scans the log from the last checkpoint and redoes from the lowest recLSN.
+ *
+ *  A checkpoint appends CHECKPOINT_BEGIN, takes the active transaction table of the LogManager
+ *  and the dirty page table of the buffer pool, and appends them in CHECKPOINT_END. Nothing is
+ *  written but the log: pages are neither flushed nor latched longer than to read their recLSN,
+ *  so foreground work goes on. Pages written since the last checkpoint left the dirty page table
+ *  without being synced, so the Disk is synced before CHECKPOINT_END, whose redo point no longer
+ *  covers them. Once CHECKPOINT_END is durable the header of the log names the
+ *  checkpoint, and the background writer of the buffer pool is handed the dirty pages, oldest
+ *  recLSN first, to write a round at a time. The next checkpoint then has a later redo point.
+ *
+ *  The buffer pool must be given the LogManager in its options. Checkpoints are taken one at a
+ *  time, by a thread holding no page latch.
+ */
+template<typename BufferPool>
+class CheckpointManager {
+public:
+    /**
+     *  @param log_manager the write-ahead log of bpm.
+     *  @param bpm the buffer pool.
+     *  @param options see CheckpointOptions.
+     */
+    CheckpointManager(LogManager *log_manager, BufferPool *bpm, const CheckpointOptions &options = CheckpointOptions())
+                    : log_manager_(log_manager), bpm_(bpm), options_(options) {
+        if (options_.interval_ms_ != 0) checkpointer_ = std::thread(&CheckpointManager::RunCheckpointer, this);
+    }
+
+    ~CheckpointManager() {
+        if (checkpointer_.joinable()) {
+            {
+                std::lock_guard<std::mutex> guard(stop_latch_);
+                stop_ = true;
+            }
+            stop_cv_.notify_one();
+            checkpointer_.join();
+        }
+    }
+
+    /**
+     *  @brief Take a fuzzy checkpoint.
+     *  @return the LSN of its CHECKPOINT_BEGIN, where recovery starts from now on
+     */
+    lsn_t Checkpoint() {
+        std::lock_guard<std::mutex> guard(checkpoint_latch_);
+        LogRecord begin(LogRecordType::CHECKPOINT_BEGIN, INVALID_TXN_ID, INVALID_LSN);
+        lsn_t begin_lsn = log_manager_->AppendLogRecord(&begin);
+        auto active_txns = log_manager_->GetActiveTxnTable();
+        auto dirty_pages = bpm_->GetDirtyPageTable();
+        // pages written before are clean, their changes must be durable before the redo point moves past them
+        bpm_->SyncData();
+        std::sort(dirty_pages.begin(), dirty_pages.end(),
+                  [](const std::pair<page_id_t, lsn_t> &a, const std::pair<page_id_t, lsn_t> &b) {
+                      return a.second < b.second;
+                  });
+        lsn_t redo_lsn = dirty_pages.empty() ? begin_lsn : std::min(begin_lsn, dirty_pages[0].second);
+        std::vector<page_id_t> page_ids;
+        page_ids.reserve(dirty_pages.size());
+        for (auto &page : dirty_pages) page_ids.push_back(page.first);
+        LogRecord end(redo_lsn, std::move(active_txns), std::move(dirty_pages));
+        if (end.GetSize() > log_manager_->GetBufferSize()) end.DropDirtyPages();
+        log_manager_->Flush(log_manager_->AppendLogRecord(&end));
+        log_manager_->SetCheckpointLSN(begin_lsn);
+        bpm_->DrainDirtyPages(page_ids);
+        ++checkpoint_num_;
+        last_redo_lsn_ = redo_lsn;
+        return begin_lsn;
+    }
+
+    /**
+     *  @brief The number of checkpoints taken.
+     */
+    size_t GetCheckpointNum() {
+        std::lock_guard<std::mutex> guard(checkpoint_latch_);
+        return checkpoint_num_;
+    }
+
+    /**
+     *  @brief Returns where redo starts from the last checkpoint, INVALID_LSN if none was taken.
+     */
+    lsn_t GetRedoLSN() {
+        std::lock_guard<std::mutex> guard(checkpoint_latch_);
+        return last_redo_lsn_;
+    }
+
+private:
+    LogManager *log_manager_;
+    BufferPool *bpm_;
+    CheckpointOptions options_;
+    // one checkpoint at a time, protects the counters below
+    std::mutex checkpoint_latch_;
+    size_t checkpoint_num_ = 0;
+    lsn_t last_redo_lsn_ = INVALID_LSN;
+    std::thread checkpointer_;
+    std::mutex stop_latch_;
+    std::condition_variable stop_cv_;
+    bool stop_ = false;
+
+    void RunCheckpointer() {
+        std::unique_lock<std::mutex> lock(stop_latch_);
+        while (!stop_cv_.wait_for(lock, std::chrono::milliseconds(options_.interval_ms_), [this]() { return stop_; })) {
+            lock.unlock();
+            Checkpoint();
+            lock.lock();
+        }
+    }
+};
+
+} // dsbus
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "disk/disk_config.h"
+
+namespace dsbus {
+
+using txn_id_t = int64_t;
+static constexpr txn_id_t INVALID_TXN_ID = -1;
+
+// size of each of the two buffers of LogManager, one is filled while the other is written
+static constexpr size_t LOG_BUFFER_SIZE = 1 << 20;
+
+// the log flusher writes the log buffer at least this often, see LogManagerOptions
+static constexpr size_t LOG_FLUSH_INTERVAL_MS = 10;
+
+// bytes of log recovery reads at once, and redoes in parallel
+static constexpr size_t LOG_REDO_BATCH_SIZE = 8 << 20;
+
+// the log file starts with a header, the first log record follows at this LSN
+static constexpr size_t LOG_FILE_HEADER_SIZE = 16;
+
+} // dsbus
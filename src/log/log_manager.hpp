@@ -0,0 +1,333 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "slice/slice.hpp"
+#include "disk/io_engine.hpp"
+#include "log/log_config.h"
+#include "log/log_record.hpp"
+
+namespace dsbus {
+
+struct LogManagerOptions {
+    // size of each of the two log buffers, the largest record that can be appended
+    size_t buffer_size_ = LOG_BUFFER_SIZE;
+    // the flusher writes what was appended at least this often, even if nobody waits for it
+    size_t flush_interval_ms_ = LOG_FLUSH_INTERVAL_MS;
+};
+
+/**
+ *  LogManager appends log records to the write-ahead log, and makes them durable.
+ *
+ *  The LSN of a record is its offset in the log file, so LSNs grow with every record and a
+ *  record is found from its LSN. The file starts with a header of LOG_FILE_HEADER_SIZE bytes.
+ *
+ *  AppendLogRecord copies a record into the log buffer, and returns at once. A flusher thread
+ *  swaps the buffer with a second one, writes it with one pwrite and makes it durable with one
+ *  fdatasync, while appending goes on in the other buffer. Flush waits until a record is
+ *  durable: that is group commit, transactions committing while the flusher is busy are all
+ *  made durable by its next fdatasync.
+ *
+ *  A BufferPoolManager given a LogManager in BufferPoolOptions flushes the log up to the LSN of
+ *  a page before writing the page, so that no change reaches the db file before its log record.
+ *
+ *  The LogManager keeps the active transaction table, the last LSN of each transaction that
+ *  neither committed nor aborted, for checkpoints. The header of the file holds the LSN of the
+ *  last complete checkpoint, where recovery starts.
+ *
+ *  Opening a log scans it, a tail torn by a crash is cut off. All methods are thread safe.
+ */
+class LogManager {
+public:
+    /**
+     *  @brief Open or create a log file, and start the flusher.
+     *
+     *  @param log_file_name log file path.
+     *  @param options see LogManagerOptions.
+     */
+    LogManager(const Slice &log_file_name, const LogManagerOptions &options = LogManagerOptions())
+             : options_(options), append_buffer_(options.buffer_size_), flush_buffer_(options.buffer_size_) {
+        log_fd_ = open(log_file_name.Data(), O_RDWR | O_CREAT, 0644);
+        if (log_fd_ < 0) {
+            std::cerr << "can't open log file" << std::endl;
+            exit(0);
+        }
+        char header[LOG_FILE_HEADER_SIZE] = {};
+        ssize_t result = PReadFull(log_fd_, header, LOG_FILE_HEADER_SIZE, 0);
+        if (result == 0) {
+            memcpy(header, &LOG_FILE_MAGIC, sizeof(LOG_FILE_MAGIC));
+            if (PWriteFull(log_fd_, header, LOG_FILE_HEADER_SIZE, 0) != (ssize_t)LOG_FILE_HEADER_SIZE) {
+                std::cerr << "I/O error while writing log" << std::endl;
+                exit(0);
+            }
+            Sync();
+        } else if (result != (ssize_t)LOG_FILE_HEADER_SIZE
+                   || memcmp(header, &LOG_FILE_MAGIC, sizeof(LOG_FILE_MAGIC)) != 0) {
+            std::cerr << "not a log file" << std::endl;
+            exit(0);
+        }
+        memcpy(&checkpoint_lsn_, header + sizeof(LOG_FILE_MAGIC), sizeof(checkpoint_lsn_));
+        next_lsn_ = ScanLog();
+        persistent_lsn_ = next_lsn_;
+        flusher_ = std::thread(&LogManager::RunFlusher, this);
+    }
+
+    /**
+     *  @brief Make every appended record durable, and stop the flusher.
+     */
+    ~LogManager() {
+        {
+            std::lock_guard<std::mutex> guard(latch_);
+            stop_ = true;
+        }
+        flush_cv_.notify_one();
+        flusher_.join();
+        close(log_fd_);
+    }
+
+    /**
+     *  @brief Append a record to the log buffer, it is durable once Flush(lsn) returns.
+     *
+     *  Waits for room if the buffer is full.
+     *
+     *  @param record its LSN is set
+     *  @return the LSN of the record
+     */
+    lsn_t AppendLogRecord(LogRecord *record) {
+        size_t size = record->GetSize();
+        if (size > options_.buffer_size_) {
+            std::cerr << "log record larger than the log buffer" << std::endl;
+            exit(0);
+        }
+        std::unique_lock<std::mutex> lock(latch_);
+        while (append_size_ + size > options_.buffer_size_) {
+            flush_requested_ = true;
+            flush_cv_.notify_one();
+            append_cv_.wait(lock);
+        }
+        lsn_t lsn = next_lsn_;
+        record->SetLSN(lsn);
+        record->Serialize(append_buffer_.data() + append_size_);
+        append_size_ += size;
+        next_lsn_ += size;
+        auto txn_id = record->GetTxnId();
+        if (txn_id != INVALID_TXN_ID) {
+            if (record->GetType() == LogRecordType::COMMIT || record->GetType() == LogRecordType::ABORT) {
+                active_txns_.erase(txn_id);
+            } else {
+                active_txns_[txn_id] = lsn;
+            }
+        }
+        return lsn;
+    }
+
+    /**
+     *  @brief Wait until the record at lsn, and all before it, are durable.
+     *
+     *  Nothing to wait for if lsn is INVALID_LSN, or 0 as in a page never logged.
+     */
+    void Flush(const lsn_t lsn) {
+        std::unique_lock<std::mutex> lock(latch_);
+        while (persistent_lsn_ <= lsn && persistent_lsn_ < next_lsn_) {
+            flush_requested_ = true;
+            flush_cv_.notify_one();
+            persist_cv_.wait(lock);
+        }
+    }
+
+    /**
+     *  @brief Wait until every record appended so far is durable.
+     */
+    void FlushAll() {
+        std::unique_lock<std::mutex> lock(latch_);
+        lsn_t end_lsn = next_lsn_;
+        lock.unlock();
+        Flush(end_lsn - 1);
+    }
+
+    /**
+     *  @brief Returns the LSN the next record will get.
+     */
+    lsn_t GetNextLSN() {
+        std::lock_guard<std::mutex> guard(latch_);
+        return next_lsn_;
+    }
+
+    /**
+     *  @brief Returns the LSN up to which the log is durable, records before it are.
+     */
+    lsn_t GetPersistentLSN() {
+        std::lock_guard<std::mutex> guard(latch_);
+        return persistent_lsn_;
+    }
+
+    /**
+     *  @brief Read the durable log from lsn, up to size bytes.
+     *  @return the number of bytes read, fewer than size at the end of the durable log
+     */
+    size_t ReadLog(const lsn_t lsn, char *buf, const size_t size) {
+        lsn_t end_lsn = GetPersistentLSN();
+        if (lsn >= end_lsn) return 0;
+        size_t read_size = std::min(size, (size_t)(end_lsn - lsn));
+        if (PReadFull(log_fd_, buf, read_size, lsn) != (ssize_t)read_size) {
+            std::cerr << "I/O error while reading log" << std::endl;
+            exit(0);
+        }
+        return read_size;
+    }
+
+    /**
+     *  @brief Returns the last LSN of each transaction that neither committed nor aborted.
+     */
+    std::vector<std::pair<txn_id_t, lsn_t>> GetActiveTxnTable() {
+        std::lock_guard<std::mutex> guard(latch_);
+        return std::vector<std::pair<txn_id_t, lsn_t>>(active_txns_.begin(), active_txns_.end());
+    }
+
+    /**
+     *  @brief Returns the LSN of the CHECKPOINT_BEGIN of the last complete checkpoint,
+     *         INVALID_LSN if none.
+     */
+    lsn_t GetCheckpointLSN() {
+        std::lock_guard<std::mutex> guard(checkpoint_latch_);
+        return checkpoint_lsn_ < (lsn_t)LOG_FILE_HEADER_SIZE ? INVALID_LSN : checkpoint_lsn_;
+    }
+
+    /**
+     *  @brief Make lsn, a durable CHECKPOINT_BEGIN whose CHECKPOINT_END is durable too, the
+     *         checkpoint recovery starts at, in the header of the file.
+     */
+    void SetCheckpointLSN(const lsn_t lsn) {
+        std::lock_guard<std::mutex> guard(checkpoint_latch_);
+        if (PWriteFull(log_fd_, (const char *)&lsn, sizeof(lsn), sizeof(LOG_FILE_MAGIC)) != (ssize_t)sizeof(lsn)) {
+            std::cerr << "I/O error while writing log" << std::endl;
+            exit(0);
+        }
+        Sync();
+        checkpoint_lsn_ = lsn;
+    }
+
+    /**
+     *  @brief Returns the size of a log buffer, no record is larger.
+     */
+    size_t GetBufferSize() const { return options_.buffer_size_; }
+
+    /**
+     *  @brief The number of fdatasync calls of the flusher, one per group of records.
+     */
+    size_t GetFlushNum() {
+        std::lock_guard<std::mutex> guard(latch_);
+        return flush_num_;
+    }
+
+private:
+    static constexpr uint64_t LOG_FILE_MAGIC = 0x474f4c5355425344; // "DSBUSLOG"
+
+    LogManagerOptions options_;
+    int log_fd_ = -1;
+    // protects everything below but the content of flush_buffer_, owned by the flusher
+    std::mutex latch_;
+    // wakes up the flusher
+    std::condition_variable flush_cv_;
+    // room was made in the append buffer
+    std::condition_variable append_cv_;
+    // persistent_lsn_ moved
+    std::condition_variable persist_cv_;
+    std::vector<char> append_buffer_;
+    std::vector<char> flush_buffer_;
+    size_t append_size_ = 0;
+    lsn_t next_lsn_ = LOG_FILE_HEADER_SIZE;
+    // the log up to here is on disk, the append buffer starts here unless being written
+    lsn_t persistent_lsn_ = LOG_FILE_HEADER_SIZE;
+    bool flush_requested_ = false;
+    bool stop_ = false;
+    size_t flush_num_ = 0;
+    std::unordered_map<txn_id_t, lsn_t> active_txns_;
+    std::thread flusher_;
+    // protects checkpoint_lsn_ and its copy in the header
+    std::mutex checkpoint_latch_;
+    lsn_t checkpoint_lsn_ = INVALID_LSN;
+
+    void Sync() {
+        if (fdatasync(log_fd_) != 0) {
+            std::cerr << "I/O error while syncing log" << std::endl;
+            exit(0);
+        }
+    }
+
+    /**
+     *  @brief Find the end of the last whole record, and cut off what follows.
+     *  @return the LSN of the next record
+     */
+    lsn_t ScanLog() {
+        lsn_t lsn = LOG_FILE_HEADER_SIZE;
+        // a record is never larger than the buffer, so each read holds the next whole record
+        std::vector<char> buf(options_.buffer_size_);
+        LogRecord record;
+        while (true) {
+            ssize_t size = PReadFull(log_fd_, buf.data(), buf.size(), lsn);
+            if (size < 0) {
+                std::cerr << "I/O error while reading log" << std::endl;
+                exit(0);
+            }
+            size_t pos = 0;
+            while (record.Deserialize(buf.data() + pos, size - pos) && record.GetLSN() == lsn + (lsn_t)pos) {
+                pos += record.GetSize();
+            }
+            lsn += pos;
+            if (pos == 0 || size < (ssize_t)buf.size()) break;
+        }
+        if (ftruncate(log_fd_, lsn) != 0) {
+            std::cerr << "I/O error while truncating log" << std::endl;
+            exit(0);
+        }
+        return lsn;
+    }
+
+    /**
+     *  @brief Body of the flusher thread, writes the append buffer when asked to, or every
+     *         flush interval, until the LogManager is destroyed.
+     */
+    void RunFlusher() {
+        std::unique_lock<std::mutex> lock(latch_);
+        while (true) {
+            flush_cv_.wait_for(lock, std::chrono::milliseconds(options_.flush_interval_ms_),
+                               [this]() { return flush_requested_ || stop_; });
+            flush_requested_ = false;
+            if (append_size_ != 0) {
+                std::swap(append_buffer_, flush_buffer_);
+                size_t size = append_size_;
+                lsn_t start_lsn = persistent_lsn_;
+                lsn_t end_lsn = next_lsn_;
+                append_size_ = 0;
+                lock.unlock();
+                append_cv_.notify_all();
+                if (PWriteFull(log_fd_, flush_buffer_.data(), size, start_lsn) != (ssize_t)size) {
+                    std::cerr << "I/O error while writing log" << std::endl;
+                    exit(0);
+                }
+                Sync();
+                lock.lock();
+                persistent_lsn_ = end_lsn;
+                ++flush_num_;
+                persist_cv_.notify_all();
+            }
+            if (stop_ && append_size_ == 0) return;
+        }
+    }
+};
+
+} // dsbus
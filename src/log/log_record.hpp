@@ -0,0 +1,276 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/crc32c.h"
+#include "log/log_config.h"
+
+namespace dsbus {
+
+enum class LogRecordType : uint32_t {
+    INVALID = 0,
+    BEGIN,
+    COMMIT,
+    ABORT,
+    // bytes of a page changed, with their before and after images
+    UPDATE,
+    // compensation, an UPDATE undone during rollback, redone but never undone itself
+    CLR,
+    // a fuzzy checkpoint starts, and ends with the tables taken since
+    CHECKPOINT_BEGIN,
+    CHECKPOINT_END
+};
+
+/**
+ *  LogRecord is one entry of the write-ahead log.
+ *
+ *  A header, then the payload of the type:
+ *
+ *    | size (uint32_t) | checksum (uint32_t) | lsn | prev_lsn | txn_id | type (uint32_t) | 0 (uint32_t) |
+ *    UPDATE: | page_id | offset (uint32_t) | length (uint32_t) | before image | after image |
+ *    CLR:    | page_id | offset (uint32_t) | length (uint32_t) | undo_next_lsn | after image |
+ *    CHECKPOINT_END: | redo_lsn | txn num (uint32_t) | page num (uint32_t) |
+ *                    | txn_id | last lsn | ... | page_id | rec lsn | ... |
+ *
+ *  size covers the whole record, and checksum is the CRC32C of what follows it, so that a
+ *  record torn by a crash is told apart from a complete one. prev_lsn links the records of
+ *  one transaction, newest first. offset is within the content of the page, after its header.
+ *
+ *  A CLR writes back the before image of the UPDATE it compensates, undo_next_lsn is the
+ *  prev_lsn of that UPDATE, the next record of the transaction left to undo.
+ *
+ *  A CHECKPOINT_END holds the active transaction table and the dirty page table of a buffer
+ *  pool, and redo_lsn, the lowest recLSN of the dirty pages. The dirty page table may be left
+ *  out, when too large for a record, redo_lsn alone is then enough to recover.
+ */
+class LogRecord {
+public:
+    static constexpr size_t HEADER_SIZE = 40;
+    static constexpr size_t UPDATE_HEADER_SIZE = 16;
+    static constexpr size_t CLR_HEADER_SIZE = 24;
+    static constexpr size_t CHECKPOINT_HEADER_SIZE = 16;
+    static constexpr size_t CHECKPOINT_ENTRY_SIZE = 16;
+
+    LogRecord() = default;
+
+    /**
+     *  @brief A record without payload, BEGIN, COMMIT or ABORT.
+     */
+    LogRecord(const LogRecordType type, const txn_id_t txn_id, const lsn_t prev_lsn)
+            : type_(type), prev_lsn_(prev_lsn), txn_id_(txn_id) {}
+
+    /**
+     *  @brief An UPDATE of length bytes at offset in page page_id, from before to after.
+     */
+    LogRecord(const txn_id_t txn_id, const lsn_t prev_lsn, const page_id_t page_id, const uint32_t offset,
+              const char *before, const char *after, const uint32_t length)
+            : type_(LogRecordType::UPDATE), prev_lsn_(prev_lsn), txn_id_(txn_id), page_id_(page_id),
+              offset_(offset), before_(before, length), after_(after, length) {}
+
+    /**
+     *  @brief A CLR writing image back to length bytes at offset in page page_id.
+     */
+    LogRecord(const txn_id_t txn_id, const lsn_t prev_lsn, const page_id_t page_id, const uint32_t offset,
+              const char *image, const uint32_t length, const lsn_t undo_next_lsn)
+            : type_(LogRecordType::CLR), prev_lsn_(prev_lsn), txn_id_(txn_id), page_id_(page_id),
+              offset_(offset), undo_next_lsn_(undo_next_lsn), after_(image, length) {}
+
+    /**
+     *  @brief A CHECKPOINT_END with the active transactions and the dirty pages.
+     */
+    LogRecord(const lsn_t redo_lsn, std::vector<std::pair<txn_id_t, lsn_t>> active_txns,
+              std::vector<std::pair<page_id_t, lsn_t>> dirty_pages)
+            : type_(LogRecordType::CHECKPOINT_END), redo_lsn_(redo_lsn), active_txns_(std::move(active_txns)),
+              dirty_pages_(std::move(dirty_pages)) {}
+
+    size_t GetSize() const {
+        switch (type_) {
+            case LogRecordType::UPDATE: return HEADER_SIZE + UPDATE_HEADER_SIZE + 2 * after_.size();
+            case LogRecordType::CLR: return HEADER_SIZE + CLR_HEADER_SIZE + after_.size();
+            case LogRecordType::CHECKPOINT_END:
+                return HEADER_SIZE + CHECKPOINT_HEADER_SIZE
+                     + CHECKPOINT_ENTRY_SIZE * (active_txns_.size() + dirty_pages_.size());
+            default: return HEADER_SIZE;
+        }
+    }
+
+    /**
+     *  @brief UPDATE and CLR change a page, and are redone.
+     */
+    bool IsPageChange() const { return type_ == LogRecordType::UPDATE || type_ == LogRecordType::CLR; }
+
+    LogRecordType GetType() const { return type_; }
+
+    lsn_t GetLSN() const { return lsn_; }
+
+    void SetLSN(const lsn_t lsn) { lsn_ = lsn; }
+
+    lsn_t GetPrevLSN() const { return prev_lsn_; }
+
+    txn_id_t GetTxnId() const { return txn_id_; }
+
+    page_id_t GetPageId() const { return page_id_; }
+
+    uint32_t GetOffset() const { return offset_; }
+
+    uint32_t GetLength() const { return (uint32_t)after_.size(); }
+
+    lsn_t GetUndoNextLSN() const { return undo_next_lsn_; }
+
+    const char *GetBefore() const { return before_.data(); }
+
+    const char *GetAfter() const { return after_.data(); }
+
+    lsn_t GetRedoLSN() const { return redo_lsn_; }
+
+    const std::vector<std::pair<txn_id_t, lsn_t>> &GetActiveTxns() const { return active_txns_; }
+
+    const std::vector<std::pair<page_id_t, lsn_t>> &GetDirtyPages() const { return dirty_pages_; }
+
+    /**
+     *  @brief Leave out the dirty pages of a CHECKPOINT_END, keeping redo_lsn.
+     */
+    void DropDirtyPages() { dirty_pages_.clear(); }
+
+    /**
+     *  @brief Write the record to buf, which has room for GetSize() bytes.
+     */
+    void Serialize(char *buf) const {
+        uint32_t size = (uint32_t)GetSize();
+        uint32_t type = (uint32_t)type_;
+        uint32_t reserved = 0;
+        memcpy(buf, &size, sizeof(size));
+        memcpy(buf + 8, &lsn_, sizeof(lsn_));
+        memcpy(buf + 16, &prev_lsn_, sizeof(prev_lsn_));
+        memcpy(buf + 24, &txn_id_, sizeof(txn_id_));
+        memcpy(buf + 32, &type, sizeof(type));
+        memcpy(buf + 36, &reserved, sizeof(reserved));
+        if (IsPageChange()) {
+            uint32_t length = GetLength();
+            char *payload = buf + HEADER_SIZE;
+            memcpy(payload, &page_id_, sizeof(page_id_));
+            memcpy(payload + 8, &offset_, sizeof(offset_));
+            memcpy(payload + 12, &length, sizeof(length));
+            if (type_ == LogRecordType::UPDATE) {
+                memcpy(payload + UPDATE_HEADER_SIZE, before_.data(), length);
+                memcpy(payload + UPDATE_HEADER_SIZE + length, after_.data(), length);
+            } else {
+                memcpy(payload + 16, &undo_next_lsn_, sizeof(undo_next_lsn_));
+                memcpy(payload + CLR_HEADER_SIZE, after_.data(), length);
+            }
+        } else if (type_ == LogRecordType::CHECKPOINT_END) {
+            char *payload = buf + HEADER_SIZE;
+            uint32_t txn_num = (uint32_t)active_txns_.size();
+            uint32_t page_num = (uint32_t)dirty_pages_.size();
+            memcpy(payload, &redo_lsn_, sizeof(redo_lsn_));
+            memcpy(payload + 8, &txn_num, sizeof(txn_num));
+            memcpy(payload + 12, &page_num, sizeof(page_num));
+            char *entry = payload + CHECKPOINT_HEADER_SIZE;
+            for (auto &txn : active_txns_) entry = SerializeEntry(entry, txn.first, txn.second);
+            for (auto &page : dirty_pages_) entry = SerializeEntry(entry, page.first, page.second);
+        }
+        uint32_t checksum = Crc32c(buf + 8, size - 8);
+        memcpy(buf + 4, &checksum, sizeof(checksum));
+    }
+
+    /**
+     *  @brief Read the record at the start of buf, which holds size bytes.
+     *  @return false if buf does not start with a whole record, or its checksum does not match
+     */
+    bool Deserialize(const char *buf, const size_t size) {
+        if (size < HEADER_SIZE) return false;
+        uint32_t record_size;
+        uint32_t checksum;
+        uint32_t type;
+        memcpy(&record_size, buf, sizeof(record_size));
+        memcpy(&checksum, buf + 4, sizeof(checksum));
+        if (record_size < HEADER_SIZE || record_size > size || checksum != Crc32c(buf + 8, record_size - 8)) {
+            return false;
+        }
+        memcpy(&lsn_, buf + 8, sizeof(lsn_));
+        memcpy(&prev_lsn_, buf + 16, sizeof(prev_lsn_));
+        memcpy(&txn_id_, buf + 24, sizeof(txn_id_));
+        memcpy(&type, buf + 32, sizeof(type));
+        type_ = (LogRecordType)type;
+        page_id_ = INVALID_PAGE_ID;
+        offset_ = 0;
+        undo_next_lsn_ = INVALID_LSN;
+        redo_lsn_ = INVALID_LSN;
+        before_.clear();
+        after_.clear();
+        active_txns_.clear();
+        dirty_pages_.clear();
+        if (IsPageChange()) {
+            const char *payload = buf + HEADER_SIZE;
+            bool is_update = type_ == LogRecordType::UPDATE;
+            size_t payload_header_size = is_update ? UPDATE_HEADER_SIZE : CLR_HEADER_SIZE;
+            uint32_t length;
+            if (record_size < HEADER_SIZE + payload_header_size) return false;
+            memcpy(&page_id_, payload, sizeof(page_id_));
+            memcpy(&offset_, payload + 8, sizeof(offset_));
+            memcpy(&length, payload + 12, sizeof(length));
+            if (record_size != HEADER_SIZE + payload_header_size + (is_update ? 2 : 1) * (size_t)length) return false;
+            if (is_update) {
+                before_.assign(payload + UPDATE_HEADER_SIZE, length);
+                after_.assign(payload + UPDATE_HEADER_SIZE + length, length);
+            } else {
+                memcpy(&undo_next_lsn_, payload + 16, sizeof(undo_next_lsn_));
+                after_.assign(payload + CLR_HEADER_SIZE, length);
+            }
+        } else if (type_ == LogRecordType::CHECKPOINT_END) {
+            const char *payload = buf + HEADER_SIZE;
+            uint32_t txn_num;
+            uint32_t page_num;
+            if (record_size < HEADER_SIZE + CHECKPOINT_HEADER_SIZE) return false;
+            memcpy(&redo_lsn_, payload, sizeof(redo_lsn_));
+            memcpy(&txn_num, payload + 8, sizeof(txn_num));
+            memcpy(&page_num, payload + 12, sizeof(page_num));
+            if (record_size != HEADER_SIZE + CHECKPOINT_HEADER_SIZE
+                             + CHECKPOINT_ENTRY_SIZE * ((size_t)txn_num + page_num)) {
+                return false;
+            }
+            const char *entry = payload + CHECKPOINT_HEADER_SIZE;
+            active_txns_.resize(txn_num);
+            dirty_pages_.resize(page_num);
+            for (auto &txn : active_txns_) entry = DeserializeEntry(entry, &txn.first, &txn.second);
+            for (auto &page : dirty_pages_) entry = DeserializeEntry(entry, &page.first, &page.second);
+        }
+        return record_size == GetSize();
+    }
+
+private:
+    LogRecordType type_ = LogRecordType::INVALID;
+    lsn_t lsn_ = INVALID_LSN;
+    lsn_t prev_lsn_ = INVALID_LSN;
+    txn_id_t txn_id_ = INVALID_TXN_ID;
+    // UPDATE and CLR only
+    page_id_t page_id_ = INVALID_PAGE_ID;
+    uint32_t offset_ = 0;
+    // CLR only
+    lsn_t undo_next_lsn_ = INVALID_LSN;
+    // UPDATE only
+    std::string before_;
+    std::string after_;
+    // CHECKPOINT_END only
+    lsn_t redo_lsn_ = INVALID_LSN;
+    std::vector<std::pair<txn_id_t, lsn_t>> active_txns_;
+    std::vector<std::pair<page_id_t, lsn_t>> dirty_pages_;
+
+    static char *SerializeEntry(char *entry, const int64_t id, const lsn_t lsn) {
+        memcpy(entry, &id, sizeof(id));
+        memcpy(entry + 8, &lsn, sizeof(lsn));
+        return entry + CHECKPOINT_ENTRY_SIZE;
+    }
+
+    static const char *DeserializeEntry(const char *entry, int64_t *id, lsn_t *lsn) {
+        memcpy(id, entry, sizeof(*id));
+        memcpy(lsn, entry + 8, sizeof(*lsn));
+        return entry + CHECKPOINT_ENTRY_SIZE;
+    }
+};
+
+} // dsbus
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "buffer/page_guard.hpp"
+#include "disk/disk_config.h"
+#include "disk/disk_page.hpp"
+#include "log/log_config.h"
+#include "log/log_manager.hpp"
+#include "log/log_record.hpp"
+
+namespace dsbus {
+
+struct LogRecoveryOptions {
+    // threads redoing the log, each redoes the pages of one partition of the page ids
+    size_t redo_thread_num_ = std::max(1u, std::thread::hardware_concurrency());
+    // bytes of log read and redone in parallel at once, at least the size of a log buffer
+    size_t redo_batch_size_ = LOG_REDO_BATCH_SIZE;
+};
+
+/**
+ *  LogRecovery brings a buffer pool back to a consistent state after a crash, from the
+ *  write-ahead log of a LogManager, in the three passes of ARIES:
+ *
+ *  Analysis scans the log from the last checkpoint, and rebuilds the dirty page table, the
+ *  first LSN that may have changed each page not on disk yet (its recLSN), and the active
+ *  transaction table, the last LSN of each transaction that neither committed nor aborted.
+ *  Both start from the tables in CHECKPOINT_END, see CheckpointManager.
+ *
+ *  Redo repeats history from the lowest recLSN: every UPDATE and CLR whose LSN is above the
+ *  LSN of its page is applied again, and the page takes its LSN. Redo runs redo_thread_num_
+ *  threads, thread i redoes the pages whose id is i modulo the thread number, so the records
+ *  of a page are still redone in LSN order and no two threads share a page.
+ *
+ *  Undo rolls back the losers, the transactions left in the active transaction table, newest
+ *  record first over all of them. Each UPDATE undone is logged as a CLR, whose undo_next_lsn
+ *  skips what was undone already, so a crash during undo never undoes a record twice. A
+ *  loser rolled back ends with an ABORT record. The log is flushed once undo is done.
+ *
+ *  Without checkpoint, analysis starts at the first record. Recover must run before the buffer
+ *  pool serves anyone else, on a pool given the LogManager in its options.
+ *  Pages the log changes but the db file does not hold yet are created on the Disk.
+ */
+template<typename BufferPool, typename Disk>
+class LogRecovery {
+public:
+    /**
+     *  @param log_manager the log, opened on the log file of the crashed run.
+     *  @param bpm the buffer pool to recover, on disk_manager.
+     *  @param disk_manager the db file of the crashed run.
+     *  @param options see LogRecoveryOptions.
+     */
+    LogRecovery(LogManager *log_manager, BufferPool *bpm, Disk *disk_manager,
+                const LogRecoveryOptions &options = LogRecoveryOptions())
+              : log_manager_(log_manager), bpm_(bpm), disk_manager_(disk_manager), options_(options) {
+        options_.redo_thread_num_ = std::max<size_t>(1, options_.redo_thread_num_);
+        options_.redo_batch_size_ = std::max(options_.redo_batch_size_, log_manager_->GetBufferSize());
+    }
+
+    /**
+     *  @brief Run analysis, redo and undo.
+     */
+    void Recover() {
+        Analyze();
+        Redo();
+        Undo();
+    }
+
+    /**
+     *  @brief Returns the recLSN of each page, as found by analysis.
+     */
+    const std::unordered_map<page_id_t, lsn_t> &GetDirtyPageTable() const { return dirty_page_table_; }
+
+    /**
+     *  @brief Returns the last LSN of each loser, as found by analysis.
+     */
+    const std::unordered_map<txn_id_t, lsn_t> &GetActiveTxnTable() const { return active_txn_table_; }
+
+    /**
+     *  @brief Returns the highest transaction id in the log, new transactions take higher ones.
+     */
+    txn_id_t GetMaxTxnId() const { return max_txn_id_; }
+
+    /**
+     *  @brief The number of records applied again by redo.
+     */
+    size_t GetRedoNum() const { return redo_num_.load(); }
+
+    /**
+     *  @brief The number of UPDATE records rolled back by undo.
+     */
+    size_t GetUndoNum() const { return undo_num_; }
+
+private:
+    LogManager *log_manager_;
+    BufferPool *bpm_;
+    Disk *disk_manager_;
+    LogRecoveryOptions options_;
+    std::unordered_map<page_id_t, lsn_t> dirty_page_table_;
+    std::unordered_map<txn_id_t, lsn_t> active_txn_table_;
+    // the last LSN of each loser, as undo appends CLRs
+    std::unordered_map<txn_id_t, lsn_t> undo_last_lsns_;
+    txn_id_t max_txn_id_ = INVALID_TXN_ID;
+    std::atomic<size_t> redo_num_{0};
+    size_t undo_num_ = 0;
+    // where analysis started, the last checkpoint
+    lsn_t start_lsn_ = LOG_FILE_HEADER_SIZE;
+    // where redo starts, INVALID_LSN if nothing to redo
+    lsn_t redo_lsn_ = INVALID_LSN;
+    // a checkpoint left its dirty pages out, records before start_lsn_ are not filtered by them
+    bool dirty_pages_dropped_ = false;
+
+    void Analyze() {
+        lsn_t checkpoint_lsn = log_manager_->GetCheckpointLSN();
+        if (checkpoint_lsn != INVALID_LSN) start_lsn_ = checkpoint_lsn;
+        // transactions ended since the checkpoint began, its table may still list them
+        std::unordered_set<txn_id_t> ended_txns;
+        ScanLog(start_lsn_, [this, &ended_txns](std::vector<LogRecord> &records) {
+            for (auto &record : records) {
+                if (record.GetType() == LogRecordType::CHECKPOINT_END) {
+                    MergeCheckpoint(record, ended_txns);
+                    continue;
+                }
+                auto txn_id = record.GetTxnId();
+                if (txn_id == INVALID_TXN_ID) continue;
+                max_txn_id_ = std::max(max_txn_id_, txn_id);
+                if (record.GetType() == LogRecordType::COMMIT || record.GetType() == LogRecordType::ABORT) {
+                    active_txn_table_.erase(txn_id);
+                    ended_txns.insert(txn_id);
+                } else {
+                    active_txn_table_[txn_id] = record.GetLSN();
+                }
+                if (record.IsPageChange()) {
+                    dirty_page_table_.emplace(record.GetPageId(), record.GetLSN());
+                    redo_lsn_ = redo_lsn_ == INVALID_LSN ? record.GetLSN() : std::min(redo_lsn_, record.GetLSN());
+                }
+            }
+        });
+    }
+
+    void MergeCheckpoint(const LogRecord &record, const std::unordered_set<txn_id_t> &ended_txns) {
+        for (auto &txn : record.GetActiveTxns()) {
+            max_txn_id_ = std::max(max_txn_id_, txn.first);
+            if (ended_txns.count(txn.first) != 0) continue;
+            auto &last_lsn = active_txn_table_.emplace(txn.first, txn.second).first->second;
+            last_lsn = std::max(last_lsn, txn.second);
+        }
+        for (auto &page : record.GetDirtyPages()) {
+            auto &rec_lsn = dirty_page_table_.emplace(page.first, page.second).first->second;
+            rec_lsn = std::min(rec_lsn, page.second);
+        }
+        if (record.GetRedoLSN() < start_lsn_) {
+            redo_lsn_ = redo_lsn_ == INVALID_LSN ? record.GetRedoLSN() : std::min(redo_lsn_, record.GetRedoLSN());
+            if (record.GetDirtyPages().empty()) dirty_pages_dropped_ = true;
+        }
+    }
+
+    void Redo() {
+        if (redo_lsn_ == INVALID_LSN) return;
+        size_t thread_num = options_.redo_thread_num_;
+        ScanLog(redo_lsn_, [this, thread_num](std::vector<LogRecord> &records) {
+            std::vector<std::vector<const LogRecord *>> parts(thread_num);
+            for (auto &record : records) {
+                if (!record.IsPageChange()) continue;
+                // before the checkpoint, only the pages it found dirty may need redo
+                bool filter = record.GetLSN() >= start_lsn_ || !dirty_pages_dropped_;
+                auto entry = dirty_page_table_.find(record.GetPageId());
+                if (filter && (entry == dirty_page_table_.end() || record.GetLSN() < entry->second)) continue;
+                parts[(size_t)record.GetPageId() % thread_num].push_back(&record);
+            }
+            std::vector<std::future<void>> futures;
+            for (size_t i = 1; i < thread_num; ++i) {
+                if (parts[i].empty()) continue;
+                futures.push_back(std::async(std::launch::async, [this, &parts, i]() { RedoPart(parts[i]); }));
+            }
+            // part 0 runs on the calling thread
+            RedoPart(parts[0]);
+            for (auto &future : futures) future.get();
+        });
+    }
+
+    void RedoPart(const std::vector<const LogRecord *> &records) {
+        for (auto record : records) {
+            auto guard = FetchPage(record->GetPageId());
+            if (guard.GetLSN() >= record->GetLSN()) continue;
+            memcpy(guard.GetContentMut() + record->GetOffset(), record->GetAfter(), record->GetLength());
+            guard.SetLSN(record->GetLSN());
+            ++redo_num_;
+        }
+    }
+
+    void Undo() {
+        // the next record to undo of each loser, highest LSN first
+        std::priority_queue<lsn_t> to_undo;
+        for (auto &entry : active_txn_table_) to_undo.push(entry.second);
+        LogRecord record;
+        while (!to_undo.empty()) {
+            ReadLogRecord(to_undo.top(), &record);
+            to_undo.pop();
+            auto txn_id = record.GetTxnId();
+            auto &last_lsn = undo_last_lsns_.emplace(txn_id, active_txn_table_[txn_id]).first->second;
+            lsn_t undo_next_lsn = record.GetPrevLSN();
+            if (record.GetType() == LogRecordType::UPDATE) {
+                auto guard = FetchPage(record.GetPageId());
+                memcpy(guard.GetContentMut() + record.GetOffset(), record.GetBefore(), record.GetLength());
+                LogRecord clr(txn_id, last_lsn, record.GetPageId(), record.GetOffset(), record.GetBefore(),
+                              record.GetLength(), record.GetPrevLSN());
+                last_lsn = log_manager_->AppendLogRecord(&clr);
+                guard.SetLSN(last_lsn);
+                ++undo_num_;
+            } else if (record.GetType() == LogRecordType::CLR) {
+                undo_next_lsn = record.GetUndoNextLSN();
+            }
+            if (undo_next_lsn != INVALID_LSN) {
+                to_undo.push(undo_next_lsn);
+            } else {
+                LogRecord abort(LogRecordType::ABORT, txn_id, last_lsn);
+                last_lsn = log_manager_->AppendLogRecord(&abort);
+            }
+        }
+        log_manager_->FlushAll();
+    }
+
+    WritePageGuard<BufferPool> FetchPage(const page_id_t page_id) {
+        // never written before the crash, the page starts empty
+        if ((size_t)page_id >= disk_manager_->GetPageNum()) CreatePage(page_id);
+        auto guard = bpm_->FetchPageWrite(page_id);
+        if (!guard.IsValid()) {
+            std::cerr << "can't fetch page while recovering" << std::endl;
+            exit(0);
+        }
+        return guard;
+    }
+
+    void CreatePage(const page_id_t page_id) {
+        std::vector<char> page(disk_manager_->GetPageSize(), 0);
+        memcpy(page.data() + disk::OFFSET_PAGE_ID, &page_id, sizeof(page_id));
+        disk_manager_->WritePage(page_id, page.data());
+    }
+
+    /**
+     *  @brief Read the record at lsn, which must be durable.
+     */
+    void ReadLogRecord(const lsn_t lsn, LogRecord *record) {
+        std::vector<char> buf(LogRecord::HEADER_SIZE);
+        uint32_t size = 0;
+        if (log_manager_->ReadLog(lsn, buf.data(), buf.size()) == buf.size()) {
+            memcpy(&size, buf.data(), sizeof(size));
+            buf.resize(std::max<size_t>(size, LogRecord::HEADER_SIZE));
+        }
+        if (size == 0 || log_manager_->ReadLog(lsn, buf.data(), buf.size()) != buf.size()
+            || !record->Deserialize(buf.data(), buf.size()) || record->GetLSN() != lsn) {
+            std::cerr << "corrupted log" << std::endl;
+            exit(0);
+        }
+    }
+
+    /**
+     *  @brief Read the log from lsn to its end, in batches of about redo_batch_size_ bytes.
+     *  @param visit callable (std::vector<LogRecord> &) taking the records of a batch
+     */
+    template<typename Visit>
+    void ScanLog(lsn_t lsn, Visit visit) {
+        std::vector<char> buf(options_.redo_batch_size_);
+        std::vector<LogRecord> records;
+        LogRecord record;
+        while (true) {
+            size_t size = log_manager_->ReadLog(lsn, buf.data(), buf.size());
+            if (size == 0) return;
+            size_t pos = 0;
+            records.clear();
+            while (record.Deserialize(buf.data() + pos, size - pos)) {
+                if (record.GetLSN() != lsn + (lsn_t)pos) break;
+                pos += record.GetSize();
+                records.push_back(std::move(record));
+            }
+            // the LogManager cut off the torn tail, the durable log holds whole records only
+            if (pos == 0) {
+                std::cerr << "corrupted log" << std::endl;
+                exit(0);
+            }
+            visit(records);
+            lsn += pos;
+        }
+    }
+};
+
+} // dsbus
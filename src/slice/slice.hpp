@@ -13,7 +13,7 @@ class Slice {
     using ALLOC_TYPE = uint32_t;
     const size_t LEN_OFFSET = 0;
     const size_t ALLOC_OFFSET = LEN_OFFSET + sizeof(LEN_TYPE);
-    const size_t STR_OFFSET = ALLOC_OFFSET + sizeof(ALLOC_OFFSET);
+    const size_t STR_OFFSET = ALLOC_OFFSET + sizeof(ALLOC_TYPE);
 public:
     /**
      *  @brief Create an empty slice.
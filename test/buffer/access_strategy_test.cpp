@@ -0,0 +1,141 @@
+#include <cstring>
+#include <vector>
+#include "slice/slice.hpp"
+#include "disk/disk_manager.hpp"
+#include "buffer/buffer_pool_manager.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+static const size_t page_size = 128;
+static const int hot_num = 32;
+static const int page_num = 256;
+
+/**
+ *  Create page_num pages holding their id, then fetch the hot pages and mark them in memory
+ *  only, the mark is lost if a hot page is evicted and read again.
+ */
+static void LoadHotSet(BufferPoolManager<page_size> &bpm) {
+    for (int i = 0; i < page_num; ++i) {
+        auto guard = bpm.NewPageGuarded();
+        memcpy(guard.GetContentMut(), &i, sizeof(i));
+    }
+    bpm.FlushAllData();
+    for (int i = 0; i < hot_num; ++i) {
+        auto page = bpm.FetchPage(i);
+        page->GetContent()[sizeof(int)] = 'h';
+        bpm.UnpinPage(i, false);
+    }
+}
+
+static int CountHotResident(BufferPoolManager<page_size> &bpm) {
+    int resident = 0;
+    for (int i = 0; i < hot_num; ++i) {
+        auto guard = bpm.FetchPageRead(i);
+        if (guard.GetContent()[sizeof(int)] == 'h') ++resident;
+    }
+    return resident;
+}
+
+TEST(AccessStrategyTest, RingSizeTest) {
+    remove("test.db");
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(64, &disk_manager);
+        EXPECT_EQ(bpm.GetAccessStrategy(AccessType::NORMAL).GetRingSize(), 0);
+        EXPECT_EQ(bpm.GetAccessStrategy(AccessType::SEQUENTIAL_SCAN).GetRingSize(), 8);
+        EXPECT_EQ(bpm.GetAccessStrategy(AccessType::SEQUENTIAL_SCAN, 4).GetRingSize(), 4);
+        EXPECT_EQ(bpm.GetAccessStrategy(AccessType::BULK_WRITE, 100).GetRingSize(), 8);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(AccessStrategyTest, SequentialScanTest) {
+    remove("test.db");
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(64, &disk_manager);
+        LoadHotSet(bpm);
+        auto strategy = bpm.GetAccessStrategy(AccessType::SEQUENTIAL_SCAN);
+        for (int i = hot_num; i < page_num; ++i) {
+            auto guard = bpm.FetchPageRead(i, &strategy);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+        strategy.Release();
+        EXPECT_EQ(CountHotResident(bpm), hot_num);
+
+        // without a strategy the same scan flushes the hot set
+        for (int i = hot_num; i < page_num; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+        EXPECT_EQ(CountHotResident(bpm), 0);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(AccessStrategyTest, BulkWriteTest) {
+    remove("test.db");
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(64, &disk_manager);
+        LoadHotSet(bpm);
+        {
+            auto strategy = bpm.GetAccessStrategy(AccessType::BULK_WRITE);
+            for (int i = page_num; i < page_num * 2; ++i) {
+                auto guard = bpm.NewPageGuarded(&strategy);
+                EXPECT_EQ(guard.GetPageId(), i);
+                memcpy(guard.GetContentMut(), &i, sizeof(i));
+            }
+            // rewrite the pages written so far, dirty ring pages are written back on reuse
+            for (int i = page_num; i < page_num * 2; ++i) {
+                auto guard = bpm.FetchPageWrite(i, &strategy);
+                EXPECT_EQ(*(const int *)guard.GetContent(), i);
+                int value = -i;
+                memcpy(guard.GetContentMut(), &value, sizeof(value));
+            }
+        }
+        EXPECT_EQ(CountHotResident(bpm), hot_num);
+        for (int i = page_num; i < page_num * 2; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), -i);
+        }
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(AccessStrategyTest, SharedRingFrameTest) {
+    remove("test.db");
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(16, &disk_manager);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        auto strategy = bpm.GetAccessStrategy(AccessType::SEQUENTIAL_SCAN, 2);
+        auto page = bpm.FetchPage(0, &strategy);
+        // another user pins the page held by the ring, the ring must not evict it
+        auto other = bpm.FetchPage(0);
+        EXPECT_EQ(other, page);
+        bpm.UnpinPage(0, false);
+        for (int i = 1; i < 64; ++i) {
+            auto guard = bpm.FetchPageRead(i, &strategy);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+        EXPECT_EQ(*(int *)page->GetContent(), 0);
+        EXPECT_EQ(bpm.UnpinPage(0, false), true);
+        strategy.Release();
+
+        // every frame must be evictable again
+        for (int i = 0; i < 16; ++i) EXPECT_NE(bpm.NewPage(), nullptr);
+        EXPECT_EQ(bpm.NewPage(), nullptr);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+} // dsbus
@@ -0,0 +1,125 @@
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "buffer/arc_replacer.hpp"
+#include "buffer/replacer.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(ARCReplacerTest, ConceptTest) {
+    EXPECT_EQ(true, IsReplacer<ARCReplacer>::value);
+}
+
+TEST(ARCReplacerTest, PinUnpinTest) {
+    int v;
+    ARCReplacer arc(3);
+    EXPECT_EQ(3, arc.Size());
+    arc.Pin(0);
+    arc.Pin(0);
+    arc.Pin(1);
+    EXPECT_EQ(1, arc.Size());
+    arc.Victim(&v); EXPECT_EQ(2, v);
+    EXPECT_EQ(false, arc.Victim(&v));
+    arc.Unpin(0);
+    arc.Unpin(1);
+    arc.Unpin(1);
+    EXPECT_EQ(1, arc.Size());
+    arc.Victim(&v); EXPECT_EQ(1, v);
+}
+
+TEST(ARCReplacerTest, FrequencyTest) {
+    int v;
+    ARCReplacer arc(4);
+    for (int i = 0; i < 4; ++i) {
+        arc.Victim(&v); arc.Admit(v, i); arc.Unpin(v);
+    }
+    // pages 0 and 1 are accessed twice and move to T2
+    arc.Pin(0); arc.Unpin(0);
+    arc.Pin(1); arc.Unpin(1);
+    // a scan is absorbed by T1
+    for (page_id_t page_id = 100; page_id < 120; ++page_id) {
+        EXPECT_EQ(true, arc.Victim(&v));
+        EXPECT_NE(0, v);
+        EXPECT_NE(1, v);
+        arc.Admit(v, page_id);
+        arc.Unpin(v);
+    }
+}
+
+TEST(ARCReplacerTest, AdaptTest) {
+    int v;
+    ARCReplacer arc(2);
+    arc.Victim(&v); arc.Admit(v, 0); arc.Unpin(v);
+    arc.Victim(&v); arc.Admit(v, 1); arc.Unpin(v);
+    arc.Pin(1); arc.Unpin(1);
+    EXPECT_EQ(0, arc.GetTarget());
+    // page 0 leaves T1 for B1, loading it again favours recency
+    arc.Victim(&v); EXPECT_EQ(0, v);
+    arc.Admit(v, 0);
+    EXPECT_EQ(1, arc.GetTarget());
+    arc.Unpin(v);
+}
+
+TEST(ARCReplacerTest, NextVictimsTest) {
+    const size_t num_pages = 64;
+    ARCReplacer replacer(num_pages);
+    // load and reload 128 pages the way the buffer pool does
+    std::unordered_map<page_id_t, frame_id_t> resident;
+    std::vector<page_id_t> page_of(num_pages, INVALID_PAGE_ID);
+    std::mt19937 rng(7);
+    for (int i = 0; i < 2000; ++i) {
+        page_id_t page_id = rng() % 128;
+        frame_id_t frame_id = 0;
+        if (resident.count(page_id) != 0) {
+            frame_id = resident[page_id];
+            replacer.Pin(frame_id);
+        } else {
+            ASSERT_EQ(true, replacer.Victim(&frame_id));
+            resident.erase(page_of[frame_id]);
+            resident[page_id] = frame_id;
+            page_of[frame_id] = page_id;
+            replacer.Admit(frame_id, page_id);
+        }
+        replacer.Unpin(frame_id);
+    }
+    for (frame_id_t frame_id = 0; frame_id < 8; ++frame_id) replacer.Pin(frame_id);
+
+    std::vector<frame_id_t> next(num_pages);
+    EXPECT_EQ(4, replacer.NextVictims(next.data(), 4));
+    size_t n = replacer.NextVictims(next.data(), num_pages);
+    EXPECT_EQ(num_pages - 8, n);
+    // predicted without changing the victim order
+    for (size_t i = 0; i < n; ++i) {
+        frame_id_t v;
+        EXPECT_EQ(true, replacer.Victim(&v));
+        EXPECT_EQ(next[i], v);
+    }
+    EXPECT_EQ(0, replacer.NextVictims(next.data(), num_pages));
+}
+
+TEST(ARCReplacerTest, SetCapacityTest) {
+    int v;
+    ARCReplacer arc(4);
+    for (int i = 0; i < 4; ++i) {
+        arc.Victim(&v); arc.Admit(v, i); arc.Unpin(v);
+    }
+    // the pool takes frames 2 and 3 out, c drops to 2
+    arc.Pin(2);
+    arc.Pin(3);
+    arc.SetCapacity(2);
+    EXPECT_EQ(2, arc.Size());
+    arc.Victim(&v); EXPECT_EQ(0, v);
+    arc.Admit(v, 4); arc.Unpin(v);
+    arc.Victim(&v); EXPECT_EQ(1, v);
+    arc.Admit(v, 5); arc.Unpin(v);
+    // frames used again are free
+    arc.SetCapacity(4);
+    EXPECT_EQ(4, arc.Size());
+    arc.Victim(&v); EXPECT_EQ(2, v);
+    arc.Victim(&v); EXPECT_EQ(3, v);
+    EXPECT_LE(arc.GetTarget(), 4);
+}
+
+} // dsbus
@@ -1,7 +1,20 @@
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
 #include "slice/slice.hpp"
 #include "disk/disk_manager.hpp"
+#include "disk/tablespace_manager.hpp"
+#include "log/log_manager.hpp"
 #include "buffer/buffer_pool_manager.hpp"
+#include "buffer/arc_replacer.hpp"
+#include "buffer/clock_replacer.hpp"
+#include "buffer/lru_k_replacer.hpp"
+#include "buffer/two_queue_replacer.hpp"
 #include "gtest/gtest.h"
 
 namespace dsbus {
@@ -102,4 +115,872 @@ TEST(BufferPoolManagerTest, FetchPageTest2) {
     remove("test.db");
 }
 
-} // dsbus
\ No newline at end of file
+TEST(BufferPoolManagerTest, ConcurrentFetchTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 64;
+    const int thread_num = 8;
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(16, &disk_manager);
+        for (int i = 0; i < page_num; ++i) {
+            auto page = bpm.NewPage(); EXPECT_EQ(page->GetPageId(), i);
+            memcpy(page->GetContent(), &i, sizeof(i));
+            bpm.UnpinPage(page->GetPageId(), true);
+        }
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_num; ++t) {
+            threads.emplace_back([&bpm, t]() {
+                std::mt19937 rng(t);
+                for (int i = 0; i < 2000; ++i) {
+                    page_id_t page_id = rng() % page_num;
+                    auto page = bpm.FetchPage(page_id);
+                    if (page == nullptr) continue;
+                    auto &latch = bpm.GetPageLatch(page);
+                    latch.RLock();
+                    EXPECT_EQ(page->GetPageId(), page_id);
+                    EXPECT_EQ(*(int *)page->GetContent(), page_id);
+                    latch.RUnlock();
+                    EXPECT_EQ(true, bpm.UnpinPage(page_id, false));
+                }
+            });
+        }
+        for (auto &thread : threads) thread.join();
+
+        // every frame must be evictable again
+        for (int i = 0; i < 16; ++i) {
+            auto page = bpm.NewPage(); EXPECT_NE(page, nullptr);
+        }
+        EXPECT_EQ(bpm.NewPage(), nullptr);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+template<typename Replacer>
+void ReplacerWorkload() {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 32;
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size, Replacer> bpm(8, &disk_manager);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        std::mt19937 rng(0);
+        for (int i = 0; i < 1000; ++i) {
+            page_id_t page_id = rng() % 4 == 0 ? rng() % page_num : rng() % 4;
+            auto guard = bpm.FetchPageRead(page_id);
+            EXPECT_EQ(guard.IsValid(), true);
+            EXPECT_EQ(*(const int *)guard.GetContent(), page_id);
+        }
+        // all frames pinned, nothing to evict
+        std::vector<ReadPageGuard<BufferPoolManager<page_size, Replacer>>> guards;
+        for (int i = 0; i < 8; ++i) guards.push_back(bpm.FetchPageRead(i));
+        EXPECT_EQ(bpm.FetchPageRead(8).IsValid(), false);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, ReplacerTest) {
+    ReplacerWorkload<LRUReplacer>();
+    ReplacerWorkload<LRUKReplacer>();
+    ReplacerWorkload<ClockReplacer>();
+    ReplacerWorkload<TwoQueueReplacer>();
+    ReplacerWorkload<ARCReplacer>();
+}
+
+// a page kept pinned by overlapping readers outlives a scan, its fetches count as accesses
+template<typename Replacer>
+void PinnedHotPageWorkload() {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 32;
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size, Replacer> bpm(8, &disk_manager);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+    }
+    {
+        // without read-ahead, every page of the scan is a miss accessed once
+        BufferPoolOptions options;
+        options.read_ahead_page_num_ = 0;
+        BufferPoolManager<page_size, Replacer> bpm(8, &disk_manager, options);
+        {
+            // the pin count never drops to 0 between these fetches
+            std::vector<ReadPageGuard<BufferPoolManager<page_size, Replacer>>> guards;
+            for (int i = 0; i < 10; ++i) guards.push_back(bpm.FetchPageRead(0));
+        }
+        for (int i = 1; i < page_num; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+        auto miss_num = bpm.GetStats().miss_num_;
+        auto guard = bpm.FetchPageRead(0);
+        EXPECT_EQ(*(const int *)guard.GetContent(), 0);
+        EXPECT_EQ(bpm.GetStats().miss_num_, miss_num);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, PinnedHotPageTest) {
+    PinnedHotPageWorkload<LRUKReplacer>();
+    PinnedHotPageWorkload<ARCReplacer>();
+}
+
+TEST(BufferPoolManagerTest, DirectIOTest) {
+    remove("test.db");
+    const size_t page_size = 4096;
+    const int page_num = 32;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size, DiskManagerOptions{true});
+        BufferPoolManager<page_size> bpm(4, &disk_manager);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+    }
+    remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, FlushAllDataTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    // more dirty pages than one flush batch
+    const int page_num = FLUSH_BATCH_PAGE_NUM * 2 + 10;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolManager<page_size> bpm(page_num, &disk_manager);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        // one page stays pinned, it is written anyway
+        auto guard = bpm.FetchPageRead(7);
+        bpm.FlushAllData();
+        EXPECT_EQ(disk_manager.GetPageNum(), page_num);
+        disk::Page<page_size> page;
+        for (int i = 0; i < page_num; ++i) {
+            disk_manager.ReadPage(i, page.GetData());
+            EXPECT_EQ(*(const int *)page.GetContent(), i);
+        }
+    }
+    remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, DeletePageTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 16;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolManager<page_size> bpm(8, &disk_manager);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        bpm.FlushAllData();
+        {
+            // a pinned page can't be deleted
+            auto guard = bpm.FetchPageRead(3);
+            EXPECT_FALSE(bpm.DeletePage(3));
+        }
+        // resident, then on disk only
+        EXPECT_TRUE(bpm.DeletePage(3));
+        EXPECT_TRUE(bpm.DeletePage(1));
+        EXPECT_EQ(disk_manager.GetFreePageNum(), 2);
+        // the deleted ids are reused, lowest first, with fresh content
+        auto page = bpm.NewPage();
+        EXPECT_EQ(page->GetPageId(), 1);
+        EXPECT_EQ(*(const int *)page->GetContent(), 0);
+        bpm.UnpinPage(1, true);
+        page = bpm.NewPage();
+        EXPECT_EQ(page->GetPageId(), 3);
+        bpm.UnpinPage(3, true);
+        // deleting the last pages shrinks the file
+        for (int i = page_num - 1; i >= page_num - 4; --i) EXPECT_TRUE(bpm.DeletePage(i));
+        EXPECT_EQ(disk_manager.GetPageNum(), page_num - 4);
+        EXPECT_EQ(bpm.NewPage()->GetPageId(), page_num - 4);
+        bpm.UnpinPage(page_num - 4, true);
+        for (int i = 4; i < page_num - 4; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+    }
+    remove("test.db");
+}
+
+template<typename Replacer>
+void DeletePageFrameWorkload() {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int pool_size = 4;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolOptions options;
+        options.read_ahead_page_num_ = 0;
+        BufferPoolManager<page_size, Replacer> bpm(pool_size, &disk_manager, options);
+        for (int i = 0; i < pool_size; ++i) bpm.NewPageGuarded();
+        // the page used last is deleted, its frame is taken before any page is evicted
+        EXPECT_TRUE(bpm.DeletePage(pool_size - 1));
+        auto guard = bpm.NewPageGuarded();
+        EXPECT_EQ(guard.IsValid(), true);
+        auto stats = bpm.GetStats();
+        EXPECT_EQ(stats.eviction_num_, 0);
+        EXPECT_EQ(stats.resident_frame_num_, pool_size);
+        {
+            // a page pinned by the ring of a scan only can't be deleted
+            auto strategy = bpm.GetAccessStrategy(AccessType::BULK_WRITE, 1);
+            auto page_id = bpm.NewPage(&strategy)->GetPageId();
+            bpm.UnpinPage(page_id, true);
+            EXPECT_FALSE(bpm.DeletePage(page_id));
+        }
+    }
+    remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, DeletePageFrameTest) {
+    DeletePageFrameWorkload<LRUReplacer>();
+    DeletePageFrameWorkload<LRUKReplacer>();
+    DeletePageFrameWorkload<ClockReplacer>();
+    DeletePageFrameWorkload<TwoQueueReplacer>();
+    DeletePageFrameWorkload<ARCReplacer>();
+}
+
+TEST(BufferPoolManagerTest, BackgroundWriterTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int pool_size = 64;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolOptions options;
+        options.background_writer_ = true;
+        options.writer_interval_ms_ = 1;
+        options.writer_low_watermark_ = pool_size;
+        options.writer_high_watermark_ = pool_size;
+        BufferPoolManager<page_size> bpm(pool_size, &disk_manager, options);
+        for (int i = 0; i < pool_size; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        for (int i = 0; i < 5000 && bpm.GetWriterWriteNum() < (size_t)pool_size; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_EQ(bpm.GetWriterWriteNum(), pool_size);
+        // the frames are clean, evicting them writes nothing
+        for (int i = pool_size; i < pool_size * 2; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        EXPECT_EQ(bpm.GetEvictionWriteNum(), 0);
+        for (int i = 0; i < pool_size * 2; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+    }
+    remove("test.db");
+}
+
+/**
+ *  Counts the pages read synchronously and in the background, the latter run before returning.
+ */
+class CountingDiskManager : public MMapDiskManager {
+public:
+    using MMapDiskManager::MMapDiskManager;
+
+    void ReadPage(page_id_t page_id, char *page_data) {
+        ++read_num_;
+        MMapDiskManager::ReadPage(page_id, page_data);
+    }
+
+    void ReadPagesAsync(const std::vector<std::pair<page_id_t, char *>> &pages, std::function<void(size_t)> callback) {
+        async_read_num_ += pages.size();
+        MMapDiskManager::ReadPagesAsync(pages, callback);
+    }
+
+    std::atomic<size_t> read_num_{0};
+    std::atomic<size_t> async_read_num_{0};
+};
+
+TEST(BufferPoolManagerTest, PrefetchTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 64;
+    CountingDiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size, LRUReplacer, CountingDiskManager> bpm(16, &disk_manager);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+    }
+    {
+        BufferPoolManager<page_size, LRUReplacer, CountingDiskManager> bpm(16, &disk_manager);
+        bpm.Prefetch(40, 8);
+        // past the end of the file
+        bpm.Prefetch(page_num - 2, 8);
+        EXPECT_EQ(disk_manager.async_read_num_, 10);
+        for (int i : {40, 47, page_num - 1}) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+        // resident pages are not read again
+        bpm.Prefetch(40, 8);
+        EXPECT_EQ(disk_manager.async_read_num_, 10);
+        EXPECT_EQ(disk_manager.read_num_, 0);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+// deallocates one page right after the buffer pool checked that it is not free, as a
+// concurrent DeletePage would
+class TrimmingDiskManager : public DiskManager {
+public:
+    using DiskManager::DiskManager;
+
+    bool IsFreePage(page_id_t page_id) {
+        bool is_free = DiskManager::IsFreePage(page_id);
+        if (page_id == trim_page_id_.load()) {
+            trim_page_id_ = INVALID_PAGE_ID;
+            DeallocatePage(page_id);
+        }
+        return is_free;
+    }
+
+    std::atomic<page_id_t> trim_page_id_{INVALID_PAGE_ID};
+};
+
+TEST(BufferPoolManagerTest, PrefetchTrimTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 8;
+    TrimmingDiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size, LRUReplacer, TrimmingDiskManager> bpm(16, &disk_manager);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        bpm.FlushAllData();
+    }
+    {
+        BufferPoolManager<page_size, LRUReplacer, TrimmingDiskManager> bpm(16, &disk_manager);
+        // the last page is cut off the file between the check and the read
+        disk_manager.trim_page_id_ = page_num - 1;
+        bpm.Prefetch(4, 4);
+        for (int i = 0; i < 1000 && bpm.GetStats().prefetch_num_ < 3; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        EXPECT_EQ(disk_manager.GetPageNum(), page_num - 1);
+        auto stats = bpm.GetStats();
+        EXPECT_EQ(stats.prefetch_num_, 3);
+        EXPECT_EQ(stats.resident_frame_num_, 3);
+        for (int i = 4; i < page_num - 1; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+        EXPECT_EQ(bpm.GetStats().miss_num_, 0);
+        // the id is handed out again, to a page not found resident
+        auto guard = bpm.NewPageGuarded();
+        EXPECT_EQ(guard.GetPageId(), page_num - 1);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, ReadAheadTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 256;
+    CountingDiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size, LRUReplacer, CountingDiskManager> bpm(16, &disk_manager);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+    }
+    {
+        // windows of a quarter of the pool, only the two misses starting the scan are waited for
+        BufferPoolManager<page_size, LRUReplacer, CountingDiskManager> bpm(64, &disk_manager);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+        EXPECT_EQ(disk_manager.read_num_, 2);
+        EXPECT_EQ(disk_manager.async_read_num_, page_num - 2);
+    }
+    disk_manager.read_num_ = 0;
+    disk_manager.async_read_num_ = 0;
+    {
+        // windows of half the ring of the scan
+        BufferPoolManager<page_size, LRUReplacer, CountingDiskManager> bpm(64, &disk_manager);
+        auto strategy = bpm.GetAccessStrategy(AccessType::SEQUENTIAL_SCAN);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.FetchPageRead(i, &strategy);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+        EXPECT_EQ(disk_manager.read_num_, 2);
+        strategy.Release();
+    }
+    disk_manager.read_num_ = 0;
+    {
+        BufferPoolOptions options;
+        options.read_ahead_page_num_ = 0;
+        BufferPoolManager<page_size, LRUReplacer, CountingDiskManager> bpm(64, &disk_manager, options);
+        for (int i = 0; i < page_num; ++i) bpm.FetchPageRead(i);
+        EXPECT_EQ(disk_manager.read_num_, page_num);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, MMapDiskTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 64;
+    {
+        MMapDiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolManager<page_size, LRUReplacer, MMapDiskManager> bpm(8, &disk_manager);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+    }
+    remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, HugePageTest) {
+    remove("test.db");
+    const size_t page_size = 4096;
+    const size_t pool_size = 2 * HUGE_PAGE_SIZE / page_size;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolOptions options;
+        options.huge_pages_ = HugePageMode::TRANSPARENT;
+        BufferPoolManager<page_size> bpm(pool_size, &disk_manager, options);
+        for (int i = 0; i < (int)pool_size * 2; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        for (int i = 0; i < (int)pool_size * 2; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+        auto stats = bpm.GetMemoryStats();
+        EXPECT_EQ(stats.frame_num_, pool_size);
+        EXPECT_EQ(stats.frame_bytes_, 2 * HUGE_PAGE_SIZE);
+        EXPECT_EQ(stats.frame_header_bytes_, pool_size * sizeof(FrameHeader));
+        EXPECT_NE(stats.huge_page_mode_, HugePageMode::EXPLICIT);
+        EXPECT_LE(stats.huge_page_bytes_, stats.frame_bytes_);
+    }
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolManager<page_size> bpm(10, &disk_manager);
+        auto stats = bpm.GetMemoryStats();
+        EXPECT_EQ(stats.frame_bytes_, 10 * page_size);
+        EXPECT_EQ(stats.huge_page_mode_, HugePageMode::NONE);
+        EXPECT_EQ(stats.huge_page_bytes_, 0);
+    }
+    remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, TablespaceTest) {
+    const size_t page_size = 128;
+    const int page_num = 200;
+    std::vector<std::string> segment_file_names = {"test.db.0", "test.db.1", "test.db.2", "test.db.3"};
+    for (auto &file_name : segment_file_names) remove(file_name.c_str());
+    {
+        TablespaceManager tablespace(segment_file_names, page_size, 8);
+        BufferPoolManager<page_size, LRUReplacer, TablespaceManager> bpm(32, &tablespace);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        EXPECT_TRUE(bpm.DeletePage(5));
+        bpm.FlushAllData();
+        for (int i = 0; i < page_num; i += 3) {
+            if (i == 5) continue;
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+        EXPECT_EQ(bpm.NewPage()->GetPageId(), 5);
+        bpm.UnpinPage(5, true);
+    }
+    for (auto &file_name : segment_file_names) remove(file_name.c_str());
+}
+
+// checks that the log is durable up to the LSN of every page written
+// holds the read or write of one page until released
+class BlockingDiskManager : public DiskManager {
+public:
+    using DiskManager::DiskManager;
+
+    void ReadPage(page_id_t page_id, char *page_data) {
+        Block(page_id);
+        DiskManager::ReadPage(page_id, page_data);
+    }
+
+    void WritePage(page_id_t page_id, const char *page_data) {
+        Block(page_id);
+        DiskManager::WritePage(page_id, page_data);
+    }
+
+    std::atomic<page_id_t> block_page_id_{INVALID_PAGE_ID};
+    std::atomic<bool> blocked_{false};
+    std::atomic<bool> released_{false};
+
+private:
+    void Block(page_id_t page_id) {
+        if (page_id != block_page_id_.load()) return;
+        blocked_ = true;
+        while (!released_.load()) std::this_thread::yield();
+    }
+};
+
+TEST(BufferPoolManagerTest, IOOutsideShardLatchTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int pool_size = 32;
+    const int page_num = 48;
+    BlockingDiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolOptions options;
+        options.read_ahead_page_num_ = 0;
+        BufferPoolManager<page_size, LRUReplacer, BlockingDiskManager> bpm(pool_size, &disk_manager, options);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        // pages 16 to 47 are resident and dirty, 16 is the next victim
+        auto run = [&](page_id_t block_page_id, page_id_t fetch_page_id, page_id_t first_resident_id) {
+            disk_manager.block_page_id_ = block_page_id;
+            disk_manager.blocked_ = false;
+            disk_manager.released_ = false;
+            std::thread loader([&bpm, fetch_page_id]() { EXPECT_TRUE(bpm.FetchPageRead(fetch_page_id).IsValid()); });
+            while (!disk_manager.blocked_.load()) std::this_thread::yield();
+            // resident pages of every shard are found while the I/O is held
+            std::atomic<bool> done{false};
+            std::thread reader([&bpm, &done, first_resident_id]() {
+                for (page_id_t page_id = first_resident_id; page_id < page_num; ++page_id) {
+                    auto guard = bpm.FetchPageRead(page_id);
+                    EXPECT_EQ(*(const int *)guard.GetContent(), page_id);
+                }
+                done = true;
+            });
+            for (int i = 0; i < 2000 && !done.load(); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            EXPECT_TRUE(done.load());
+            disk_manager.released_ = true;
+            loader.join();
+            reader.join();
+        };
+        // the eviction of page 16 writes it back
+        run(16, 0, 17);
+        // the miss of page 1 reads it, evicting page 17
+        run(1, 1, 18);
+        EXPECT_EQ(*(const int *)bpm.FetchPageRead(1).GetContent(), 1);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+class WALCheckDiskManager : public DiskManager {
+public:
+    WALCheckDiskManager(const Slice &db_file_name, const size_t page_size, LogManager *log_manager)
+                      : DiskManager(db_file_name, page_size), log_manager_(log_manager) {}
+
+    void WritePage(page_id_t page_id, const char *page_data) {
+        Check(page_data);
+        DiskManager::WritePage(page_id, page_data);
+    }
+
+    void WritePages(const std::vector<std::pair<page_id_t, const char *>> &pages) {
+        for (auto &page : pages) Check(page.second);
+        DiskManager::WritePages(pages);
+    }
+
+    std::atomic<size_t> write_num_{0};
+
+private:
+    LogManager *log_manager_;
+
+    void Check(const char *page_data) {
+        lsn_t lsn;
+        memcpy(&lsn, page_data + disk::OFFSET_PAGE_LSN, sizeof(lsn));
+        EXPECT_GT(log_manager_->GetPersistentLSN(), lsn);
+        ++write_num_;
+    }
+};
+
+TEST(BufferPoolManagerTest, WriteAheadLogTest) {
+    remove("test.db");
+    remove("test.log");
+    const size_t page_size = 128;
+    const int page_num = 64;
+    {
+        LogManagerOptions log_options;
+        // only the buffer pool makes the flusher write
+        log_options.flush_interval_ms_ = 100000;
+        LogManager log_manager(Slice("test.log"), log_options);
+        WALCheckDiskManager disk_manager(Slice("test.db"), page_size, &log_manager);
+        BufferPoolOptions options;
+        options.log_manager_ = &log_manager;
+        BufferPoolManager<page_size, LRUReplacer, WALCheckDiskManager> bpm(8, &disk_manager, options);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            int before = 0;
+            LogRecord record(1, INVALID_LSN, guard.GetPageId(), 0, (const char *)&before, (const char *)&i, sizeof(i));
+            guard.SetLSN(log_manager.AppendLogRecord(&record));
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        // evictions wrote most pages, the rest are flushed
+        bpm.FlushAllData();
+        EXPECT_GE(disk_manager.write_num_.load(), (size_t)page_num);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+            EXPECT_GE(guard.GetLSN(), (lsn_t)LOG_FILE_HEADER_SIZE);
+        }
+    }
+    remove("test.db");
+    remove("test.log");
+}
+
+
+TEST(BufferPoolManagerTest, StatsTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int pool_size = 4;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolOptions options;
+        options.read_ahead_page_num_ = 0;
+        BufferPoolManager<page_size> bpm(pool_size, &disk_manager, options);
+        // the first pages are evicted for the last ones, and written as they are dirty
+        for (int i = 0; i < pool_size * 2; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            if (!guard.IsValid()) break;
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        for (int i = pool_size; i < pool_size * 2; ++i) bpm.FetchPageRead(i);
+        auto page_guard = bpm.FetchPageRead(0);
+        bpm.FetchPageRead(1);
+
+        auto stats = bpm.GetStats();
+        EXPECT_EQ(stats.new_page_num_, pool_size * 2);
+        EXPECT_EQ(stats.hit_num_, pool_size);
+        EXPECT_EQ(stats.miss_num_, 2);
+        EXPECT_DOUBLE_EQ(stats.GetHitRatio(), 4.0 / 6);
+        EXPECT_EQ(stats.prefetch_num_, 0);
+        EXPECT_EQ(stats.eviction_num_, pool_size + 2);
+        EXPECT_EQ(stats.eviction_write_num_, pool_size + 2);
+        EXPECT_EQ(stats.eviction_write_num_, bpm.GetEvictionWriteNum());
+        EXPECT_EQ(stats.frame_num_, pool_size);
+        EXPECT_EQ(stats.resident_frame_num_, pool_size);
+        EXPECT_EQ(stats.pinned_frame_num_, 1);
+        EXPECT_EQ(stats.pin_num_, 1);
+        // pages 6 and 7 were never written
+        EXPECT_EQ(stats.dirty_frame_num_, 2);
+        EXPECT_EQ(stats.read_latency_.count_, 2);
+        EXPECT_EQ(stats.write_latency_.count_, pool_size + 2);
+        EXPECT_GT(stats.write_latency_.max_nanos_, 0);
+        EXPECT_LE(stats.write_latency_.GetPercentileNanos(0.99), stats.write_latency_.max_nanos_);
+
+        bpm.FlushAllData();
+        stats = bpm.GetStats();
+        EXPECT_EQ(stats.flush_write_num_, 2);
+        EXPECT_EQ(stats.dirty_frame_num_, 0);
+        EXPECT_EQ(stats.write_latency_.count_, pool_size + 3);
+    }
+    remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, LatchWaitStatsTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolManager<page_size> bpm(4, &disk_manager);
+        auto write_guard = bpm.NewPageGuarded();
+        page_id_t page_id = write_guard.GetPageId();
+        // uncontended latches are no waits
+        page_id_t other_page_id = bpm.NewPageGuarded().GetPageId();
+        bpm.FetchPageRead(other_page_id);
+        EXPECT_EQ(bpm.GetStats().frame_wait_num_, 0);
+
+        std::thread reader([&bpm, page_id]() { EXPECT_TRUE(bpm.FetchPageRead(page_id).IsValid()); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        write_guard.Drop();
+        reader.join();
+        auto stats = bpm.GetStats();
+        EXPECT_EQ(stats.frame_wait_num_, 1);
+        EXPECT_GE(stats.frame_wait_nanos_, 10 * 1000 * 1000);
+    }
+    remove("test.db");
+}
+
+template<typename Replacer>
+void ResizeWorkload() {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int max_pool_size = 32;
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolOptions options;
+        options.max_pool_size_ = max_pool_size;
+        options.read_ahead_page_num_ = 0;
+        BufferPoolManager<page_size, Replacer> bpm(8, &disk_manager, options);
+        EXPECT_EQ(bpm.GetPoolSize(), 8);
+        EXPECT_EQ(bpm.GetMaxPoolSize(), max_pool_size);
+        // the frames added are free, they take new pages without evicting
+        EXPECT_EQ(bpm.Resize(max_pool_size), max_pool_size);
+        {
+            std::vector<WritePageGuard<BufferPoolManager<page_size, Replacer>>> guards;
+            for (int i = 0; i < max_pool_size; ++i) {
+                guards.push_back(bpm.NewPageGuarded());
+                EXPECT_EQ(guards.back().IsValid(), true);
+                memcpy(guards.back().GetContentMut(), &i, sizeof(i));
+            }
+            EXPECT_EQ(bpm.NewPageGuarded().IsValid(), false);
+        }
+        EXPECT_EQ(bpm.GetStats().eviction_num_, 0);
+        {
+            // free frames are handed out in order, page 31 is in the last frame and stops the shrink
+            auto guard = bpm.FetchPageRead(max_pool_size - 1);
+            EXPECT_EQ(bpm.Resize(4), max_pool_size);
+        }
+        // the pages of the frames released are written back
+        EXPECT_EQ(bpm.Resize(4), 4);
+        auto stats = bpm.GetStats();
+        EXPECT_EQ(stats.frame_num_, 4);
+        EXPECT_EQ(stats.resident_frame_num_, 4);
+        EXPECT_EQ(stats.eviction_num_, max_pool_size - 4);
+        EXPECT_EQ(stats.eviction_write_num_, max_pool_size - 4);
+        EXPECT_EQ(bpm.GetMemoryStats().frame_num_, 4);
+        EXPECT_EQ(bpm.GetMemoryStats().max_frame_num_, max_pool_size);
+        for (int i = 0; i < max_pool_size; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+        std::vector<ReadPageGuard<BufferPoolManager<page_size, Replacer>>> guards;
+        for (int i = 0; i < 4; ++i) guards.push_back(bpm.FetchPageRead(i));
+        EXPECT_EQ(bpm.FetchPageRead(4).IsValid(), false);
+        guards.clear();
+        // grown back, at most to the max pool size
+        EXPECT_EQ(bpm.Resize(100), max_pool_size);
+        for (int i = 0; i < max_pool_size; ++i) guards.push_back(bpm.FetchPageRead(i));
+        EXPECT_EQ(bpm.GetStats().resident_frame_num_, max_pool_size);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, ResizeTest) {
+    ResizeWorkload<LRUReplacer>();
+    ResizeWorkload<LRUKReplacer>();
+    ResizeWorkload<ClockReplacer>();
+    ResizeWorkload<TwoQueueReplacer>();
+    ResizeWorkload<ARCReplacer>();
+}
+
+TEST(BufferPoolManagerTest, ShrinkOptimisticReadTest) {
+    remove("test.db");
+    // frames of whole memory pages, so that their memory can be given back
+    const size_t page_size = 4096;
+    const int pool_size = 8;
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(pool_size, &disk_manager);
+        for (int i = 0; i < pool_size; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            int value = 100 + i;
+            memcpy(guard.GetContentMut(), &value, sizeof(value));
+        }
+        bpm.FlushAllData();
+    }
+    {
+        // a pool that may grow maps its frames, and gives their memory back on a shrink
+        BufferPoolOptions options;
+        options.max_pool_size_ = pool_size * 2;
+        BufferPoolManager<page_size> bpm(pool_size, &disk_manager, options);
+        // page 0 is loaded last, into the last frame
+        for (int i = 1; i < pool_size; ++i) bpm.FetchPageRead(i);
+        auto guard = bpm.FetchPageOptimistic(0);
+        int value = -1;
+        EXPECT_TRUE(guard.Read([&](const char *content) { memcpy(&value, content, sizeof(value)); }));
+        EXPECT_EQ(value, 100);
+        // the frame of page 0 is given back, its memory reads as zeroes, as page 0 would
+        EXPECT_EQ(bpm.Resize(1), 1);
+        EXPECT_FALSE(guard.Read([&](const char *content) { memcpy(&value, content, sizeof(value)); }));
+        EXPECT_EQ(guard.IsValid(), false);
+        guard = bpm.FetchPageOptimistic(0);
+        EXPECT_TRUE(guard.Read([&](const char *content) { memcpy(&value, content, sizeof(value)); }));
+        EXPECT_EQ(value, 100);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(BufferPoolManagerTest, ConcurrentResizeTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 128;
+    const int thread_num = 4;
+    const int round_num = 4;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolOptions options;
+        options.max_pool_size_ = 64;
+        BufferPoolManager<page_size> bpm(16, &disk_manager, options);
+        const int zero = 0;
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &zero, sizeof(zero));
+        }
+        std::atomic<bool> done{false};
+        std::thread resizer([&bpm, &done]() {
+            for (size_t i = 0; !done.load(); ++i) bpm.Resize(i % 2 == 0 ? 64 : 8);
+        });
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_num; ++t) {
+            threads.emplace_back([&bpm]() {
+                for (int round = 0; round < round_num; ++round) {
+                    for (int i = 0; i < page_num; ++i) {
+                        // every frame may be pinned for a moment while the pool shrinks
+                        auto guard = bpm.FetchPageWrite(i);
+                        while (!guard.IsValid()) guard = bpm.FetchPageWrite(i);
+                        ++*(int *)guard.GetContentMut();
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) thread.join();
+        done = true;
+        resizer.join();
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), round_num * thread_num);
+        }
+    }
+    remove("test.db");
+}
+
+} // dsbus
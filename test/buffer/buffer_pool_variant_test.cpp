@@ -0,0 +1,74 @@
+#include <cstring>
+#include <string>
+#include <vector>
+#include "slice/slice.hpp"
+#include "disk/disk_manager.hpp"
+#include "buffer/buffer_pool_variant.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(BufferPoolVariantTest, DispatchTest) {
+    for (size_t page_size : {4096, 8192, 16384, 65536}) {
+        EXPECT_TRUE(SupportedPageSizes::Contains(page_size));
+        size_t dispatched = DispatchPageSize(page_size, [](auto constant) { return decltype(constant)::value; });
+        EXPECT_EQ(dispatched, page_size);
+    }
+    EXPECT_FALSE(SupportedPageSizes::Contains(1000));
+    size_t dispatched = DispatchPageSize(PageSizeList<128, 256>(), 256, [](auto constant) {
+        return sizeof(disk::Page<decltype(constant)::value>);
+    });
+    EXPECT_EQ(dispatched, 256u);
+}
+
+TEST(BufferPoolVariantTest, StoresTest) {
+    // stores of different page sizes in one process
+    std::vector<size_t> page_sizes = {4096, 16384, 65536};
+    const int page_num = 20;
+    for (size_t i = 0; i < page_sizes.size(); ++i) remove(("test.db." + std::to_string(i)).c_str());
+    {
+        std::vector<std::unique_ptr<DiskManager>> disk_managers;
+        std::vector<std::unique_ptr<BufferPoolVariant<>>> pools;
+        for (size_t i = 0; i < page_sizes.size(); ++i) {
+            disk_managers.emplace_back(new DiskManager(Slice("test.db." + std::to_string(i)), page_sizes[i]));
+            pools.emplace_back(new BufferPoolVariant<>(8, disk_managers.back().get()));
+            EXPECT_EQ(pools.back()->GetPageSize(), page_sizes[i]);
+        }
+        for (size_t i = 0; i < pools.size(); ++i) {
+            pools[i]->Visit([&](auto &bpm) {
+                EXPECT_EQ(sizeof(typename std::remove_reference_t<decltype(bpm)>::PageType), page_sizes[i]);
+                for (int j = 0; j < page_num; ++j) {
+                    auto guard = bpm.NewPageGuarded();
+                    // fill the content, the last byte shows the page size is right
+                    size_t content_size = page_sizes[i] - disk::PAGE_HEADER_SIZE;
+                    memset(guard.GetContentMut(), 'a' + j, content_size);
+                }
+            });
+        }
+        for (size_t i = 0; i < pools.size(); ++i) {
+            int sum = pools[i]->Visit([&](auto &bpm) {
+                int sum = 0;
+                for (int j = 0; j < page_num; ++j) {
+                    auto guard = bpm.FetchPageRead(j);
+                    sum += guard.GetContent()[page_sizes[i] - disk::PAGE_HEADER_SIZE - 1] - 'a';
+                }
+                return sum;
+            });
+            EXPECT_EQ(sum, page_num * (page_num - 1) / 2);
+        }
+    }
+    {
+        // reopened, the page size comes from the file
+        DiskManager disk_manager(Slice("test.db.1"), 4096);
+        BufferPoolVariant<> pool(8, &disk_manager);
+        EXPECT_EQ(pool.GetPageSize(), 16384u);
+        char last = pool.Visit([](auto &bpm) {
+            auto guard = bpm.FetchPageRead(3);
+            return guard.GetContent()[16384 - disk::PAGE_HEADER_SIZE - 1];
+        });
+        EXPECT_EQ(last, 'a' + 3);
+    }
+    for (size_t i = 0; i < page_sizes.size(); ++i) remove(("test.db." + std::to_string(i)).c_str());
+}
+
+} // dsbus
@@ -0,0 +1,98 @@
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "buffer/clock_replacer.hpp"
+#include "buffer/replacer.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(ClockReplacerTest, ConceptTest) {
+    EXPECT_EQ(true, IsReplacer<ClockReplacer>::value);
+}
+
+TEST(ClockReplacerTest, VictimTest) {
+    int v;
+    ClockReplacer clock(3);
+    EXPECT_EQ(true, clock.Victim(&v)); EXPECT_EQ(0, v);
+    EXPECT_EQ(true, clock.Victim(&v)); EXPECT_EQ(1, v);
+    EXPECT_EQ(true, clock.Victim(&v)); EXPECT_EQ(2, v);
+    EXPECT_EQ(false, clock.Victim(&v));
+}
+
+TEST(ClockReplacerTest, PinUnpinTest) {
+    int v;
+    ClockReplacer clock(3);
+    clock.Pin(0);
+    clock.Pin(0);
+    clock.Pin(1);
+    EXPECT_EQ(1, clock.Size());
+    clock.Unpin(0);
+    EXPECT_EQ(1, clock.Size());
+    clock.Unpin(0);
+    clock.Unpin(1);
+    clock.Unpin(1);
+    EXPECT_EQ(3, clock.Size());
+    clock.Pin(2);
+    clock.Victim(&v);
+    clock.Victim(&v);
+    EXPECT_EQ(false, clock.Victim(&v));
+}
+
+TEST(ClockReplacerTest, SecondChanceTest) {
+    int v;
+    ClockReplacer clock(4);
+    for (int i = 0; i < 4; ++i) {
+        clock.Victim(&v);
+        clock.Unpin(v);
+    }
+    // frames 0 and 2 are referenced again
+    clock.Pin(0); clock.Unpin(0);
+    clock.Pin(2); clock.Unpin(2);
+    clock.Victim(&v); EXPECT_EQ(1, v);
+    clock.Victim(&v); EXPECT_EQ(3, v);
+    // the hand cleared the bits of 0 and 2 on its way
+    clock.Victim(&v); EXPECT_EQ(0, v);
+    clock.Victim(&v); EXPECT_EQ(2, v);
+    EXPECT_EQ(false, clock.Victim(&v));
+}
+
+TEST(ClockReplacerTest, NextVictimsTest) {
+    const size_t num_pages = 64;
+    ClockReplacer replacer(num_pages);
+    // load and reload 128 pages the way the buffer pool does
+    std::unordered_map<page_id_t, frame_id_t> resident;
+    std::vector<page_id_t> page_of(num_pages, INVALID_PAGE_ID);
+    std::mt19937 rng(7);
+    for (int i = 0; i < 2000; ++i) {
+        page_id_t page_id = rng() % 128;
+        frame_id_t frame_id = 0;
+        if (resident.count(page_id) != 0) {
+            frame_id = resident[page_id];
+            replacer.Pin(frame_id);
+        } else {
+            ASSERT_EQ(true, replacer.Victim(&frame_id));
+            resident.erase(page_of[frame_id]);
+            resident[page_id] = frame_id;
+            page_of[frame_id] = page_id;
+            replacer.Admit(frame_id, page_id);
+        }
+        replacer.Unpin(frame_id);
+    }
+    for (frame_id_t frame_id = 0; frame_id < 8; ++frame_id) replacer.Pin(frame_id);
+
+    std::vector<frame_id_t> next(num_pages);
+    EXPECT_EQ(4, replacer.NextVictims(next.data(), 4));
+    size_t n = replacer.NextVictims(next.data(), num_pages);
+    EXPECT_EQ(num_pages - 8, n);
+    // predicted without changing the victim order
+    for (size_t i = 0; i < n; ++i) {
+        frame_id_t v;
+        EXPECT_EQ(true, replacer.Victim(&v));
+        EXPECT_EQ(next[i], v);
+    }
+    EXPECT_EQ(0, replacer.NextVictims(next.data(), num_pages));
+}
+
+} // dsbus
@@ -0,0 +1,100 @@
+#include <cstdint>
+#include <cstring>
+#include "buffer/frame_arena.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(FrameArenaTest, AlignmentTest) {
+    FrameArena arena(10, 8192);
+    EXPECT_EQ(arena.GetFrameNum(), 10);
+    EXPECT_EQ(arena.GetFrameSize(), 8192);
+    for (size_t i = 0; i < arena.GetFrameNum(); ++i) {
+        EXPECT_EQ((uintptr_t)arena.GetFrame(i) % DIRECT_IO_ALIGNMENT, 0);
+        // every byte of every frame is usable
+        memset(arena.GetFrame(i), (int)i, arena.GetFrameSize());
+    }
+    EXPECT_EQ(arena.GetFrame(9)[8191], 9);
+}
+
+TEST(FrameArenaTest, SmallFrameTest) {
+    // frames smaller than the alignment are packed, only the first one is aligned
+    FrameArena arena(3, 100);
+    EXPECT_EQ((uintptr_t)arena.GetData() % DIRECT_IO_ALIGNMENT, 0);
+    EXPECT_EQ(arena.GetFrame(2) - arena.GetFrame(0), 200);
+    memset(arena.GetData(), 0, 300);
+
+    FrameArena empty(0, 4096);
+    EXPECT_NE(empty.GetData(), nullptr);
+}
+
+TEST(FrameArenaTest, TransparentHugePageTest) {
+    const size_t frame_num = 4 * HUGE_PAGE_SIZE / 8192;
+    FrameArena arena(frame_num, 8192, HugePageMode::TRANSPARENT);
+    // regular pages if the kernel has no transparent huge pages
+    EXPECT_NE(arena.GetHugePageMode(), HugePageMode::EXPLICIT);
+    if (arena.GetHugePageMode() == HugePageMode::TRANSPARENT) {
+        EXPECT_EQ((uintptr_t)arena.GetData() % HUGE_PAGE_SIZE, 0);
+    }
+    EXPECT_EQ(arena.GetReservedSize(), 4 * HUGE_PAGE_SIZE);
+    for (size_t i = 0; i < frame_num; ++i) memset(arena.GetFrame(i), (int)i, arena.GetFrameSize());
+    EXPECT_EQ(arena.GetFrame(frame_num - 1)[8191], (char)(frame_num - 1));
+    EXPECT_LE(arena.GetHugePageSize(), arena.GetReservedSize());
+}
+
+TEST(FrameArenaTest, ExplicitHugePageTest) {
+    // a size not a multiple of the huge page is rounded up, without huge pages reserved by the
+    // administrator the arena falls back to transparent ones
+    const size_t frame_num = HUGE_PAGE_SIZE / 4096 + 1;
+    FrameArena arena(frame_num, 4096, HugePageMode::EXPLICIT);
+    EXPECT_EQ((uintptr_t)arena.GetData() % DIRECT_IO_ALIGNMENT, 0);
+    if (arena.GetHugePageMode() == HugePageMode::EXPLICIT) {
+        EXPECT_EQ(arena.GetHugePageSize(), 2 * HUGE_PAGE_SIZE);
+    }
+    if (arena.GetHugePageMode() != HugePageMode::NONE) {
+        EXPECT_EQ(arena.GetReservedSize(), 2 * HUGE_PAGE_SIZE);
+    }
+    for (size_t i = 0; i < frame_num; ++i) memset(arena.GetFrame(i), (int)i, arena.GetFrameSize());
+    EXPECT_EQ(arena.GetFrame(frame_num - 1)[0], (char)(frame_num - 1));
+}
+
+TEST(FrameArenaTest, SmallHugePageTest) {
+    // an arena smaller than a huge page stays on regular pages
+    FrameArena arena(10, 8192, HugePageMode::EXPLICIT);
+    EXPECT_EQ(arena.GetHugePageMode(), HugePageMode::NONE);
+    EXPECT_EQ(arena.GetReservedSize(), 10 * 8192);
+    EXPECT_EQ(arena.GetHugePageSize(), 0);
+    memset(arena.GetData(), 0, 10 * 8192);
+}
+
+TEST(FrameArenaTest, ResizeTest) {
+    const size_t frame_size = 8192;
+    FrameArena arena(4, frame_size, HugePageMode::NONE, -1, 64);
+    EXPECT_EQ(arena.GetFrameNum(), 4);
+    EXPECT_EQ(arena.GetMaxFrameNum(), 64);
+    EXPECT_EQ((uintptr_t)arena.GetData() % DIRECT_IO_ALIGNMENT, 0);
+    EXPECT_EQ(arena.GetReservedSize(), 4 * frame_size);
+    auto data = arena.GetData();
+    arena.Resize(64);
+    EXPECT_EQ(arena.GetReservedSize(), 64 * frame_size);
+    for (size_t i = 0; i < 64; ++i) memset(arena.GetFrame(i), (int)i, frame_size);
+    // frames never move, those given up read back as zeroes
+    arena.Resize(2);
+    EXPECT_EQ(arena.GetData(), data);
+    EXPECT_EQ(arena.GetReservedSize(), 2 * frame_size);
+    EXPECT_EQ(arena.GetFrame(1)[0], 1);
+    arena.Resize(3);
+    EXPECT_EQ(arena.GetFrame(2)[0], 0);
+    arena.Resize(1000);
+    EXPECT_EQ(arena.GetFrameNum(), 64);
+
+    // without max frame num, a shrink keeps the memory
+    FrameArena fixed(4, frame_size);
+    EXPECT_EQ(fixed.GetMaxFrameNum(), 4);
+    fixed.Resize(2);
+    EXPECT_EQ(fixed.GetFrameNum(), 2);
+    fixed.Resize(4);
+    memset(fixed.GetData(), 0, 4 * frame_size);
+}
+
+} // dsbus
@@ -0,0 +1,142 @@
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "buffer/lru_k_replacer.hpp"
+#include "buffer/replacer.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(LRUKReplacerTest, ConceptTest) {
+    EXPECT_EQ(true, IsReplacer<LRUKReplacer>::value);
+}
+
+TEST(LRUKReplacerTest, VictimTest) {
+    int v;
+    LRUKReplacer lru_k(3);
+    EXPECT_EQ(3, lru_k.Size());
+    EXPECT_EQ(true, lru_k.Victim(&v)); EXPECT_EQ(0, v);
+    EXPECT_EQ(true, lru_k.Victim(&v)); EXPECT_EQ(1, v);
+    EXPECT_EQ(true, lru_k.Victim(&v)); EXPECT_EQ(2, v);
+    EXPECT_EQ(false, lru_k.Victim(&v));
+    EXPECT_EQ(0, lru_k.Size());
+}
+
+TEST(LRUKReplacerTest, PinUnpinTest) {
+    int v;
+    LRUKReplacer lru_k(3);
+    lru_k.Pin(0);
+    lru_k.Pin(0);
+    lru_k.Pin(1);
+    EXPECT_EQ(1, lru_k.Size());
+    lru_k.Unpin(0);
+    EXPECT_EQ(1, lru_k.Size());
+    lru_k.Unpin(0);
+    lru_k.Unpin(1);
+    // unpinning a frame that is not pinned does nothing
+    lru_k.Unpin(1);
+    EXPECT_EQ(3, lru_k.Size());
+    lru_k.Pin(2);
+    lru_k.Victim(&v);
+    lru_k.Victim(&v);
+    EXPECT_EQ(false, lru_k.Victim(&v));
+}
+
+TEST(LRUKReplacerTest, BackwardKDistanceTest) {
+    int v;
+    LRUKReplacer lru_k(4, 2);
+    for (int i = 0; i < 4; ++i) {
+        lru_k.Victim(&v);
+        lru_k.Admit(v, i);
+        lru_k.Unpin(v);
+    }
+    // frames 0 and 1 reach k accesses, 2 and 3 stay at one
+    lru_k.Pin(0); lru_k.Unpin(0);
+    lru_k.Pin(0); lru_k.Unpin(0);
+    lru_k.Pin(1); lru_k.Unpin(1);
+    // +inf distance first, oldest first access first
+    lru_k.Victim(&v); EXPECT_EQ(2, v);
+    lru_k.Victim(&v); EXPECT_EQ(3, v);
+    // then the oldest k-th most recent access, frame 0 forgot its first access
+    lru_k.Victim(&v); EXPECT_EQ(1, v);
+    lru_k.Victim(&v); EXPECT_EQ(0, v);
+}
+
+TEST(LRUKReplacerTest, ScanTest) {
+    int v;
+    LRUKReplacer lru_k(4, 2);
+    page_id_t page_id = 0;
+    // two hot frames accessed twice
+    for (int i = 0; i < 4; ++i) {
+        lru_k.Victim(&v);
+        lru_k.Admit(v, page_id++);
+        lru_k.Unpin(v);
+    }
+    lru_k.Pin(0); lru_k.Unpin(0);
+    lru_k.Pin(1); lru_k.Unpin(1);
+    // a long scan only recycles the frames touched once
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(true, lru_k.Victim(&v));
+        EXPECT_NE(0, v);
+        EXPECT_NE(1, v);
+        lru_k.Admit(v, page_id++);
+        lru_k.Unpin(v);
+    }
+}
+
+TEST(LRUKReplacerTest, RecordAccessTest) {
+    int v;
+    LRUKReplacer lru_k(3, 2);
+    for (int i = 0; i < 3; ++i) {
+        lru_k.Victim(&v);
+        lru_k.Admit(v, i);
+    }
+    // frame 0 was accessed while pinned, by users that never pinned it from 0
+    lru_k.RecordAccess(0, 5);
+    for (int i = 0; i < 3; ++i) lru_k.Unpin(i);
+    // accesses of a frame that is not pinned are not recorded
+    lru_k.RecordAccess(1, 5);
+    lru_k.Victim(&v); EXPECT_EQ(1, v);
+    lru_k.Victim(&v); EXPECT_EQ(2, v);
+    lru_k.Victim(&v); EXPECT_EQ(0, v);
+}
+
+TEST(LRUKReplacerTest, NextVictimsTest) {
+    const size_t num_pages = 64;
+    LRUKReplacer replacer(num_pages);
+    // load and reload 128 pages the way the buffer pool does
+    std::unordered_map<page_id_t, frame_id_t> resident;
+    std::vector<page_id_t> page_of(num_pages, INVALID_PAGE_ID);
+    std::mt19937 rng(7);
+    for (int i = 0; i < 2000; ++i) {
+        page_id_t page_id = rng() % 128;
+        frame_id_t frame_id = 0;
+        if (resident.count(page_id) != 0) {
+            frame_id = resident[page_id];
+            replacer.Pin(frame_id);
+        } else {
+            ASSERT_EQ(true, replacer.Victim(&frame_id));
+            resident.erase(page_of[frame_id]);
+            resident[page_id] = frame_id;
+            page_of[frame_id] = page_id;
+            replacer.Admit(frame_id, page_id);
+        }
+        replacer.Unpin(frame_id);
+    }
+    for (frame_id_t frame_id = 0; frame_id < 8; ++frame_id) replacer.Pin(frame_id);
+
+    std::vector<frame_id_t> next(num_pages);
+    EXPECT_EQ(4, replacer.NextVictims(next.data(), 4));
+    size_t n = replacer.NextVictims(next.data(), num_pages);
+    EXPECT_EQ(num_pages - 8, n);
+    // predicted without changing the victim order
+    for (size_t i = 0; i < n; ++i) {
+        frame_id_t v;
+        EXPECT_EQ(true, replacer.Victim(&v));
+        EXPECT_EQ(next[i], v);
+    }
+    EXPECT_EQ(0, replacer.NextVictims(next.data(), num_pages));
+}
+
+} // dsbus
@@ -1,4 +1,7 @@
 #include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
 #include "buffer/lru_replacer.hpp"
 #include "gtest/gtest.h"
 
@@ -146,4 +149,77 @@ TEST(LRUReplacerTest, SampleTest2) {
     EXPECT_EQ(7, lru.Size());
 }
 
-} // dsbus
\ No newline at end of file
+TEST(LRUReplacerTest, NextVictimsTest) {
+    const size_t num_pages = 64;
+    LRUReplacer replacer(num_pages);
+    // load and reload 128 pages the way the buffer pool does
+    std::unordered_map<page_id_t, frame_id_t> resident;
+    std::vector<page_id_t> page_of(num_pages, INVALID_PAGE_ID);
+    std::mt19937 rng(7);
+    for (int i = 0; i < 2000; ++i) {
+        page_id_t page_id = rng() % 128;
+        frame_id_t frame_id = 0;
+        if (resident.count(page_id) != 0) {
+            frame_id = resident[page_id];
+            replacer.Pin(frame_id);
+        } else {
+            ASSERT_EQ(true, replacer.Victim(&frame_id));
+            resident.erase(page_of[frame_id]);
+            resident[page_id] = frame_id;
+            page_of[frame_id] = page_id;
+            replacer.Admit(frame_id, page_id);
+        }
+        replacer.Unpin(frame_id);
+    }
+    for (frame_id_t frame_id = 0; frame_id < 8; ++frame_id) replacer.Pin(frame_id);
+
+    std::vector<frame_id_t> next(num_pages);
+    EXPECT_EQ(4, replacer.NextVictims(next.data(), 4));
+    size_t n = replacer.NextVictims(next.data(), num_pages);
+    EXPECT_EQ(num_pages - 8, n);
+    // predicted without changing the victim order
+    for (size_t i = 0; i < n; ++i) {
+        frame_id_t v;
+        EXPECT_EQ(true, replacer.Victim(&v));
+        EXPECT_EQ(next[i], v);
+    }
+    EXPECT_EQ(0, replacer.NextVictims(next.data(), num_pages));
+}
+
+TEST(LRUReplacerTest, FreeTest) {
+    int v;
+    LRUReplacer lru(3);
+    for (int i = 0; i < 3; ++i) lru.Victim(&v);
+    lru.Unpin(0);
+    lru.Unpin(1);
+    // frame 2 lost its page while pinned, it goes before the least recently used frame
+    lru.Free(2);
+    EXPECT_EQ(3, lru.Size());
+    lru.Victim(&v); EXPECT_EQ(2, v);
+    lru.Victim(&v); EXPECT_EQ(0, v);
+    // an unpinned frame is left where it is
+    lru.Free(1);
+    lru.Victim(&v); EXPECT_EQ(1, v);
+}
+
+TEST(LRUReplacerTest, SetCapacityTest) {
+    int v;
+    LRUReplacer lru(4);
+    // the pool uses frames 0 and 1, it keeps the others pinned
+    lru.Pin(2);
+    lru.Pin(3);
+    lru.SetCapacity(2);
+    EXPECT_EQ(2, lru.Size());
+    lru.Victim(&v); EXPECT_EQ(0, v);
+    lru.Unpin(0);
+    // frames used again are free, victimized before frame 0
+    lru.SetCapacity(4);
+    EXPECT_EQ(4, lru.Size());
+    lru.Victim(&v); EXPECT_EQ(1, v);
+    lru.Victim(&v); EXPECT_EQ(2, v);
+    lru.Victim(&v); EXPECT_EQ(3, v);
+    lru.Victim(&v); EXPECT_EQ(0, v);
+    EXPECT_EQ(false, lru.Victim(&v));
+}
+
+} // dsbus
@@ -0,0 +1,210 @@
+#include <cstring>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "slice/slice.hpp"
+#include "disk/disk_manager.hpp"
+#include "buffer/buffer_pool_manager.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(PageGuardTest, AutoUnpinTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(2, &disk_manager);
+        for (int i = 0; i < 10; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            EXPECT_EQ(guard.IsValid(), true);
+            EXPECT_EQ(guard.GetPageId(), i);
+        }
+        {
+            auto guard1 = bpm.FetchPageRead(0);
+            auto guard2 = bpm.FetchPageRead(1);
+            EXPECT_EQ(guard1.IsValid(), true);
+            EXPECT_EQ(guard2.IsValid(), true);
+            EXPECT_EQ(bpm.FetchPageRead(2).IsValid(), false);
+            guard2.Drop();
+            EXPECT_EQ(guard2.IsValid(), false);
+            EXPECT_EQ(bpm.FetchPageRead(2).IsValid(), true);
+        }
+        EXPECT_EQ(bpm.NewPageGuarded().IsValid(), true);
+        EXPECT_EQ(bpm.NewPageGuarded().IsValid(), true);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(PageGuardTest, MoveTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(2, &disk_manager);
+        auto guard1 = bpm.NewPageGuarded();
+        auto guard2 = std::move(guard1);
+        EXPECT_EQ(guard1.IsValid(), false);
+        EXPECT_EQ(guard2.GetPageId(), 0);
+
+        auto guard3 = bpm.NewPageGuarded();
+        // the page held by guard3 is unpinned here, its frame can be reused
+        guard3 = std::move(guard2);
+        EXPECT_EQ(guard3.GetPageId(), 0);
+        EXPECT_EQ(bpm.NewPageGuarded().IsValid(), true);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(PageGuardTest, DirtyTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(1, &disk_manager);
+        {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), "page0", 5);
+        }
+        {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), "page1", 5);
+        }
+        {
+            // page 0 was written back when page 1 took its frame
+            auto guard = bpm.FetchPageWrite(0);
+            EXPECT_EQ(strncmp(guard.GetContent(), "page0", 5), 0);
+            memcpy(guard.GetContentMut(), "again", 5);
+        }
+        EXPECT_EQ(strncmp(bpm.FetchPageRead(1).GetContent(), "page1", 5), 0);
+        EXPECT_EQ(strncmp(bpm.FetchPageRead(0).GetContent(), "again", 5), 0);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(PageGuardTest, ConcurrentWriteTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int thread_num = 8;
+    const int round_num = 1000;
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(4, &disk_manager);
+        for (int i = 0; i < 2; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memset(guard.GetContentMut(), 0, sizeof(int));
+        }
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_num; ++t) {
+            threads.emplace_back([&bpm]() {
+                for (int i = 0; i < round_num; ++i) {
+                    {
+                        auto guard = bpm.FetchPageWrite(i % 2);
+                        ++*(int *)guard.GetContentMut();
+                    }
+                    auto guard = bpm.FetchPageRead(i % 2);
+                    EXPECT_GT(*(const int *)guard.GetContent(), 0);
+                }
+            });
+        }
+        for (auto &thread : threads) thread.join();
+        EXPECT_EQ(*(const int *)bpm.FetchPageRead(0).GetContent(), thread_num * round_num / 2);
+        EXPECT_EQ(*(const int *)bpm.FetchPageRead(1).GetContent(), thread_num * round_num / 2);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(PageGuardTest, OptimisticReadTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(2, &disk_manager);
+        for (int i = 0; i < 4; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        auto guard = bpm.FetchPageOptimistic(2);
+        EXPECT_EQ(guard.IsValid(), true);
+        EXPECT_EQ(guard.GetPageId(), 2);
+        int value = -1;
+        EXPECT_TRUE(guard.Read([&](const char *content) { memcpy(&value, content, sizeof(value)); }));
+        EXPECT_EQ(value, 2);
+        EXPECT_TRUE(guard.Validate());
+        // a writer moves the version, the next read sees its change
+        {
+            auto write_guard = bpm.FetchPageWrite(2);
+            int new_value = 20;
+            memcpy(write_guard.GetContentMut(), &new_value, sizeof(new_value));
+        }
+        EXPECT_FALSE(guard.Validate());
+        EXPECT_TRUE(guard.Read([&](const char *content) { memcpy(&value, content, sizeof(value)); }));
+        EXPECT_EQ(value, 20);
+        EXPECT_TRUE(guard.Validate());
+        // the optimistic guard does not pin the page, both frames can take other pages
+        EXPECT_EQ(bpm.FetchPageRead(0).IsValid(), true);
+        EXPECT_EQ(bpm.FetchPageRead(1).IsValid(), true);
+        EXPECT_FALSE(guard.Read([&](const char *content) { memcpy(&value, content, sizeof(value)); }));
+        EXPECT_EQ(guard.IsValid(), false);
+        EXPECT_FALSE(guard.Validate());
+
+        auto deleted_guard = bpm.FetchPageOptimistic(3);
+        EXPECT_TRUE(bpm.DeletePage(3));
+        EXPECT_FALSE(deleted_guard.Read([](const char *) {}));
+        guard = bpm.FetchPageOptimistic(2);
+        EXPECT_TRUE(guard.Read([&](const char *content) { memcpy(&value, content, sizeof(value)); }));
+        EXPECT_EQ(value, 20);
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(PageGuardTest, ConcurrentOptimisticReadTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int write_num = 10000;
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    {
+        BufferPoolManager<page_size> bpm(4, &disk_manager);
+        bpm.NewPageGuarded();
+        std::thread writer([&bpm]() {
+            // both halves of the page always hold the same value
+            for (int i = 1; i <= write_num; ++i) {
+                auto guard = bpm.FetchPageWrite(0);
+                if (!guard.IsValid()) continue;
+                auto content = (int *)guard.GetContentMut();
+                // atomic stores only for the sake of race detectors, torn reads are retried
+                __atomic_store_n(content, i, __ATOMIC_RELAXED);
+                __atomic_store_n(content + 16, i, __ATOMIC_RELAXED);
+            }
+        });
+        std::vector<std::thread> readers;
+        for (int t = 0; t < 2; ++t) {
+            readers.emplace_back([&bpm]() {
+                auto guard = bpm.FetchPageOptimistic(0);
+                int last = 0;
+                while (last < write_num) {
+                    int first = 0;
+                    int second = 0;
+                    EXPECT_TRUE(guard.Read([&](const char *content) {
+                        first = __atomic_load_n((const int *)content, __ATOMIC_RELAXED);
+                        second = __atomic_load_n((const int *)content + 16, __ATOMIC_RELAXED);
+                    }));
+                    EXPECT_EQ(first, second);
+                    EXPECT_GE(first, last);
+                    last = first;
+                }
+            });
+        }
+        writer.join();
+        for (auto &reader : readers) reader.join();
+    }
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+} // dsbus
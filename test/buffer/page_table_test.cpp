@@ -0,0 +1,79 @@
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "buffer/page_table.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(PageTableTest, ConstructorTest) {
+    PageTable table1(16);
+    EXPECT_EQ(table1.GetShardNum(), 16);
+    PageTable table2(10);
+    EXPECT_EQ(table2.GetShardNum(), 16);
+    PageTable table3(1);
+    EXPECT_EQ(table3.GetShardNum(), 1);
+}
+
+TEST(PageTableTest, InsertFindEraseTest) {
+    PageTable table(4);
+    frame_id_t frame_id;
+    for (page_id_t i = 0; i < 100; ++i) {
+        auto &shard = table.GetShard(i);
+        shard.latch_.WLock();
+        shard.Insert(i, i * 2);
+        shard.latch_.WUnlock();
+    }
+    for (page_id_t i = 0; i < 100; ++i) {
+        auto &shard = table.GetShard(i);
+        EXPECT_EQ(true, shard.Find(i, &frame_id));
+        EXPECT_EQ(i * 2, frame_id);
+    }
+    EXPECT_EQ(false, table.GetShard(100).Find(100, &frame_id));
+    EXPECT_EQ(true, table.GetShard(7).Erase(7));
+    EXPECT_EQ(false, table.GetShard(7).Erase(7));
+    EXPECT_EQ(false, table.GetShard(7).Find(7, &frame_id));
+
+    size_t total = 0;
+    std::vector<std::pair<page_id_t, frame_id_t>> entries;
+    for (size_t i = 0; i < table.GetShardNum(); ++i) {
+        total += table.GetShardAt(i).Size();
+        table.GetShardAt(i).Collect(&entries);
+    }
+    EXPECT_EQ(99, total);
+    EXPECT_EQ(99, entries.size());
+}
+
+TEST(PageTableTest, SpreadTest) {
+    // consecutive page ids should not pile up in one shard
+    PageTable table(16);
+    for (page_id_t i = 0; i < 1600; ++i) table.GetShard(i).Insert(i, 0);
+    for (size_t i = 0; i < table.GetShardNum(); ++i) {
+        EXPECT_GT(table.GetShardAt(i).Size(), 50);
+    }
+}
+
+TEST(PageTableTest, ConcurrentTest) {
+    PageTable table(8);
+    const int thread_num = 4;
+    const int page_num = 1000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_num; ++t) {
+        threads.emplace_back([&table, t]() {
+            for (page_id_t i = t; i < page_num * thread_num; i += thread_num) {
+                auto &shard = table.GetShard(i);
+                shard.latch_.WLock();
+                shard.Insert(i, t);
+                shard.latch_.WUnlock();
+            }
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    frame_id_t frame_id;
+    for (page_id_t i = 0; i < page_num * thread_num; ++i) {
+        EXPECT_EQ(true, table.GetShard(i).Find(i, &frame_id));
+        EXPECT_EQ(i % thread_num, frame_id);
+    }
+}
+
+} // dsbus
@@ -0,0 +1,188 @@
+#include <atomic>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "slice/slice.hpp"
+#include "disk/disk_manager.hpp"
+#include "buffer/partitioned_buffer_pool.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(PartitionedBufferPoolTest, RoutingTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 200;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        PartitionedBufferPool<page_size> pool(64, &disk_manager, 3, BufferPoolOptions(), 8);
+        EXPECT_EQ(pool.GetPartitionNum(), 3);
+        EXPECT_EQ(pool.GetPoolSize(), 64);
+        EXPECT_EQ(pool.GetPartition(0).GetPoolSize(), 22);
+        EXPECT_EQ(pool.GetPartition(2).GetPoolSize(), 21);
+        EXPECT_EQ(pool.GetPartitionIndex(7), 0);
+        EXPECT_EQ(pool.GetPartitionIndex(8), 1);
+        EXPECT_EQ(pool.GetPartitionIndex(24), 0);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = pool.NewPageGuarded();
+            EXPECT_EQ(guard.GetPageId(), i);
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        for (int i = page_num - 1; i >= 0; --i) {
+            auto guard = pool.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+        // a page pins a frame of its partition only
+        std::vector<disk::Page<page_size> *> pages;
+        for (int i = 0; i < 8; ++i) pages.push_back(pool.FetchPage(i));
+        EXPECT_EQ(pool.GetPartition(0).GetDirtyPageTable().size() + pool.GetPartition(1).GetDirtyPageTable().size()
+                  + pool.GetPartition(2).GetDirtyPageTable().size(), pool.GetDirtyPageTable().size());
+        for (int i = 0; i < 8; ++i) EXPECT_TRUE(pool.UnpinPage(i, false));
+        EXPECT_TRUE(pool.DeletePage(5));
+        EXPECT_EQ(pool.NewPageGuarded().GetPageId(), 5);
+    }
+    {
+        // the pages survive whatever the partitioning
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        PartitionedBufferPool<page_size> pool(16, &disk_manager, 2);
+        for (int i = 0; i < page_num; ++i) {
+            if (i == 5) continue;
+            auto guard = pool.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+    }
+    remove("test.db");
+}
+
+class PageCountingDiskManager : public DiskManager {
+public:
+    PageCountingDiskManager(const Slice &db_file, const size_t page_size, const size_t page_num)
+                          : DiskManager(db_file, page_size), read_nums_(page_num) {}
+
+    void ReadPage(page_id_t page_id, char *page_data) {
+        ++read_nums_[page_id];
+        DiskManager::ReadPage(page_id, page_data);
+    }
+
+    void ReadPagesAsync(const std::vector<std::pair<page_id_t, char *>> &pages, std::function<void(size_t)> callback) {
+        for (auto &page : pages) ++read_nums_[page.first];
+        async_read_num_ += pages.size();
+        DiskManager::ReadPagesAsync(pages, callback);
+    }
+
+    std::vector<std::atomic<size_t>> read_nums_;
+    std::atomic<size_t> async_read_num_{0};
+};
+
+TEST(PartitionedBufferPoolTest, ReadAheadTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 256;
+    PageCountingDiskManager disk_manager(Slice("test.db"), page_size, page_num);
+    {
+        PartitionedBufferPool<page_size, LRUReplacer, PageCountingDiskManager> pool(16, &disk_manager, 2);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = pool.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+    }
+    {
+        // windows stop at the end of extents, no page is read by a partition not caching it
+        PartitionedBufferPool<page_size, LRUReplacer, PageCountingDiskManager> pool(512, &disk_manager, 2,
+                                                                                     BufferPoolOptions(), 16);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = pool.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+        for (int i = 0; i < page_num; ++i) EXPECT_EQ(disk_manager.read_nums_[i].load(), 1) << i;
+        // the two misses starting each extent are waited for
+        EXPECT_EQ(disk_manager.async_read_num_.load(), page_num - 2 * page_num / 16);
+    }
+    remove("test.db");
+}
+
+TEST(PartitionedBufferPoolTest, ConcurrentTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 256;
+    const int thread_num = 4;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        PartitionedBufferPool<page_size> pool(64, &disk_manager, 4, BufferPoolOptions(), 4);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = pool.NewPageGuarded();
+            memset(guard.GetContentMut(), 0, sizeof(int));
+        }
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_num; ++t) {
+            threads.emplace_back([&pool]() {
+                for (int round = 0; round < 4; ++round) {
+                    for (int i = 0; i < page_num; ++i) {
+                        auto guard = pool.FetchPageWrite(i);
+                        ++*(int *)guard.GetContentMut();
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) thread.join();
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = pool.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), 4 * thread_num);
+        }
+    }
+    remove("test.db");
+}
+
+TEST(PartitionedBufferPoolTest, ResizeTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolOptions options;
+        options.max_pool_size_ = 66;
+        PartitionedBufferPool<page_size> pool(10, &disk_manager, 4, options, 4);
+        EXPECT_EQ(pool.GetMaxPoolSize(), 66);
+        EXPECT_EQ(pool.GetPartition(0).GetMaxPoolSize(), 17);
+        EXPECT_EQ(pool.GetPartition(3).GetMaxPoolSize(), 16);
+        EXPECT_EQ(pool.Resize(64), 64);
+        for (size_t i = 0; i < pool.GetPartitionNum(); ++i) EXPECT_EQ(pool.GetPartition(i).GetPoolSize(), 16);
+        for (int i = 0; i < 64; ++i) {
+            auto guard = pool.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        EXPECT_EQ(pool.Resize(6), 6);
+        EXPECT_EQ(pool.GetPoolSize(), 6);
+        for (int i = 0; i < 64; ++i) {
+            auto guard = pool.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), i);
+        }
+    }
+    remove("test.db");
+}
+
+TEST(PartitionedBufferPoolTest, NumaTest) {
+    EXPECT_GE(numa::GetNodeNum(), 1);
+    EXPECT_GE(numa::GetCurrentNode(), 0);
+    EXPECT_LT((size_t)numa::GetCurrentNode(), numa::GetNodeNum());
+    // binding to node 0 always works, to a node past the last never does
+    FrameArena arena(16, 4096, HugePageMode::NONE, 0);
+    EXPECT_EQ(arena.GetNumaNode(), 0);
+    memset(arena.GetData(), 1, 16 * 4096);
+    FrameArena unbound(16, 4096, HugePageMode::NONE, (int)numa::GetNodeNum());
+    EXPECT_EQ(unbound.GetNumaNode(), -1);
+
+    remove("test.db");
+    {
+        DiskManager disk_manager(Slice("test.db"), 128);
+        PartitionedBufferPool<128> pool(64, &disk_manager);
+        EXPECT_EQ(pool.GetPartitionNum(), numa::GetNodeNum());
+        for (size_t i = 0; i < pool.GetPartitionNum(); ++i) {
+            EXPECT_EQ(pool.GetPartitionNode(i), numa::GetNodeNum() > 1 ? (int)i : -1);
+            EXPECT_EQ(pool.GetPartition(i).GetMemoryStats().numa_node_, pool.GetPartitionNode(i));
+        }
+    }
+    remove("test.db");
+}
+
+} // dsbus
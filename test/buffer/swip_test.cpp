@@ -0,0 +1,150 @@
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "slice/slice.hpp"
+#include "disk/disk_manager.hpp"
+#include "buffer/buffer_pool_manager.hpp"
+#include "buffer/partitioned_buffer_pool.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(SwipTest, EncodeTest) {
+    Swip swip;
+    EXPECT_FALSE(swip.IsSwizzled());
+    EXPECT_EQ(swip.GetPageId(), INVALID_PAGE_ID);
+    swip.SetPageId(42);
+    EXPECT_EQ(swip.GetPageId(), 42);
+    Swip large((page_id_t)1 << 40);
+    EXPECT_EQ(large.GetPageId(), (page_id_t)1 << 40);
+}
+
+TEST(SwipTest, SwizzleTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    Swip outliving(1);
+    {
+        BufferPoolManager<page_size> bpm(2, &disk_manager);
+        for (int i = 0; i < 4; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        Swip swip(2);
+        {
+            auto guard = bpm.FetchPageRead(swip);
+            EXPECT_EQ(*(const int *)guard.GetContent(), 2);
+        }
+        EXPECT_TRUE(swip.IsSwizzled());
+        EXPECT_EQ(swip.GetPageId(), 2);
+        {
+            auto guard = bpm.FetchPageWrite(swip);
+            EXPECT_EQ(guard.GetPageId(), 2);
+            int value = 20;
+            memcpy(guard.GetContentMut(), &value, sizeof(value));
+        }
+        // a second swip of the page finds it through the page table, and stays a page id
+        Swip other(2);
+        EXPECT_EQ(*(const int *)bpm.FetchPageRead(other).GetContent(), 20);
+        EXPECT_FALSE(other.IsSwizzled());
+
+        // evictions unswizzle
+        bpm.FetchPageRead(0);
+        bpm.FetchPageRead(1);
+        EXPECT_FALSE(swip.IsSwizzled());
+        EXPECT_EQ(swip.GetPageId(), 2);
+        EXPECT_EQ(*(const int *)bpm.FetchPageRead(swip).GetContent(), 20);
+        EXPECT_TRUE(swip.IsSwizzled());
+
+        bpm.Unswizzle(swip);
+        EXPECT_FALSE(swip.IsSwizzled());
+        // the page of a swip unswizzled by hand can take another swip
+        EXPECT_EQ(*(const int *)bpm.FetchPageRead(other).GetContent(), 20);
+        EXPECT_TRUE(other.IsSwizzled());
+
+        // deleting the page unswizzles, as long as it is not pinned
+        {
+            auto guard = bpm.FetchPageRead(other);
+            EXPECT_FALSE(bpm.DeletePage(2));
+        }
+        EXPECT_TRUE(bpm.DeletePage(2));
+        EXPECT_FALSE(other.IsSwizzled());
+        EXPECT_EQ(other.GetPageId(), 2);
+
+        EXPECT_EQ(*(const int *)bpm.FetchPageRead(outliving).GetContent(), 1);
+        EXPECT_TRUE(outliving.IsSwizzled());
+    }
+    // the pool unswizzles the swips that outlive it
+    EXPECT_FALSE(outliving.IsSwizzled());
+    EXPECT_EQ(outliving.GetPageId(), 1);
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(SwipTest, PartitionedTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        PartitionedBufferPool<page_size> pool(16, &disk_manager, 2, BufferPoolOptions(), 1);
+        for (int i = 0; i < 4; ++i) {
+            auto guard = pool.NewPageGuarded();
+            memcpy(guard.GetContentMut(), &i, sizeof(i));
+        }
+        std::vector<std::unique_ptr<Swip>> swips;
+        for (int i = 0; i < 4; ++i) swips.emplace_back(new Swip(i));
+        for (int round = 0; round < 2; ++round) {
+            for (int i = 0; i < 4; ++i) EXPECT_EQ(*(const int *)pool.FetchPageRead(*swips[i]).GetContent(), i);
+        }
+        for (auto &swip : swips) {
+            EXPECT_TRUE(swip->IsSwizzled());
+            pool.Unswizzle(*swip);
+            EXPECT_FALSE(swip->IsSwizzled());
+        }
+    }
+    remove("test.db");
+}
+
+TEST(SwipTest, ConcurrentTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 32;
+    const int thread_num = 4;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        // fewer frames than pages, swips are swizzled and unswizzled all along
+        BufferPoolManager<page_size> bpm(8, &disk_manager);
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.NewPageGuarded();
+            int zero = 0;
+            memcpy(guard.GetContentMut(), &zero, sizeof(zero));
+        }
+        std::vector<std::unique_ptr<Swip>> swips;
+        for (int i = 0; i < page_num; ++i) swips.emplace_back(new Swip(i));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_num; ++t) {
+            threads.emplace_back([&swips, &bpm, t]() {
+                for (int round = 0; round < 50; ++round) {
+                    for (int i = 0; i < page_num; ++i) {
+                        // hot pages 0 and 1 between every other page
+                        auto &swip = *swips[i % 3 == 0 ? (i + t) % 2 : i];
+                        auto guard = bpm.FetchPageWrite(swip);
+                        EXPECT_EQ(guard.GetPageId(), swip.GetPageId());
+                        ++*(int *)guard.GetContentMut();
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) thread.join();
+        int sum = 0;
+        for (int i = 0; i < page_num; ++i) {
+            sum += *(const int *)bpm.FetchPageRead(i).GetContent();
+            bpm.Unswizzle(*swips[i]);
+        }
+        EXPECT_EQ(sum, thread_num * 50 * page_num);
+    }
+    remove("test.db");
+}
+
+} // dsbus
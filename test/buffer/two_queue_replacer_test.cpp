@@ -0,0 +1,89 @@
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "buffer/two_queue_replacer.hpp"
+#include "buffer/replacer.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(TwoQueueReplacerTest, ConceptTest) {
+    EXPECT_EQ(true, IsReplacer<TwoQueueReplacer>::value);
+}
+
+TEST(TwoQueueReplacerTest, PinUnpinTest) {
+    int v;
+    TwoQueueReplacer two_queue(3);
+    EXPECT_EQ(3, two_queue.Size());
+    two_queue.Pin(0);
+    two_queue.Pin(0);
+    two_queue.Pin(1);
+    EXPECT_EQ(1, two_queue.Size());
+    two_queue.Victim(&v); EXPECT_EQ(2, v);
+    EXPECT_EQ(false, two_queue.Victim(&v));
+    two_queue.Unpin(0);
+    two_queue.Unpin(1);
+    two_queue.Unpin(1);
+    EXPECT_EQ(1, two_queue.Size());
+    two_queue.Victim(&v); EXPECT_EQ(1, v);
+}
+
+TEST(TwoQueueReplacerTest, GhostHitTest) {
+    int v;
+    // A1in keeps 1 frame, A1out remembers 4 pages
+    TwoQueueReplacer two_queue(3, 1, 4);
+    two_queue.Victim(&v); two_queue.Admit(v, 10); two_queue.Unpin(v);
+    two_queue.Victim(&v); two_queue.Admit(v, 11); two_queue.Unpin(v);
+    two_queue.Victim(&v); two_queue.Admit(v, 12); two_queue.Unpin(v);
+    // page 10 is evicted from A1in and remembered
+    two_queue.Victim(&v); EXPECT_EQ(0, v);
+    // loading 10 again makes it hot
+    two_queue.Admit(v, 10); two_queue.Unpin(v);
+    // scan pages go through A1in only, page 10 stays
+    for (page_id_t page_id = 100; page_id < 110; ++page_id) {
+        EXPECT_EQ(true, two_queue.Victim(&v));
+        EXPECT_NE(0, v);
+        two_queue.Admit(v, page_id);
+        two_queue.Unpin(v);
+    }
+}
+
+TEST(TwoQueueReplacerTest, NextVictimsTest) {
+    const size_t num_pages = 64;
+    TwoQueueReplacer replacer(num_pages);
+    // load and reload 128 pages the way the buffer pool does
+    std::unordered_map<page_id_t, frame_id_t> resident;
+    std::vector<page_id_t> page_of(num_pages, INVALID_PAGE_ID);
+    std::mt19937 rng(7);
+    for (int i = 0; i < 2000; ++i) {
+        page_id_t page_id = rng() % 128;
+        frame_id_t frame_id = 0;
+        if (resident.count(page_id) != 0) {
+            frame_id = resident[page_id];
+            replacer.Pin(frame_id);
+        } else {
+            ASSERT_EQ(true, replacer.Victim(&frame_id));
+            resident.erase(page_of[frame_id]);
+            resident[page_id] = frame_id;
+            page_of[frame_id] = page_id;
+            replacer.Admit(frame_id, page_id);
+        }
+        replacer.Unpin(frame_id);
+    }
+    for (frame_id_t frame_id = 0; frame_id < 8; ++frame_id) replacer.Pin(frame_id);
+
+    std::vector<frame_id_t> next(num_pages);
+    EXPECT_EQ(4, replacer.NextVictims(next.data(), 4));
+    size_t n = replacer.NextVictims(next.data(), num_pages);
+    EXPECT_EQ(num_pages - 8, n);
+    // predicted without changing the victim order
+    for (size_t i = 0; i < n; ++i) {
+        frame_id_t v;
+        EXPECT_EQ(true, replacer.Victim(&v));
+        EXPECT_EQ(next[i], v);
+    }
+    EXPECT_EQ(0, replacer.NextVictims(next.data(), num_pages));
+}
+
+} // dsbus
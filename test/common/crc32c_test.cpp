@@ -0,0 +1,38 @@
+#include <random>
+#include <string>
+#include <vector>
+#include "common/crc32c.h"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(Crc32cTest, KnownValueTest) {
+    EXPECT_EQ(Crc32c("", 0), 0);
+    EXPECT_EQ(Crc32c("123456789", 9), 0xe3069283);
+    std::vector<char> zeros(32, 0);
+    EXPECT_EQ(Crc32c(zeros.data(), zeros.size()), 0x8a9136aa);
+    std::vector<char> ones(32, (char)0xff);
+    EXPECT_EQ(Crc32c(ones.data(), ones.size()), 0x62a8ab43);
+}
+
+TEST(Crc32cTest, ExtendTest) {
+    std::string s = "hello world, hello crc";
+    for (size_t split = 0; split <= s.size(); ++split) {
+        EXPECT_EQ(Crc32c(s.data() + split, s.size() - split, Crc32c(s.data(), split)), Crc32c(s.data(), s.size()));
+    }
+}
+
+TEST(Crc32cTest, HardwareSoftwareTest) {
+    // sizes and offsets reaching the long and short lanes, and their remainders
+    std::vector<unsigned char> data(3 * crc32c::LONG_LANE_SIZE * 2 + 100);
+    std::mt19937 rng(42);
+    for (auto &byte : data) byte = (unsigned char)rng();
+    for (size_t size : {0, 1, 7, 8, 767, 768, 769, 4096, 3 * 8192, 3 * 8192 + 3 * 256 + 13, 49152}) {
+        for (size_t offset : {0, 3}) {
+            EXPECT_EQ(crc32c::ExtendHardware(0x12345678, data.data() + offset, size),
+                      crc32c::ExtendSoftware(0x12345678, data.data() + offset, size));
+        }
+    }
+}
+
+} // dsbus
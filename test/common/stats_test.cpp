@@ -0,0 +1,57 @@
+#include <thread>
+#include <vector>
+#include "common/stats.h"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(StatsTest, StripedCountersTest) {
+    StripedCounters<2> counters;
+    EXPECT_EQ(counters.Get(0), 0);
+    // more threads than slots, some of them share one
+    const int thread_num = STATS_SLOT_NUM + 4;
+    const int add_num = 1000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_num; ++t) {
+        threads.emplace_back([&counters]() {
+            for (int i = 0; i < add_num; ++i) {
+                counters.Add(0);
+                counters.Add(1, 2);
+            }
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    EXPECT_EQ(counters.Get(0), thread_num * add_num);
+    EXPECT_EQ(counters.Get(1), thread_num * add_num * 2);
+}
+
+TEST(StatsTest, LatencyHistogramTest) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.GetSnapshot().GetPercentileNanos(0.5), 0);
+    for (uint64_t nanos : {0, 1, 2, 3, 1000}) histogram.Record(nanos);
+    auto snapshot = histogram.GetSnapshot();
+    EXPECT_EQ(snapshot.count_, 5);
+    EXPECT_EQ(snapshot.sum_nanos_, 1006);
+    EXPECT_EQ(snapshot.max_nanos_, 1000);
+    EXPECT_DOUBLE_EQ(snapshot.GetMeanNanos(), 201.2);
+    EXPECT_EQ(snapshot.buckets_[0], 1);
+    EXPECT_EQ(snapshot.buckets_[1], 1);
+    EXPECT_EQ(snapshot.buckets_[2], 2);
+    // [512, 1024)
+    EXPECT_EQ(snapshot.buckets_[10], 1);
+    EXPECT_EQ(snapshot.GetPercentileNanos(0.2), 0);
+    EXPECT_EQ(snapshot.GetPercentileNanos(0.5), 3);
+    EXPECT_EQ(snapshot.GetPercentileNanos(0.8), 3);
+    // the end of the last bucket is above any sample
+    EXPECT_EQ(snapshot.GetPercentileNanos(1), 1000);
+
+    histogram.Record((uint64_t)1 << 62);
+    EXPECT_EQ(histogram.GetSnapshot().buckets_[LatencySnapshot::BUCKET_NUM - 1], 1);
+
+    snapshot.Merge(histogram.GetSnapshot());
+    EXPECT_EQ(snapshot.count_, 11);
+    EXPECT_EQ(snapshot.max_nanos_, (uint64_t)1 << 62);
+    EXPECT_EQ(snapshot.buckets_[2], 4);
+}
+
+} // dsbus
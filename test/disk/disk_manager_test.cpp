@@ -1,4 +1,11 @@
+#include <cstdlib>
+#include <future>
 #include <iostream>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include "slice/slice.hpp"
 #include "disk/disk_manager.hpp"
 #include "gtest/gtest.h"
@@ -53,4 +60,372 @@ TEST(DiskManagerTest, ReadWriteTest) {
     remove("test.db");
 }
 
-} // dsbus
\ No newline at end of file
+TEST(DiskManagerTest, AsyncReadWriteTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 64;
+    std::vector<char> out(page_size * page_num);
+    std::vector<char> in(page_size * page_num, 0);
+    for (size_t i = 0; i < out.size(); ++i) out[i] = 'a' + i % 23;
+    // writes without checksums clear the checksum field
+    for (int i = 0; i < page_num; ++i) memset(&out[i * page_size + disk::OFFSET_PAGE_CHECKSUM], 0, sizeof(uint32_t));
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        std::vector<std::future<void>> futures;
+        for (int i = 0; i < page_num; ++i) futures.push_back(disk_manager.WritePageAsync(i, &out[i * page_size]));
+        for (auto &future : futures) future.wait();
+        EXPECT_EQ(disk_manager.GetPageNum(), page_num);
+        disk_manager.ShutDown();
+    }
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        EXPECT_EQ(disk_manager.GetPageNum(), page_num);
+        std::atomic<int> read{0};
+        for (int i = 0; i < page_num; ++i) {
+            disk_manager.ReadPageAsync(i, &in[i * page_size], [&read]() { ++read; });
+        }
+        // a page past the end is left unread
+        char past_end[page_size];
+        memset(past_end, 'z', page_size);
+        disk_manager.ReadPageAsync(page_num, past_end, [&read]() { ++read; });
+        // ShutDown waits for requests in flight
+        disk_manager.ShutDown();
+        EXPECT_EQ(read.load(), page_num + 1);
+        EXPECT_EQ(memcmp(in.data(), out.data(), out.size()), 0);
+        EXPECT_EQ(past_end[0], 'z');
+    }
+    remove("test.db");
+}
+
+TEST(DiskManagerTest, ConcurrentReadWriteTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int thread_num = 8;
+    const int page_per_thread = 64;
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_num; ++t) {
+            threads.emplace_back([&disk_manager, t]() {
+                char data[page_size];
+                char t_data[page_size];
+                // pages of the threads interleave, each thread owns every thread_num-th page
+                for (int round = 0; round < 4; ++round) {
+                    for (int i = 0; i < page_per_thread; ++i) {
+                        page_id_t page_id = i * thread_num + t;
+                        memset(data, 'a' + (page_id + round) % 26, page_size);
+                        memset(data + disk::OFFSET_PAGE_CHECKSUM, 0, sizeof(uint32_t));
+                        disk_manager.WritePage(page_id, data);
+                        disk_manager.ReadPage(page_id, t_data);
+                        EXPECT_EQ(memcmp(data, t_data, page_size), 0);
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads) thread.join();
+        EXPECT_EQ(disk_manager.GetPageNum(), thread_num * page_per_thread);
+        disk_manager.ShutDown();
+    }
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        EXPECT_EQ(disk_manager.GetPageNum(), thread_num * page_per_thread);
+        char t_data[page_size];
+        for (int i = 0; i < thread_num * page_per_thread; ++i) {
+            disk_manager.ReadPage(i, t_data);
+            EXPECT_EQ(t_data[0], 'a' + (i + 3) % 26);
+        }
+        disk_manager.ShutDown();
+    }
+    remove("test.db");
+}
+
+TEST(DiskManagerTest, BatchReadWriteTest) {
+    remove("test.db");
+    const size_t page_size = 4096;
+    const int page_num = 2000;
+    // unsorted, with gaps, and a run longer than IOV_MAX
+    std::vector<page_id_t> page_ids;
+    for (int i = page_num - 1; i >= 0; --i) {
+        if (i % 700 != 3) page_ids.push_back(i);
+    }
+    auto check = [&](DiskManager &disk_manager) {
+        std::vector<char> data(page_ids.size() * page_size);
+        std::vector<std::pair<page_id_t, char *>> pages;
+        for (size_t i = 0; i < page_ids.size(); ++i) pages.emplace_back(page_ids[i], &data[i * page_size]);
+        disk_manager.ReadPages(pages);
+        for (size_t i = 0; i < page_ids.size(); ++i) {
+            EXPECT_EQ(data[i * page_size], (char)page_ids[i]);
+            EXPECT_EQ(data[(i + 1) * page_size - 1], (char)page_ids[i]);
+        }
+    };
+    for (bool direct_io : {false, true}) {
+        {
+            DiskManager disk_manager(Slice("test.db"), page_size, DiskManagerOptions{direct_io});
+            // page buffers are one byte off, copied through aligned ones in direct I/O mode
+            std::vector<char> data(page_ids.size() * page_size + 1);
+            std::vector<std::pair<page_id_t, const char *>> pages;
+            for (size_t i = 0; i < page_ids.size(); ++i) {
+                memset(&data[i * page_size + 1], page_ids[i], page_size);
+                pages.emplace_back(page_ids[i], &data[i * page_size + 1]);
+            }
+            disk_manager.WritePages(pages);
+            EXPECT_EQ(disk_manager.GetPageNum(), page_num);
+            check(disk_manager);
+            disk_manager.ShutDown();
+        }
+        {
+            DiskManager disk_manager(Slice("test.db"), page_size);
+            EXPECT_EQ(disk_manager.GetPageNum(), page_num);
+            check(disk_manager);
+            disk_manager.ShutDown();
+        }
+        remove("test.db");
+    }
+}
+
+TEST(DiskManagerTest, DirectIOTest) {
+    remove("test.db");
+    const size_t page_size = 4096;
+    {
+        // pages not aligned for O_DIRECT stay in buffered mode
+        DiskManager disk_manager(Slice("test.db"), 128, DiskManagerOptions{true});
+        EXPECT_EQ(disk_manager.IsDirectIO(), false);
+    }
+    remove("test.db");
+
+    auto aligned = (char *)aligned_alloc(DIRECT_IO_ALIGNMENT, page_size);
+    // one byte off, copied through an aligned buffer
+    std::vector<char> unaligned_buf(page_size + 1);
+    char *unaligned = unaligned_buf.data() + ((uintptr_t)unaligned_buf.data() % 2 == 0 ? 1 : 0);
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size, DiskManagerOptions{true});
+        if (!disk_manager.IsDirectIO()) {
+            free(aligned);
+            GTEST_SKIP() << "O_DIRECT is not supported here";
+        }
+        memset(aligned, 'a', page_size);
+        disk_manager.WritePage(0, aligned);
+        memset(unaligned, 'b', page_size);
+        disk_manager.WritePage(1, unaligned);
+        disk_manager.WritePageAsync(2, unaligned).wait();
+        disk_manager.WritePageAsync(3, aligned).wait();
+
+        disk_manager.ReadPage(1, aligned);
+        EXPECT_EQ(aligned[0], 'b');
+        EXPECT_EQ(aligned[page_size - 1], 'b');
+        disk_manager.ReadPage(0, unaligned);
+        EXPECT_EQ(unaligned[page_size - 1], 'a');
+        disk_manager.ReadPageAsync(2, aligned).wait();
+        EXPECT_EQ(aligned[page_size - 1], 'b');
+        disk_manager.ReadPageAsync(3, unaligned).wait();
+        EXPECT_EQ(unaligned[page_size - 1], 'a');
+        disk_manager.ShutDown();
+    }
+    {
+        // the file is the same in buffered mode
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        EXPECT_EQ(disk_manager.GetPageNum(), 4);
+        disk_manager.ReadPage(1, unaligned);
+        EXPECT_EQ(unaligned[0], 'b');
+        disk_manager.ShutDown();
+    }
+    free(aligned);
+    remove("test.db");
+}
+
+TEST(DiskManagerTest, AllocatePageTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    char data[page_size];
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        for (int i = 0; i < 10; ++i) {
+            EXPECT_EQ(disk_manager.AllocatePage(), i);
+            memset(data, 'a' + i, page_size);
+            disk_manager.WritePage(i, data);
+        }
+        disk_manager.DeallocatePage(6);
+        disk_manager.DeallocatePage(2);
+        EXPECT_TRUE(disk_manager.IsFreePage(2));
+        EXPECT_EQ(disk_manager.GetFreePageNum(), 2);
+        // the lowest free page comes back first
+        EXPECT_EQ(disk_manager.AllocatePage(), 2);
+        disk_manager.WritePage(2, data);
+        // free pages ending the file are cut off it
+        disk_manager.DeallocatePage(8);
+        disk_manager.DeallocatePage(9);
+        EXPECT_EQ(disk_manager.GetPageNum(), 8);
+        EXPECT_EQ(disk_manager.GetFreePageNum(), 1);
+        disk_manager.DeallocatePage(7);
+        EXPECT_EQ(disk_manager.GetPageNum(), 6);
+        EXPECT_EQ(disk_manager.GetFreePageNum(), 0);
+        for (int i = 0; i < 4; ++i) disk_manager.DeallocatePage(i);
+        disk_manager.ShutDown();
+    }
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        EXPECT_EQ(disk_manager.GetPageNum(), 6);
+        EXPECT_EQ(disk_manager.GetFreePageNum(), 4);
+        for (int i = 0; i < 4; ++i) EXPECT_EQ(disk_manager.AllocatePage(), i);
+        EXPECT_EQ(disk_manager.AllocatePage(), 6);
+        disk_manager.ReadPage(5, data);
+        EXPECT_EQ(data[page_size - 1], 'a' + 5);
+        disk_manager.ShutDown();
+    }
+    {
+        // the free pages were handed out and not stored again
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        EXPECT_EQ(disk_manager.GetFreePageNum(), 0);
+        disk_manager.ShutDown();
+    }
+    remove("test.db");
+}
+
+TEST(DiskManagerTest, TrimCrashTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    char data[page_size];
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        for (int i = 0; i < 10; ++i) {
+            memset(data, 'a' + i, page_size);
+            disk_manager.WritePage(i, data);
+        }
+        disk_manager.ShutDown();
+    }
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        // the child trims the last page and dies without shutting down
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        disk_manager.DeallocatePage(9);
+        _exit(disk_manager.GetPageNum() == 9 ? 0 : 1);
+    }
+    int status;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        EXPECT_EQ(disk_manager.GetPageNum(), 9);
+        disk_manager.ReadPage(8, data);
+        EXPECT_EQ(data[0], 'a' + 8);
+        EXPECT_EQ(disk_manager.AllocatePage(), 9);
+        disk_manager.ShutDown();
+    }
+    remove("test.db");
+}
+
+TEST(DiskManagerTest, ChecksumTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    char data[page_size];
+    char t_data[page_size];
+    for (int i = 0; i < (int)page_size; ++i) data[i] = (char)i;
+    {
+        // no checksum, pages are read as they are
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        EXPECT_FALSE(disk_manager.HasChecksums());
+        memset(data + disk::OFFSET_PAGE_CHECKSUM, 0, sizeof(uint32_t));
+        disk_manager.WritePage(0, data);
+        disk_manager.ShutDown();
+    }
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size, DiskManagerOptions{false, true});
+        EXPECT_TRUE(disk_manager.HasChecksums());
+        disk_manager.WritePage(1, data);
+        disk_manager.WritePageAsync(2, data).wait();
+        std::vector<std::pair<page_id_t, const char *>> pages = {{3, data}, {4, data}};
+        disk_manager.WritePages(pages);
+        // written before checksums were on
+        disk_manager.ReadPage(0, t_data);
+        for (page_id_t page_id = 1; page_id < 5; ++page_id) {
+            disk_manager.ReadPage(page_id, t_data);
+            // the caller's page is left as it is
+            EXPECT_EQ(memcmp(t_data + disk::PAGE_HEADER_SIZE, data + disk::PAGE_HEADER_SIZE,
+                             page_size - disk::PAGE_HEADER_SIZE), 0);
+            EXPECT_TRUE(disk::VerifyPageChecksum(t_data, page_size));
+        }
+        EXPECT_EQ(disk_manager.GetChecksumFailureNum(), 0);
+        disk_manager.ShutDown();
+    }
+    {
+        // tear pages 2 and 4
+        int fd = open("test.db", O_RDWR);
+        char byte = 'x';
+        EXPECT_EQ(pwrite(fd, &byte, 1, disk::DISK_HEADER_PAGE_SIZE + 2 * page_size + 100), 1);
+        EXPECT_EQ(pwrite(fd, &byte, 1, disk::DISK_HEADER_PAGE_SIZE + 4 * page_size + 1), 1);
+        close(fd);
+    }
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size, DiskManagerOptions{false, true});
+        disk_manager.ReadPage(1, t_data);
+        EXPECT_EQ(disk_manager.GetChecksumFailureNum(), 0);
+        disk_manager.ReadPageAsync(2, t_data).wait();
+        EXPECT_EQ(disk_manager.GetChecksumFailureNum(), 1);
+        // the torn page is returned anyway
+        EXPECT_EQ(t_data[100], 'x');
+        std::vector<char> batch(3 * page_size);
+        std::vector<std::pair<page_id_t, char *>> pages;
+        for (int i = 0; i < 3; ++i) pages.emplace_back(i + 2, &batch[i * page_size]);
+        disk_manager.ReadPages(pages);
+        EXPECT_EQ(disk_manager.GetChecksumFailureNum(), 3);
+        disk_manager.ShutDown();
+    }
+    remove("test.db");
+}
+
+TEST(DiskManagerTest, ChecksumOnOffTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    char data[page_size];
+    char t_data[page_size];
+    memset(data, 0, page_size);
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size, DiskManagerOptions{false, true});
+        for (page_id_t page_id = 0; page_id < 4; ++page_id) disk_manager.WritePage(page_id, data);
+        disk_manager.ShutDown();
+    }
+    {
+        // pages read with their checksum are changed and written back without checksums,
+        // through each write path
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        std::vector<char> pages_data(4 * page_size);
+        for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+            char *page = &pages_data[page_id * page_size];
+            disk_manager.ReadPage(page_id, page);
+            EXPECT_NE(*(uint32_t *)(page + disk::OFFSET_PAGE_CHECKSUM), 0);
+            page[100] = 'x';
+        }
+        disk_manager.WritePage(0, &pages_data[0]);
+        disk_manager.WritePageAsync(1, &pages_data[page_size]).wait();
+        std::vector<std::pair<page_id_t, const char *>> pages = {{2, &pages_data[2 * page_size]},
+                                                                 {3, &pages_data[3 * page_size]}};
+        disk_manager.WritePages(pages);
+        // the caller's page keeps its checksum field
+        EXPECT_NE(*(uint32_t *)(&pages_data[0] + disk::OFFSET_PAGE_CHECKSUM), 0);
+        disk_manager.ShutDown();
+    }
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size, DiskManagerOptions{false, true});
+        for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+            disk_manager.ReadPage(page_id, t_data);
+            EXPECT_EQ(t_data[100], 'x');
+        }
+        EXPECT_EQ(disk_manager.GetChecksumFailureNum(), 0);
+        disk_manager.DeallocatePage(0);
+        disk_manager.DeallocatePage(1);
+        disk_manager.ShutDown();
+    }
+    {
+        // free page trunks are checksummed pages too
+        DiskManager disk_manager(Slice("test.db"), page_size, DiskManagerOptions{false, true});
+        EXPECT_EQ(disk_manager.GetFreePageNum(), 2);
+        EXPECT_EQ(disk_manager.GetChecksumFailureNum(), 0);
+        EXPECT_EQ(disk_manager.AllocatePage(), 0);
+        EXPECT_EQ(disk_manager.AllocatePage(), 1);
+        disk_manager.ShutDown();
+    }
+    remove("test.db");
+}
+
+} // dsbus
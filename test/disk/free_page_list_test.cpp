@@ -0,0 +1,67 @@
+#include <map>
+#include <vector>
+#include "disk/free_page_list.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(FreePageListTest, AllocateTest) {
+    FreePageList free_pages;
+    EXPECT_TRUE(free_pages.Empty());
+    free_pages.Insert(5);
+    free_pages.Insert(2);
+    free_pages.Insert(7);
+    free_pages.Insert(2);
+    EXPECT_EQ(free_pages.Size(), 3);
+    EXPECT_TRUE(free_pages.Contains(5));
+    EXPECT_FALSE(free_pages.Contains(3));
+    // lowest first
+    EXPECT_EQ(free_pages.Allocate(), 2);
+    EXPECT_EQ(free_pages.Allocate(), 5);
+    EXPECT_EQ(free_pages.Allocate(), 7);
+    EXPECT_TRUE(free_pages.Empty());
+}
+
+TEST(FreePageListTest, TrimTest) {
+    FreePageList free_pages;
+    for (page_id_t page_id : {1, 3, 7, 8, 9}) free_pages.Insert(page_id);
+    // page 10 is in use, nothing to cut
+    EXPECT_EQ(free_pages.Trim(11), 11);
+    EXPECT_EQ(free_pages.Size(), 5);
+    EXPECT_EQ(free_pages.Trim(10), 7);
+    EXPECT_EQ(free_pages.Size(), 2);
+    free_pages.Insert(0);
+    free_pages.Insert(2);
+    EXPECT_EQ(free_pages.Trim(4), 0);
+    EXPECT_TRUE(free_pages.Empty());
+}
+
+TEST(FreePageListTest, StoreLoadTest) {
+    for (size_t page_size : {32, 128, 4096}) {
+        std::map<page_id_t, std::vector<char>> file;
+        auto write_page = [&file, page_size](page_id_t page_id, const char *data) {
+            file[page_id].assign(data, data + page_size);
+        };
+        auto read_page = [&file](page_id_t page_id, char *data) {
+            ASSERT_TRUE(file.count(page_id));
+            memcpy(data, file[page_id].data(), file[page_id].size());
+        };
+        FreePageList free_pages;
+        EXPECT_EQ(free_pages.Store(page_size, write_page), INVALID_PAGE_ID);
+        for (page_id_t page_id = 0; page_id < 3000; page_id += 3) free_pages.Insert(page_id);
+        auto head = free_pages.Store(page_size, write_page);
+        EXPECT_NE(head, INVALID_PAGE_ID);
+        EXPECT_EQ(free_pages.Size(), 1000);
+        // trunks are free pages
+        for (auto &page : file) EXPECT_TRUE(free_pages.Contains(page.first));
+
+        FreePageList loaded;
+        loaded.Load(head, free_pages.Size(), page_size, read_page);
+        EXPECT_EQ(loaded.Size(), 1000);
+        for (page_id_t page_id = 0; page_id < 3000; ++page_id) {
+            EXPECT_EQ(loaded.Contains(page_id), page_id % 3 == 0);
+        }
+    }
+}
+
+} // dsbus
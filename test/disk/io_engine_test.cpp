@@ -0,0 +1,167 @@
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "disk/io_engine.hpp"
+#include "disk/io_uring_engine.hpp"
+#include "disk/thread_pool_io_engine.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+/**
+ *  Write block_num blocks concurrently, read them back concurrently and check them.
+ */
+static void EngineWorkload(IOEngine *engine) {
+    remove("test.io");
+    const size_t block_size = 512;
+    const int block_num = 256;
+    int fd = open("test.io", O_RDWR | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+
+    std::vector<char> out(block_size * block_num);
+    for (int i = 0; i < block_num; ++i) memset(&out[i * block_size], 'a' + i % 26, block_size);
+    std::atomic<int> written{0};
+    for (int i = 0; i < block_num; ++i) {
+        engine->SubmitWrite(fd, &out[i * block_size], block_size, i * block_size, [&written](ssize_t result) {
+            EXPECT_EQ(result, (ssize_t)block_size);
+            ++written;
+        });
+    }
+    engine->Drain();
+    EXPECT_EQ(written.load(), block_num);
+
+    std::vector<char> in(block_size * block_num, 0);
+    std::atomic<int> read{0};
+    for (int i = block_num - 1; i >= 0; --i) {
+        engine->SubmitRead(fd, &in[i * block_size], block_size, i * block_size, [&read](ssize_t result) {
+            EXPECT_EQ(result, (ssize_t)block_size);
+            ++read;
+        });
+    }
+    engine->Drain();
+    EXPECT_EQ(read.load(), block_num);
+    EXPECT_EQ(memcmp(in.data(), out.data(), out.size()), 0);
+
+    // a read past the end of the file is short, errors are reported as -errno
+    ssize_t eof_result = 1;
+    engine->SubmitRead(fd, in.data(), block_size, block_size * block_num - 100,
+                       [&eof_result](ssize_t result) { eof_result = result; });
+    engine->Drain();
+    EXPECT_EQ(eof_result, 100);
+    ssize_t error_result = 0;
+    engine->SubmitRead(-1, in.data(), block_size, 0, [&error_result](ssize_t result) { error_result = result; });
+    engine->Drain();
+    EXPECT_EQ(error_result, -EBADF);
+
+    close(fd);
+    remove("test.io");
+}
+
+/**
+ *  Write blocks from several threads at once and read them back.
+ */
+static void ConcurrentWorkload(IOEngine *engine) {
+    remove("test.io");
+    const size_t block_size = 512;
+    const int thread_num = 8;
+    const int block_num = 64;
+    int fd = open("test.io", O_RDWR | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+
+    std::vector<char> out(block_size * block_num * thread_num);
+    for (size_t i = 0; i < out.size() / block_size; ++i) memset(&out[i * block_size], 'a' + i % 26, block_size);
+    std::atomic<int> written{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < thread_num; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = t * block_num; i < (t + 1) * block_num; ++i) {
+                engine->SubmitWrite(fd, &out[i * block_size], block_size, i * block_size, [&](ssize_t result) {
+                    EXPECT_EQ(result, (ssize_t)block_size);
+                    ++written;
+                });
+            }
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    engine->Drain();
+    EXPECT_EQ(written.load(), block_num * thread_num);
+
+    std::vector<char> in(out.size(), 0);
+    EXPECT_EQ(PReadFull(fd, in.data(), in.size(), 0), (ssize_t)in.size());
+    EXPECT_EQ(memcmp(in.data(), out.data(), out.size()), 0);
+
+    close(fd);
+    remove("test.io");
+}
+
+TEST(IOEngineTest, ThreadPoolTest) {
+    ThreadPoolIOEngine engine(4);
+    EngineWorkload(&engine);
+}
+
+TEST(IOEngineTest, IOUringTest) {
+    auto engine = IOUringEngine::Create(8);
+    if (engine == nullptr) GTEST_SKIP() << "io_uring is not available";
+    // a queue shallower than the workload makes submitters wait for completions
+    EngineWorkload(engine.get());
+}
+
+TEST(IOEngineTest, ConcurrentSubmitTest) {
+    ThreadPoolIOEngine thread_pool(4);
+    ConcurrentWorkload(&thread_pool);
+    auto engine = IOUringEngine::Create(8);
+    if (engine == nullptr) GTEST_SKIP() << "io_uring is not available";
+    ConcurrentWorkload(engine.get());
+}
+
+TEST(IOEngineTest, IOUringQueueTest) {
+    auto engine = IOUringEngine::Create(8);
+    if (engine == nullptr) GTEST_SKIP() << "io_uring is not available";
+    remove("test.io");
+    const size_t block_size = 512;
+    const int block_num = 64;
+    int fd = open("test.io", O_RDWR | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+    std::vector<char> out(block_size * block_num);
+    for (int i = 0; i < block_num; ++i) memset(&out[i * block_size], 'a' + i % 26, block_size);
+
+    // queued requests wait for Flush
+    std::atomic<int> written{0};
+    auto on_write = [&written](ssize_t result) {
+        EXPECT_EQ(result, (ssize_t)block_size);
+        ++written;
+    };
+    for (int i = 0; i < 4; ++i) engine->QueueWrite(fd, &out[i * block_size], block_size, i * block_size, on_write);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(written.load(), 0);
+    engine->Flush();
+    for (int i = 0; i < 1000 && written.load() < 4; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    EXPECT_EQ(written.load(), 4);
+
+    // more than the ring holds, a full ring is entered without Flush
+    for (int i = 4; i < block_num; ++i) engine->QueueWrite(fd, &out[i * block_size], block_size, i * block_size, on_write);
+    engine->Drain();
+    EXPECT_EQ(written.load(), block_num);
+
+    std::vector<char> in(out.size(), 0);
+    std::atomic<int> read{0};
+    for (int i = 0; i < block_num; ++i) {
+        engine->QueueRead(fd, &in[i * block_size], block_size, i * block_size, [&read](ssize_t result) {
+            EXPECT_EQ(result, (ssize_t)block_size);
+            ++read;
+        });
+    }
+    engine->Flush();
+    engine->Drain();
+    EXPECT_EQ(read.load(), block_num);
+    EXPECT_EQ(memcmp(in.data(), out.data(), out.size()), 0);
+
+    close(fd);
+    remove("test.io");
+}
+
+} // dsbus
@@ -0,0 +1,158 @@
+#include <thread>
+#include <vector>
+#include "slice/slice.hpp"
+#include "disk/disk_manager.hpp"
+#include "disk/mmap_disk_manager.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(MMapDiskManagerTest, ConstructorTest) {
+    remove("test.db");
+    MMapDiskManager disk_manager(Slice("test.db"), 128);
+    EXPECT_EQ(disk_manager.GetPageNum(), 0);
+    EXPECT_EQ(disk_manager.GetPageSize(), 128);
+    disk_manager.ShutDown();
+    remove("test.db");
+}
+
+TEST(MMapDiskManagerTest, ReadWriteTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 100;
+    char data[page_size];
+    char t_data[page_size];
+    {
+        MMapDiskManager disk_manager(Slice("test.db"), page_size);
+        disk_manager.Advise(MMapAdvice::RANDOM);
+        // grows the mapping several times
+        for (int i = 0; i < page_num; ++i) {
+            memset(data, 'a' + i % 26, page_size);
+            disk_manager.WritePage(i, data);
+        }
+        EXPECT_EQ(disk_manager.GetPageNum(), page_num);
+        for (int i = 0; i < page_num; ++i) {
+            disk_manager.ReadPage(i, t_data);
+            EXPECT_EQ(t_data[page_size - 1], 'a' + i % 26);
+            EXPECT_EQ(disk_manager.GetPageData(i)[0], 'a' + i % 26);
+        }
+        disk_manager.ShutDown();
+    }
+    {
+        // same layout as DiskManager, the unused capacity is cut off
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        EXPECT_EQ(disk_manager.GetPageNum(), page_num);
+        disk_manager.ReadPage(page_num - 1, t_data);
+        EXPECT_EQ(t_data[0], 'a' + (page_num - 1) % 26);
+        memset(data, 'z', page_size);
+        disk_manager.WritePage(page_num, data);
+        disk_manager.ShutDown();
+    }
+    {
+        MMapDiskManager disk_manager(Slice("test.db"), page_size);
+        disk_manager.Advise(MMapAdvice::SEQUENTIAL);
+        EXPECT_EQ(disk_manager.GetPageNum(), page_num + 1);
+        disk_manager.ReadPage(page_num, t_data);
+        EXPECT_EQ(t_data[0], 'z');
+        disk_manager.ShutDown();
+    }
+    remove("test.db");
+}
+
+TEST(MMapDiskManagerTest, BatchReadWriteTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int page_num = 100;
+    std::vector<char> data(page_num * page_size);
+    {
+        MMapDiskManager disk_manager(Slice("test.db"), page_size);
+        std::vector<std::pair<page_id_t, const char *>> pages;
+        for (int i = page_num - 1; i >= 0; --i) {
+            memset(&data[i * page_size], 'a' + i % 26, page_size);
+            pages.emplace_back(i, &data[i * page_size]);
+        }
+        disk_manager.WritePages(pages);
+        EXPECT_EQ(disk_manager.GetPageNum(), page_num);
+        disk_manager.ShutDown();
+    }
+    {
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        std::vector<std::pair<page_id_t, char *>> pages;
+        for (int i = 0; i < page_num; ++i) pages.emplace_back(i, &data[i * page_size]);
+        memset(data.data(), 0, data.size());
+        disk_manager.ReadPages(pages);
+        for (int i = 0; i < page_num; ++i) EXPECT_EQ(data[(i + 1) * page_size - 1], 'a' + i % 26);
+        disk_manager.ShutDown();
+    }
+    remove("test.db");
+}
+
+TEST(MMapDiskManagerTest, ConcurrentGrowTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    const int thread_num = 8;
+    const int page_per_thread = 200;
+    {
+        MMapDiskManager disk_manager(Slice("test.db"), page_size);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_num; ++t) {
+            threads.emplace_back([&disk_manager, t]() {
+                char data[page_size];
+                char t_data[page_size];
+                for (int i = 0; i < page_per_thread; ++i) {
+                    page_id_t page_id = i * thread_num + t;
+                    memset(data, 'a' + page_id % 26, page_size);
+                    disk_manager.WritePage(page_id, data);
+                    disk_manager.ReadPage(page_id, t_data);
+                    EXPECT_EQ(memcmp(data, t_data, page_size), 0);
+                }
+            });
+        }
+        for (auto &thread : threads) thread.join();
+        EXPECT_EQ(disk_manager.GetPageNum(), thread_num * page_per_thread);
+    }
+    remove("test.db");
+}
+
+TEST(MMapDiskManagerTest, AllocatePageTest) {
+    remove("test.db");
+    const size_t page_size = 128;
+    char data[page_size];
+    {
+        MMapDiskManager disk_manager(Slice("test.db"), page_size);
+        for (int i = 0; i < 10; ++i) {
+            EXPECT_EQ(disk_manager.AllocatePage(), i);
+            memset(data, 'a' + i, page_size);
+            disk_manager.WritePage(i, data);
+        }
+        disk_manager.DeallocatePage(1);
+        disk_manager.DeallocatePage(4);
+        disk_manager.DeallocatePage(9);
+        EXPECT_EQ(disk_manager.GetPageNum(), 9);
+        EXPECT_EQ(disk_manager.AllocatePage(), 1);
+        disk_manager.WritePage(1, data);
+        disk_manager.ShutDown();
+    }
+    {
+        // the file has the DiskManager layout, free pages included
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        EXPECT_EQ(disk_manager.GetPageNum(), 9);
+        EXPECT_TRUE(disk_manager.IsFreePage(4));
+        EXPECT_EQ(disk_manager.GetFreePageNum(), 1);
+        disk_manager.ReadPage(8, data);
+        EXPECT_EQ(data[0], 'a' + 8);
+        disk_manager.DeallocatePage(2);
+        disk_manager.ShutDown();
+    }
+    {
+        MMapDiskManager disk_manager(Slice("test.db"), page_size);
+        EXPECT_EQ(disk_manager.GetFreePageNum(), 2);
+        EXPECT_EQ(disk_manager.AllocatePage(), 2);
+        EXPECT_EQ(disk_manager.AllocatePage(), 4);
+        EXPECT_EQ(disk_manager.AllocatePage(), 9);
+        disk_manager.ShutDown();
+    }
+    remove("test.db");
+}
+
+} // dsbus
@@ -0,0 +1,165 @@
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "disk/disk_manager.hpp"
+#include "disk/tablespace_manager.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+static const std::vector<std::string> segment_file_names = {"test.db.0", "test.db.1", "test.db.2"};
+
+static void RemoveSegments() {
+    for (auto &file_name : segment_file_names) remove(file_name.c_str());
+}
+
+TEST(TablespaceManagerTest, ConstructorTest) {
+    RemoveSegments();
+    {
+        TablespaceManager tablespace(segment_file_names, 128, 4);
+        EXPECT_EQ(tablespace.GetPageNum(), 0);
+        EXPECT_EQ(tablespace.GetPageSize(), 128);
+        EXPECT_EQ(tablespace.GetSegmentNum(), 3);
+        EXPECT_EQ(tablespace.GetExtentPageNum(), 4);
+        EXPECT_EQ(tablespace.GetSegmentIndex(3), 0);
+        EXPECT_EQ(tablespace.GetSegmentIndex(4), 1);
+        EXPECT_EQ(tablespace.GetSegmentIndex(11), 2);
+        EXPECT_EQ(tablespace.GetSegmentIndex(12), 0);
+        tablespace.ShutDown();
+    }
+    RemoveSegments();
+}
+
+TEST(TablespaceManagerTest, ReadWriteTest) {
+    RemoveSegments();
+    const size_t page_size = 128;
+    const int page_num = 30;
+    char data[page_size];
+    {
+        TablespaceManager tablespace(segment_file_names, page_size, 4);
+        for (int i = 0; i < page_num; ++i) {
+            memset(data, 'a' + i % 26, page_size);
+            tablespace.WritePage(i, data);
+        }
+        EXPECT_EQ(tablespace.GetPageNum(), page_num);
+        tablespace.ShutDown();
+    }
+    {
+        // extents of 4 pages go round the segments: 0-3, 12-15, 24-27 in the first one
+        DiskManager segment(Slice(segment_file_names[0]), page_size);
+        EXPECT_EQ(segment.GetPageNum(), 12);
+        segment.ReadPage(9, data);
+        EXPECT_EQ(data[0], 'a' + 25);
+        segment.ShutDown();
+    }
+    {
+        TablespaceManager tablespace(segment_file_names, page_size, 4);
+        EXPECT_EQ(tablespace.GetPageNum(), page_num);
+        EXPECT_EQ(tablespace.GetFreePageNum(), 0);
+        for (int i = 0; i < page_num; ++i) {
+            tablespace.ReadPageAsync(i, data).wait();
+            EXPECT_EQ(data[page_size - 1], 'a' + i % 26);
+        }
+        tablespace.ShutDown();
+    }
+    RemoveSegments();
+}
+
+TEST(TablespaceManagerTest, BatchReadWriteTest) {
+    RemoveSegments();
+    const size_t page_size = 128;
+    const int page_num = 1000;
+    std::vector<char> data(page_num * page_size);
+    {
+        TablespaceManager tablespace(segment_file_names, page_size, 16);
+        std::vector<std::pair<page_id_t, const char *>> pages;
+        for (int i = page_num - 1; i >= 0; --i) {
+            memset(&data[i * page_size], 'a' + i % 26, page_size);
+            pages.emplace_back(i, &data[i * page_size]);
+        }
+        tablespace.WritePages(pages);
+        EXPECT_EQ(tablespace.GetPageNum(), page_num);
+
+        std::vector<std::pair<page_id_t, char *>> read_pages;
+        for (int i = 0; i < page_num; ++i) read_pages.emplace_back(i, &data[i * page_size]);
+        memset(data.data(), 0, data.size());
+        tablespace.ReadPages(read_pages);
+        for (int i = 0; i < page_num; ++i) EXPECT_EQ(data[(i + 1) * page_size - 1], 'a' + i % 26);
+        tablespace.ShutDown();
+    }
+    RemoveSegments();
+}
+
+TEST(TablespaceManagerTest, AllocatePageTest) {
+    RemoveSegments();
+    const size_t page_size = 128;
+    char data[page_size];
+    {
+        TablespaceManager tablespace(segment_file_names, page_size, 2);
+        for (int i = 0; i < 12; ++i) {
+            EXPECT_EQ(tablespace.AllocatePage(), i);
+            memset(data, 'a' + i, page_size);
+            tablespace.WritePage(i, data);
+        }
+        tablespace.DeallocatePage(7);
+        tablespace.DeallocatePage(4);
+        EXPECT_EQ(tablespace.AllocatePage(), 4);
+        tablespace.WritePage(4, data);
+        // pages 10 and 11 end the last segment, 9 ends the second one
+        tablespace.DeallocatePage(11);
+        tablespace.DeallocatePage(10);
+        tablespace.DeallocatePage(9);
+        EXPECT_EQ(tablespace.GetPageNum(), 9);
+        tablespace.DeallocatePage(1);
+        tablespace.ShutDown();
+    }
+    {
+        DiskManager segment(Slice(segment_file_names[2]), page_size);
+        EXPECT_EQ(segment.GetPageNum(), 2);
+        segment.ShutDown();
+    }
+    {
+        TablespaceManager tablespace(segment_file_names, page_size, 2);
+        EXPECT_EQ(tablespace.GetPageNum(), 9);
+        EXPECT_EQ(tablespace.GetFreePageNum(), 2);
+        EXPECT_TRUE(tablespace.IsFreePage(7));
+        EXPECT_EQ(tablespace.AllocatePage(), 1);
+        EXPECT_EQ(tablespace.AllocatePage(), 7);
+        EXPECT_EQ(tablespace.AllocatePage(), 9);
+        tablespace.ReadPage(8, data);
+        EXPECT_EQ(data[0], 'a' + 8);
+        // page 7 ends the second segment, it is cut off when handed back
+        tablespace.DeallocatePage(7);
+        tablespace.ShutDown();
+    }
+    {
+        TablespaceManager tablespace(segment_file_names, page_size, 2);
+        EXPECT_EQ(tablespace.GetPageNum(), 9);
+        EXPECT_TRUE(tablespace.IsFreePage(7));
+        EXPECT_EQ(tablespace.GetFreePageNum(), 1);
+        tablespace.ShutDown();
+    }
+    RemoveSegments();
+}
+
+TEST(TablespaceManagerTest, LargePageIdTest) {
+    RemoveSegments();
+    const size_t page_size = 128;
+    // past what 32 bit page ids address, the segment files are sparse
+    const page_id_t page_id = ((page_id_t)1 << 32) + 5;
+    char data[page_size];
+    {
+        TablespaceManager tablespace(segment_file_names, page_size, 1);
+        memset(data, 'x', page_size);
+        tablespace.WritePage(page_id, data);
+        EXPECT_EQ(tablespace.GetPageNum(), (size_t)page_id + 1);
+        memset(data, 0, page_size);
+        tablespace.ReadPage(page_id, data);
+        EXPECT_EQ(data[page_size - 1], 'x');
+        tablespace.ShutDown();
+    }
+    RemoveSegments();
+}
+
+} // dsbus
@@ -0,0 +1,236 @@
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "slice/slice.hpp"
+#include "disk/disk_manager.hpp"
+#include "buffer/buffer_pool_manager.hpp"
+#include "log/checkpoint_manager.hpp"
+#include "log/log_manager.hpp"
+#include "log/log_recovery.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+static const size_t page_size = 128;
+using TestBufferPool = BufferPoolManager<page_size>;
+
+// change the int at the start of a page, logged
+static lsn_t Update(TestBufferPool &bpm, LogManager &log_manager, txn_id_t txn_id, lsn_t prev_lsn,
+                    page_id_t page_id, int value) {
+    auto guard = bpm.FetchPageWrite(page_id);
+    LogRecord record(txn_id, prev_lsn, page_id, 0, guard.GetContent(), (const char *)&value, sizeof(value));
+    lsn_t lsn = log_manager.AppendLogRecord(&record);
+    memcpy(guard.GetContentMut(), &value, sizeof(value));
+    guard.SetLSN(lsn);
+    return lsn;
+}
+
+static lsn_t LogTxnRecord(LogManager &log_manager, LogRecordType type, txn_id_t txn_id, lsn_t prev_lsn) {
+    LogRecord record(type, txn_id, prev_lsn);
+    return log_manager.AppendLogRecord(&record);
+}
+
+static bool WaitForDrain(TestBufferPool &bpm) {
+    for (int i = 0; i < 1000; ++i) {
+        if (bpm.GetDrainPageNum() == 0 && bpm.GetDirtyPageTable().empty()) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    return false;
+}
+
+TEST(CheckpointManagerTest, CheckpointTest) {
+    remove("test.db");
+    remove("test.log");
+    const int page_num = 32;
+    {
+        LogManager log_manager(Slice("test.log"));
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolOptions options;
+        options.log_manager_ = &log_manager;
+        options.background_writer_ = true;
+        options.writer_interval_ms_ = 1;
+        options.writer_max_pages_ = 4;
+        // the writer only drains checkpoints
+        options.writer_low_watermark_ = 0;
+        TestBufferPool bpm(64, &disk_manager, options);
+        for (int i = 0; i < page_num; ++i) bpm.NewPageGuarded();
+        bpm.FlushAllData();
+        EXPECT_TRUE(bpm.GetDirtyPageTable().empty());
+
+        lsn_t lsn = LogTxnRecord(log_manager, LogRecordType::BEGIN, 1, INVALID_LSN);
+        lsn_t first_lsn = Update(bpm, log_manager, 1, lsn, 0, 1);
+        lsn = first_lsn;
+        for (int i = 1; i < page_num; ++i) lsn = Update(bpm, log_manager, 1, lsn, i, 1);
+        // a page changed twice keeps the LSN of its first change
+        lsn = Update(bpm, log_manager, 1, lsn, 0, 2);
+        auto dirty_pages = bpm.GetDirtyPageTable();
+        EXPECT_EQ(dirty_pages.size(), (size_t)page_num);
+        for (auto &page : dirty_pages) {
+            if (page.first == 0) {
+                EXPECT_EQ(page.second, first_lsn);
+            }
+        }
+
+        CheckpointManager<TestBufferPool> checkpoint_manager(&log_manager, &bpm);
+        lsn_t begin_lsn = checkpoint_manager.Checkpoint();
+        EXPECT_EQ(log_manager.GetCheckpointLSN(), begin_lsn);
+        EXPECT_EQ(checkpoint_manager.GetRedoLSN(), first_lsn);
+        EXPECT_EQ(checkpoint_manager.GetCheckpointNum(), 1u);
+        // the CHECKPOINT_END follows
+        std::vector<char> buf(log_manager.GetPersistentLSN() - begin_lsn);
+        EXPECT_EQ(log_manager.ReadLog(begin_lsn, buf.data(), buf.size()), buf.size());
+        LogRecord record;
+        EXPECT_TRUE(record.Deserialize(buf.data(), buf.size()));
+        EXPECT_EQ(record.GetType(), LogRecordType::CHECKPOINT_BEGIN);
+        EXPECT_TRUE(record.Deserialize(buf.data() + record.GetSize(), buf.size() - record.GetSize()));
+        EXPECT_EQ(record.GetType(), LogRecordType::CHECKPOINT_END);
+        EXPECT_EQ(record.GetRedoLSN(), first_lsn);
+        EXPECT_EQ(record.GetDirtyPages().size(), (size_t)page_num);
+        ASSERT_EQ(record.GetActiveTxns().size(), 1u);
+        EXPECT_EQ(record.GetActiveTxns()[0], std::make_pair((txn_id_t)1, lsn));
+
+        // the writer drains the pages of the checkpoint, so the next one starts redo later
+        EXPECT_TRUE(WaitForDrain(bpm));
+        LogTxnRecord(log_manager, LogRecordType::COMMIT, 1, lsn);
+        begin_lsn = checkpoint_manager.Checkpoint();
+        EXPECT_EQ(checkpoint_manager.GetRedoLSN(), begin_lsn);
+    }
+    {
+        LogManager log_manager(Slice("test.log"));
+        EXPECT_GT(log_manager.GetCheckpointLSN(), (lsn_t)LOG_FILE_HEADER_SIZE);
+        EXPECT_TRUE(log_manager.GetActiveTxnTable().empty());
+    }
+    remove("test.db");
+    remove("test.log");
+}
+
+// records where the log checkpoint stood at each sync
+class SyncRecordingDiskManager : public DiskManager {
+public:
+    SyncRecordingDiskManager(const Slice &db_file_name, LogManager *log_manager)
+                           : DiskManager(db_file_name, page_size), log_manager_(log_manager) {}
+
+    void Sync() {
+        sync_checkpoint_lsns_.push_back(log_manager_->GetCheckpointLSN());
+        DiskManager::Sync();
+    }
+
+    LogManager *log_manager_;
+    std::vector<lsn_t> sync_checkpoint_lsns_;
+};
+
+TEST(CheckpointManagerTest, SyncTest) {
+    remove("test.db");
+    remove("test.log");
+    {
+        using SyncBufferPool = BufferPoolManager<page_size, LRUReplacer, SyncRecordingDiskManager>;
+        LogManager log_manager(Slice("test.log"));
+        SyncRecordingDiskManager disk_manager(Slice("test.db"), &log_manager);
+        BufferPoolOptions options;
+        options.log_manager_ = &log_manager;
+        SyncBufferPool bpm(16, &disk_manager, options);
+        for (int i = 0; i < 4; ++i) bpm.NewPageGuarded();
+        lsn_t lsn = LogTxnRecord(log_manager, LogRecordType::BEGIN, 1, INVALID_LSN);
+        for (int i = 0; i < 4; ++i) {
+            auto guard = bpm.FetchPageWrite(i);
+            int value = 1;
+            LogRecord record(1, lsn, i, 0, guard.GetContent(), (const char *)&value, sizeof(value));
+            lsn = log_manager.AppendLogRecord(&record);
+            memcpy(guard.GetContentMut(), &value, sizeof(value));
+            guard.SetLSN(lsn);
+        }
+        // written, not synced: the pages leave the dirty page table
+        bpm.FlushAllData();
+        EXPECT_TRUE(bpm.GetDirtyPageTable().empty());
+        EXPECT_TRUE(disk_manager.sync_checkpoint_lsns_.empty());
+
+        lsn_t old_checkpoint_lsn = log_manager.GetCheckpointLSN();
+        CheckpointManager<SyncBufferPool> checkpoint_manager(&log_manager, &bpm);
+        lsn_t begin_lsn = checkpoint_manager.Checkpoint();
+        // redo starts past the changes, which were synced before the log named the checkpoint
+        EXPECT_EQ(checkpoint_manager.GetRedoLSN(), begin_lsn);
+        EXPECT_GT(begin_lsn, lsn);
+        ASSERT_EQ(disk_manager.sync_checkpoint_lsns_.size(), 1u);
+        EXPECT_EQ(disk_manager.sync_checkpoint_lsns_[0], old_checkpoint_lsn);
+        EXPECT_EQ(log_manager.GetCheckpointLSN(), begin_lsn);
+    }
+    remove("test.db");
+    remove("test.log");
+}
+
+TEST(CheckpointManagerTest, RecoveryTest) {
+    remove("test.db");
+    remove("test.log");
+    const int page_num = 16;
+    lsn_t checkpoint_lsn = INVALID_LSN;
+    int pipe_fds[2];
+    ASSERT_EQ(pipe(pipe_fds), 0);
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        // the child crashes once its last commit is durable
+        LogManager log_manager(Slice("test.log"));
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolOptions options;
+        options.log_manager_ = &log_manager;
+        options.background_writer_ = true;
+        options.writer_interval_ms_ = 1;
+        TestBufferPool bpm(64, &disk_manager, options);
+        for (int i = 0; i < page_num; ++i) bpm.NewPageGuarded();
+        bpm.FlushAllData();
+        // txn 1 commits before the checkpoint
+        lsn_t lsn = LogTxnRecord(log_manager, LogRecordType::BEGIN, 1, INVALID_LSN);
+        for (int i = 0; i < page_num; ++i) lsn = Update(bpm, log_manager, 1, lsn, i, 1);
+        LogTxnRecord(log_manager, LogRecordType::COMMIT, 1, lsn);
+        // txn 2 loses, with changes before and after the checkpoint
+        lsn_t lsn2 = LogTxnRecord(log_manager, LogRecordType::BEGIN, 2, INVALID_LSN);
+        lsn2 = Update(bpm, log_manager, 2, lsn2, 0, 2);
+        // txn 3 is active at the checkpoint, and commits after it
+        lsn_t lsn3 = LogTxnRecord(log_manager, LogRecordType::BEGIN, 3, INVALID_LSN);
+        lsn3 = Update(bpm, log_manager, 3, lsn3, 1, 3);
+        CheckpointManager<TestBufferPool> checkpoint_manager(&log_manager, &bpm);
+        checkpoint_lsn = checkpoint_manager.Checkpoint();
+        bool drained = WaitForDrain(bpm);
+        lsn2 = Update(bpm, log_manager, 2, lsn2, 2, 2);
+        lsn3 = Update(bpm, log_manager, 3, lsn3, 3, 3);
+        log_manager.Flush(LogTxnRecord(log_manager, LogRecordType::COMMIT, 3, lsn3));
+        bool ok = drained && write(pipe_fds[1], &checkpoint_lsn, sizeof(checkpoint_lsn)) == sizeof(checkpoint_lsn);
+        _exit(ok ? 0 : 1);
+    }
+    int status;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    ASSERT_EQ(read(pipe_fds[0], &checkpoint_lsn, sizeof(checkpoint_lsn)), (ssize_t)sizeof(checkpoint_lsn));
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    {
+        LogManager log_manager(Slice("test.log"));
+        EXPECT_EQ(log_manager.GetCheckpointLSN(), checkpoint_lsn);
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolOptions options;
+        options.log_manager_ = &log_manager;
+        TestBufferPool bpm(64, &disk_manager, options);
+        LogRecovery<TestBufferPool, DiskManager> recovery(&log_manager, &bpm, &disk_manager);
+        recovery.Recover();
+        EXPECT_EQ(recovery.GetActiveTxnTable().size(), 1u);
+        EXPECT_EQ(recovery.GetActiveTxnTable().count(2), 1u);
+        EXPECT_EQ(recovery.GetMaxTxnId(), 3);
+        // pages drained after the checkpoint are not redone, the two changed after it may
+        // have been written by the writer before the crash
+        EXPECT_LE(recovery.GetRedoNum(), 2u);
+        EXPECT_EQ(recovery.GetUndoNum(), 2u);
+        std::vector<int> expected(page_num, 1);
+        expected[1] = 3;
+        expected[3] = 3;
+        for (int i = 0; i < page_num; ++i) {
+            auto guard = bpm.FetchPageRead(i);
+            EXPECT_EQ(*(const int *)guard.GetContent(), expected[i]);
+        }
+    }
+    remove("test.db");
+    remove("test.log");
+}
+
+} // dsbus
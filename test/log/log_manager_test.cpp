@@ -0,0 +1,121 @@
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "log/log_manager.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(LogManagerTest, AppendTest) {
+    remove("test.log");
+    std::string data(100, 'a');
+    std::vector<lsn_t> lsns;
+    {
+        LogManager log_manager(Slice("test.log"));
+        EXPECT_EQ(log_manager.GetNextLSN(), LOG_FILE_HEADER_SIZE);
+        for (int i = 0; i < 10; ++i) {
+            LogRecord record(i, INVALID_LSN, i, 0, data.data(), data.data(), (uint32_t)data.size());
+            lsns.push_back(log_manager.AppendLogRecord(&record));
+            EXPECT_EQ(record.GetLSN(), lsns.back());
+        }
+        // LSNs are offsets in the log
+        EXPECT_EQ(lsns[1] - lsns[0], (lsn_t)(LogRecord::HEADER_SIZE + LogRecord::UPDATE_HEADER_SIZE + 200));
+        log_manager.Flush(lsns[4]);
+        EXPECT_GT(log_manager.GetPersistentLSN(), lsns[4]);
+        log_manager.FlushAll();
+        EXPECT_EQ(log_manager.GetPersistentLSN(), log_manager.GetNextLSN());
+    }
+    {
+        LogManager log_manager(Slice("test.log"));
+        EXPECT_EQ(log_manager.GetNextLSN(), lsns.back() + (lsns[1] - lsns[0]));
+    }
+    remove("test.log");
+}
+
+TEST(LogManagerTest, TornTailTest) {
+    remove("test.log");
+    lsn_t end_lsn;
+    lsn_t last_lsn;
+    {
+        LogManager log_manager(Slice("test.log"));
+        for (int i = 0; i < 3; ++i) {
+            LogRecord record(LogRecordType::BEGIN, i, INVALID_LSN);
+            last_lsn = log_manager.AppendLogRecord(&record);
+        }
+        end_lsn = log_manager.GetNextLSN();
+    }
+    {
+        // the last record loses a byte, as if the write was torn
+        int fd = open("test.log", O_RDWR);
+        char byte = 'x';
+        EXPECT_EQ(pwrite(fd, &byte, 1, end_lsn - 1), 1);
+        close(fd);
+    }
+    {
+        LogManager log_manager(Slice("test.log"));
+        EXPECT_EQ(log_manager.GetNextLSN(), last_lsn);
+        LogRecord record(LogRecordType::COMMIT, 0, INVALID_LSN);
+        EXPECT_EQ(log_manager.AppendLogRecord(&record), last_lsn);
+    }
+    remove("test.log");
+}
+
+TEST(LogManagerTest, GroupCommitTest) {
+    remove("test.log");
+    const int thread_num = 8;
+    const int commit_num = 50;
+    {
+        LogManagerOptions options;
+        // only commits wake the flusher up
+        options.flush_interval_ms_ = 1000;
+        LogManager log_manager(Slice("test.log"), options);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_num; ++t) {
+            threads.emplace_back([&log_manager, t]() {
+                for (int i = 0; i < commit_num; ++i) {
+                    LogRecord begin(LogRecordType::BEGIN, t, INVALID_LSN);
+                    auto lsn = log_manager.AppendLogRecord(&begin);
+                    LogRecord commit(LogRecordType::COMMIT, t, lsn);
+                    lsn = log_manager.AppendLogRecord(&commit);
+                    log_manager.Flush(lsn);
+                    EXPECT_GT(log_manager.GetPersistentLSN(), lsn);
+                }
+            });
+        }
+        for (auto &thread : threads) thread.join();
+        // commits waiting together share an fdatasync
+        EXPECT_LE(log_manager.GetFlushNum(), (size_t)thread_num * commit_num);
+        EXPECT_EQ(log_manager.GetNextLSN(),
+                  (lsn_t)(LOG_FILE_HEADER_SIZE + thread_num * commit_num * 2 * LogRecord::HEADER_SIZE));
+    }
+    remove("test.log");
+}
+
+TEST(LogManagerTest, FullBufferTest) {
+    remove("test.log");
+    std::string data(1000, 'a');
+    lsn_t end_lsn;
+    {
+        LogManagerOptions options;
+        // a few records fill the buffer, appending waits for the flusher
+        options.buffer_size_ = 4096;
+        LogManager log_manager(Slice("test.log"), options);
+        for (int i = 0; i < 100; ++i) {
+            LogRecord record(i, INVALID_LSN, i, 0, data.data(), data.data(), (uint32_t)data.size());
+            log_manager.AppendLogRecord(&record);
+        }
+        end_lsn = log_manager.GetNextLSN();
+    }
+    {
+        LogManagerOptions options;
+        options.buffer_size_ = 4096;
+        LogManager log_manager(Slice("test.log"), options);
+        EXPECT_EQ(log_manager.GetNextLSN(), end_lsn);
+    }
+    remove("test.log");
+}
+
+} // dsbus
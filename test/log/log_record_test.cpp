@@ -0,0 +1,99 @@
+#include <string>
+#include <vector>
+#include "log/log_record.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+TEST(LogRecordTest, SerializeTest) {
+    LogRecord begin(LogRecordType::BEGIN, 7, INVALID_LSN);
+    begin.SetLSN(16);
+    EXPECT_EQ(begin.GetSize(), LogRecord::HEADER_SIZE);
+    std::string before = "abcd";
+    std::string after = "wxyz";
+    LogRecord update(7, 16, 42, 100, before.data(), after.data(), 4);
+    update.SetLSN(56);
+    EXPECT_EQ(update.GetSize(), LogRecord::HEADER_SIZE + LogRecord::UPDATE_HEADER_SIZE + 8);
+
+    std::vector<char> buf(begin.GetSize() + update.GetSize());
+    begin.Serialize(buf.data());
+    update.Serialize(buf.data() + begin.GetSize());
+
+    LogRecord record;
+    EXPECT_TRUE(record.Deserialize(buf.data(), buf.size()));
+    EXPECT_EQ(record.GetType(), LogRecordType::BEGIN);
+    EXPECT_EQ(record.GetLSN(), 16);
+    EXPECT_EQ(record.GetTxnId(), 7);
+    EXPECT_EQ(record.GetPrevLSN(), INVALID_LSN);
+    EXPECT_TRUE(record.Deserialize(buf.data() + begin.GetSize(), update.GetSize()));
+    EXPECT_EQ(record.GetType(), LogRecordType::UPDATE);
+    EXPECT_EQ(record.GetLSN(), 56);
+    EXPECT_EQ(record.GetPrevLSN(), 16);
+    EXPECT_EQ(record.GetPageId(), 42);
+    EXPECT_EQ(record.GetOffset(), 100);
+    EXPECT_EQ(std::string(record.GetBefore(), record.GetLength()), before);
+    EXPECT_EQ(std::string(record.GetAfter(), record.GetLength()), after);
+}
+
+TEST(LogRecordTest, CLRTest) {
+    std::string image = "abcdef";
+    LogRecord clr(3, 200, 9, 12, image.data(), (uint32_t)image.size(), 100);
+    clr.SetLSN(300);
+    EXPECT_TRUE(clr.IsPageChange());
+    EXPECT_EQ(clr.GetSize(), LogRecord::HEADER_SIZE + LogRecord::CLR_HEADER_SIZE + image.size());
+    std::vector<char> buf(clr.GetSize());
+    clr.Serialize(buf.data());
+    LogRecord record;
+    EXPECT_TRUE(record.Deserialize(buf.data(), buf.size()));
+    EXPECT_EQ(record.GetType(), LogRecordType::CLR);
+    EXPECT_EQ(record.GetLSN(), 300);
+    EXPECT_EQ(record.GetPrevLSN(), 200);
+    EXPECT_EQ(record.GetPageId(), 9);
+    EXPECT_EQ(record.GetOffset(), 12u);
+    EXPECT_EQ(record.GetUndoNextLSN(), 100);
+    EXPECT_EQ(std::string(record.GetAfter(), record.GetLength()), image);
+}
+
+TEST(LogRecordTest, CheckpointTest) {
+    std::vector<std::pair<txn_id_t, lsn_t>> active_txns = {{1, 100}, {4, 260}};
+    std::vector<std::pair<page_id_t, lsn_t>> dirty_pages = {{7, 40}, {3, 180}, {12, 200}};
+    LogRecord end(40, active_txns, dirty_pages);
+    EXPECT_EQ(end.GetSize(), LogRecord::HEADER_SIZE + LogRecord::CHECKPOINT_HEADER_SIZE
+                             + 5 * LogRecord::CHECKPOINT_ENTRY_SIZE);
+    std::vector<char> buf(end.GetSize());
+    end.Serialize(buf.data());
+    LogRecord record;
+    EXPECT_TRUE(record.Deserialize(buf.data(), buf.size()));
+    EXPECT_EQ(record.GetType(), LogRecordType::CHECKPOINT_END);
+    EXPECT_EQ(record.GetRedoLSN(), 40);
+    EXPECT_EQ(record.GetActiveTxns(), active_txns);
+    EXPECT_EQ(record.GetDirtyPages(), dirty_pages);
+
+    end.DropDirtyPages();
+    buf.resize(end.GetSize());
+    end.Serialize(buf.data());
+    EXPECT_TRUE(record.Deserialize(buf.data(), buf.size()));
+    EXPECT_EQ(record.GetRedoLSN(), 40);
+    EXPECT_EQ(record.GetActiveTxns(), active_txns);
+    EXPECT_TRUE(record.GetDirtyPages().empty());
+}
+
+TEST(LogRecordTest, TornRecordTest) {
+    std::string before = "abcd";
+    std::string after = "wxyz";
+    LogRecord update(1, INVALID_LSN, 3, 0, before.data(), after.data(), 4);
+    std::vector<char> buf(update.GetSize());
+    update.Serialize(buf.data());
+    LogRecord record;
+    // cut short
+    EXPECT_FALSE(record.Deserialize(buf.data(), buf.size() - 1));
+    EXPECT_FALSE(record.Deserialize(buf.data(), 10));
+    // a byte of the after image lost
+    buf[buf.size() - 1] = 'q';
+    EXPECT_FALSE(record.Deserialize(buf.data(), buf.size()));
+    // never written
+    std::vector<char> zeros(128, 0);
+    EXPECT_FALSE(record.Deserialize(zeros.data(), zeros.size()));
+}
+
+} // dsbus
@@ -0,0 +1,185 @@
+#include <string>
+#include <vector>
+#include "slice/slice.hpp"
+#include "disk/disk_manager.hpp"
+#include "buffer/buffer_pool_manager.hpp"
+#include "log/log_manager.hpp"
+#include "log/log_recovery.hpp"
+#include "gtest/gtest.h"
+
+namespace dsbus {
+
+static const size_t page_size = 128;
+using TestBufferPool = BufferPoolManager<page_size>;
+using TestRecovery = LogRecovery<TestBufferPool, DiskManager>;
+
+// write page_num pages holding 0 to the db file, then only the log moves on, as if the
+// buffer pool crashed before writing any page
+static void CreateDB(const int page_num) {
+    remove("test.db");
+    remove("test.log");
+    DiskManager disk_manager(Slice("test.db"), page_size);
+    TestBufferPool bpm(8, &disk_manager);
+    for (int i = 0; i < page_num; ++i) {
+        auto guard = bpm.NewPageGuarded();
+        int value = 0;
+        memcpy(guard.GetContentMut(), &value, sizeof(value));
+    }
+}
+
+static lsn_t LogUpdate(LogManager &log_manager, txn_id_t txn_id, lsn_t prev_lsn, page_id_t page_id, int before,
+                       int after) {
+    LogRecord record(txn_id, prev_lsn, page_id, 0, (const char *)&before, (const char *)&after, sizeof(int));
+    return log_manager.AppendLogRecord(&record);
+}
+
+static lsn_t LogTxnRecord(LogManager &log_manager, LogRecordType type, txn_id_t txn_id, lsn_t prev_lsn) {
+    LogRecord record(type, txn_id, prev_lsn);
+    return log_manager.AppendLogRecord(&record);
+}
+
+static int ReadInt(TestBufferPool &bpm, page_id_t page_id) {
+    auto guard = bpm.FetchPageRead(page_id);
+    return *(const int *)guard.GetContent();
+}
+
+TEST(LogRecoveryTest, RedoUndoTest) {
+    const int page_num = 16;
+    const page_id_t new_page_id = 20;
+    CreateDB(page_num);
+    lsn_t stolen_lsn = INVALID_LSN;
+    {
+        LogManager log_manager(Slice("test.log"));
+        // txn 1 commits
+        lsn_t lsn = LogTxnRecord(log_manager, LogRecordType::BEGIN, 1, INVALID_LSN);
+        for (int i = 0; i < page_num; ++i) lsn = LogUpdate(log_manager, 1, lsn, i, 0, i + 1);
+        LogTxnRecord(log_manager, LogRecordType::COMMIT, 1, lsn);
+        // txn 2 is a loser, it also wrote a page past the end of the file
+        lsn = LogTxnRecord(log_manager, LogRecordType::BEGIN, 2, INVALID_LSN);
+        for (int i = 0; i < page_num / 2; ++i) {
+            lsn = LogUpdate(log_manager, 2, lsn, i, i + 1, 100 + i);
+            if (i == 3) stolen_lsn = lsn;
+        }
+        lsn = LogUpdate(log_manager, 2, lsn, new_page_id, 0, 7);
+        // txn 3 aborted, it left nothing to undo
+        LogTxnRecord(log_manager, LogRecordType::BEGIN, 3, INVALID_LSN);
+        LogTxnRecord(log_manager, LogRecordType::ABORT, 3, INVALID_LSN);
+    }
+    {
+        // a change of the loser reached the db file
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        std::vector<char> page(page_size);
+        disk_manager.ReadPage(3, page.data());
+        int value = 103;
+        memcpy(page.data() + disk::PAGE_HEADER_SIZE, &value, sizeof(value));
+        memcpy(page.data() + disk::OFFSET_PAGE_LSN, &stolen_lsn, sizeof(stolen_lsn));
+        disk_manager.WritePage(3, page.data());
+    }
+    size_t log_size;
+    {
+        LogManager log_manager(Slice("test.log"));
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolOptions options;
+        options.log_manager_ = &log_manager;
+        TestBufferPool bpm(8, &disk_manager, options);
+        LogRecoveryOptions recovery_options;
+        recovery_options.redo_thread_num_ = 4;
+        TestRecovery recovery(&log_manager, &bpm, &disk_manager, recovery_options);
+        recovery.Recover();
+        EXPECT_EQ(recovery.GetActiveTxnTable().size(), 1u);
+        EXPECT_EQ(recovery.GetActiveTxnTable().count(2), 1u);
+        EXPECT_EQ(recovery.GetDirtyPageTable().size(), (size_t)page_num + 1);
+        EXPECT_EQ(recovery.GetMaxTxnId(), 3);
+        // page 3 was on disk with the LSN of its last update, which are not redone
+        EXPECT_EQ(recovery.GetRedoNum(), (size_t)page_num + page_num / 2 + 1 - 2);
+        EXPECT_EQ(recovery.GetUndoNum(), (size_t)page_num / 2 + 1);
+        for (int i = 0; i < page_num; ++i) EXPECT_EQ(ReadInt(bpm, i), i + 1);
+        EXPECT_EQ(ReadInt(bpm, new_page_id), 0);
+        log_size = log_manager.GetPersistentLSN();
+    }
+    {
+        // recovering again finds the loser aborted
+        LogManager log_manager(Slice("test.log"));
+        EXPECT_EQ(log_manager.GetNextLSN(), (lsn_t)log_size);
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolOptions options;
+        options.log_manager_ = &log_manager;
+        TestBufferPool bpm(8, &disk_manager, options);
+        TestRecovery recovery(&log_manager, &bpm, &disk_manager);
+        recovery.Recover();
+        EXPECT_TRUE(recovery.GetActiveTxnTable().empty());
+        EXPECT_EQ(recovery.GetRedoNum(), 0u);
+        EXPECT_EQ(recovery.GetUndoNum(), 0u);
+        EXPECT_EQ(log_manager.GetNextLSN(), (lsn_t)log_size);
+        for (int i = 0; i < page_num; ++i) EXPECT_EQ(ReadInt(bpm, i), i + 1);
+    }
+    remove("test.db");
+    remove("test.log");
+}
+
+TEST(LogRecoveryTest, CrashDuringUndoTest) {
+    CreateDB(2);
+    {
+        // the crash hit while the loser was rolled back, its update of page 1 is undone already
+        LogManager log_manager(Slice("test.log"));
+        lsn_t begin_lsn = LogTxnRecord(log_manager, LogRecordType::BEGIN, 1, INVALID_LSN);
+        lsn_t update_lsn = LogUpdate(log_manager, 1, begin_lsn, 0, 0, 5);
+        lsn_t lsn = LogUpdate(log_manager, 1, update_lsn, 1, 0, 6);
+        int before = 0;
+        LogRecord clr(1, lsn, 1, 0, (const char *)&before, sizeof(before), update_lsn);
+        log_manager.AppendLogRecord(&clr);
+    }
+    {
+        LogManager log_manager(Slice("test.log"));
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolOptions options;
+        options.log_manager_ = &log_manager;
+        TestBufferPool bpm(8, &disk_manager, options);
+        TestRecovery recovery(&log_manager, &bpm, &disk_manager);
+        recovery.Recover();
+        EXPECT_EQ(recovery.GetRedoNum(), 3u);
+        EXPECT_EQ(recovery.GetUndoNum(), 1u);
+        EXPECT_EQ(ReadInt(bpm, 0), 0);
+        EXPECT_EQ(ReadInt(bpm, 1), 0);
+    }
+    remove("test.db");
+    remove("test.log");
+}
+
+TEST(LogRecoveryTest, ParallelRedoTest) {
+    const int page_num = 64;
+    const int round_num = 50;
+    CreateDB(page_num);
+    {
+        LogManagerOptions log_options;
+        log_options.buffer_size_ = 4096;
+        LogManager log_manager(Slice("test.log"), log_options);
+        lsn_t lsn = LogTxnRecord(log_manager, LogRecordType::BEGIN, 1, INVALID_LSN);
+        for (int r = 0; r < round_num; ++r) {
+            for (int i = 0; i < page_num; ++i) lsn = LogUpdate(log_manager, 1, lsn, i, r == 0 ? 0 : r - 1 + i, r + i);
+        }
+        LogTxnRecord(log_manager, LogRecordType::COMMIT, 1, lsn);
+    }
+    {
+        LogManagerOptions log_options;
+        log_options.buffer_size_ = 4096;
+        LogManager log_manager(Slice("test.log"), log_options);
+        DiskManager disk_manager(Slice("test.db"), page_size);
+        BufferPoolOptions options;
+        options.log_manager_ = &log_manager;
+        // the pool is smaller than the pages redone
+        TestBufferPool bpm(16, &disk_manager, options);
+        LogRecoveryOptions recovery_options;
+        recovery_options.redo_thread_num_ = 8;
+        // batches as small as a log buffer
+        recovery_options.redo_batch_size_ = 0;
+        TestRecovery recovery(&log_manager, &bpm, &disk_manager, recovery_options);
+        recovery.Recover();
+        EXPECT_EQ(recovery.GetRedoNum(), (size_t)page_num * round_num);
+        for (int i = 0; i < page_num; ++i) EXPECT_EQ(ReadInt(bpm, i), round_num - 1 + i);
+    }
+    remove("test.db");
+    remove("test.log");
+}
+
+} // dsbus